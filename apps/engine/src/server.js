@@ -1275,130 +1275,6 @@ function getLeadingSilenceOffsetSeconds(peaks, durationSeconds, threshold = 0.02
   return 0;
 }
 
-/** Max file size (bytes) for fallback leading-silence detection from file. */
-const MAX_FILE_SIZE_FOR_LEADING_SILENCE = 25 * 1024 * 1024;
-
-/** Threshold for "silence" when scanning PCM: 0..1 for float, scaled for integer. */
-const LEADING_SILENCE_THRESHOLD = 0.01;
-
-/** WAV format codes: 1 = PCM int, 3 = IEEE float. */
-const WAV_FORMAT_PCM = 1;
-const WAV_FORMAT_IEEE_FLOAT = 3;
-
-/**
- * Scan WAV file PCM to find first non-silent sample.
- * Supports PCM int (16/24/32 bit) and IEEE float (32 bit, format 3) – as used by many exports.
- * Returns offset in seconds or 0 on error.
- */
-function computeLeadingSilenceFromWavBuffer(buffer) {
-  const len = buffer.length;
-  if (len < 44) return 0;
-  const uint8 = buffer instanceof Uint8Array ? buffer : new Uint8Array(buffer);
-  const view = new DataView(uint8.buffer, uint8.byteOffset, uint8.byteLength);
-  const viewLen = view.byteLength;
-  if (viewLen < 44) return 0;
-  if (String.fromCharCode(view.getUint8(0), view.getUint8(1), view.getUint8(2), view.getUint8(3)) !== 'RIFF') return 0;
-  let offset = 12;
-  let sampleRate = 44100;
-  let numChannels = 1;
-  let bitsPerSample = 16;
-  let audioFormat = WAV_FORMAT_PCM;
-  let dataOffset = 0;
-  let dataLength = 0;
-  while (offset + 8 <= viewLen) {
-    const chunkId = String.fromCharCode(view.getUint8(offset), view.getUint8(offset + 1), view.getUint8(offset + 2), view.getUint8(offset + 3));
-    const chunkSize = view.getUint32(offset + 4, true);
-    if (chunkId === 'fmt ') {
-      if (chunkSize >= 16) {
-        const fmtOffset = offset + 8;
-        audioFormat = view.getUint16(fmtOffset, true);
-        numChannels = view.getUint16(fmtOffset + 2, true);
-        sampleRate = view.getUint32(fmtOffset + 4, true);
-        bitsPerSample = view.getUint16(fmtOffset + 14, true) || 16;
-      }
-    } else if (chunkId === 'data') {
-      dataOffset = offset + 8;
-      dataLength = chunkSize;
-      break;
-    }
-    offset += 8 + chunkSize;
-  }
-  if (dataLength <= 0 || dataOffset + dataLength > viewLen) return 0;
-  const bytesPerSample = Math.max(1, Math.floor(bitsPerSample / 8));
-  const frameSize = bytesPerSample * numChannels;
-  const sampleCount = Math.floor(dataLength / frameSize);
-  if (sampleCount <= 0) return 0;
-  const isFloat = audioFormat === WAV_FORMAT_IEEE_FLOAT;
-  const thresholdFloat = LEADING_SILENCE_THRESHOLD;
-  const thresholdInt = Math.min(32767, Math.floor(LEADING_SILENCE_THRESHOLD * (bitsPerSample >= 24 ? 8388607 : 32767)));
-  if (process.env.STUU_DEBUG_WAV_OFFSET === '1') {
-    console.log('[thestuu-engine] WAV scan: format=%d (1=PCM 3=float) rate=%d ch=%d bps=%d samples=%d', audioFormat, sampleRate, numChannels, bitsPerSample, sampleCount);
-  }
-  for (let i = 0; i < sampleCount; i += 1) {
-    let maxInFrame = 0;
-    for (let ch = 0; ch < numChannels; ch += 1) {
-      const byteIndex = dataOffset + i * frameSize + ch * bytesPerSample;
-      if (byteIndex + bytesPerSample > viewLen) break;
-      let sample = 0;
-      if (isFloat && bytesPerSample === 4) {
-        sample = Math.abs(view.getFloat32(byteIndex, true));
-      } else if (bytesPerSample === 2) {
-        sample = Math.abs(view.getInt16(byteIndex, true));
-      } else if (bytesPerSample === 4 && !isFloat) {
-        sample = Math.abs(view.getInt32(byteIndex, true));
-      } else if (bytesPerSample === 3) {
-        const b0 = view.getUint8(byteIndex);
-        const b1 = view.getUint8(byteIndex + 1);
-        const b2 = view.getUint8(byteIndex + 2);
-        let s = (b2 << 16) | (b1 << 8) | b0;
-        if (b2 & 0x80) s -= 0x1000000;
-        sample = Math.abs(s);
-      }
-      if (sample > maxInFrame) maxInFrame = sample;
-    }
-    const above = isFloat ? maxInFrame > thresholdFloat : maxInFrame > thresholdInt;
-    if (above) {
-      const sec = i / sampleRate;
-      if (process.env.STUU_DEBUG_WAV_OFFSET === '1') {
-        console.log('[thestuu-engine] WAV scan: first non-silent at sample %d → %.3fs', i, sec);
-      }
-      return sec;
-    }
-  }
-  if (process.env.STUU_DEBUG_WAV_OFFSET === '1') {
-    console.log('[thestuu-engine] WAV scan: no non-silent sample found (full silence or threshold too high)');
-  }
-  return 0;
-}
-
-/**
- * Detect leading silence from file: try audio-decode first, then for .wav use raw PCM scan.
- * Returns offset in seconds or 0 on error.
- */
-async function computeLeadingSilenceFromFile(filePath) {
-  try {
-    const stat = await fs.stat(filePath);
-    if (!stat.isFile() || stat.size <= 0 || stat.size > MAX_FILE_SIZE_FOR_LEADING_SILENCE) return 0;
-    const buffer = await fs.readFile(filePath);
-    const ext = path.extname(filePath).toLowerCase();
-    if (ext === '.wav' || ext === '.wave') {
-      const wavOffset = computeLeadingSilenceFromWavBuffer(buffer);
-      if (wavOffset > 0) return wavOffset;
-    }
-    const decoded = await decode(buffer);
-    if (!decoded || typeof decoded.getChannelData !== 'function') return 0;
-    const durationSec = Number(decoded.duration);
-    if (!Number.isFinite(durationSec) || durationSec <= 0) return 0;
-    const peaks = extractWaveformPeaksFromDecoded(decoded, UPLOAD_WAVEFORM_SAMPLES);
-    return getLeadingSilenceOffsetSeconds(peaks, durationSec, 0.02);
-  } catch (err) {
-    if (process.env.NODE_ENV === 'development') {
-      console.warn('[thestuu-engine] leading-silence from file failed:', filePath, err instanceof Error ? err.message : err);
-    }
-    return 0;
-  }
-}
-
 async function syncPlaylistClipsToNative() {
   const summary = { total: 0, synced: 0, failed: 0, lastErrors: [] };
   state.nativeClipSyncSummary = summary;
@@ -1486,11 +1362,7 @@ async function syncPlaylistClipsToNative() {
       }
       const fade_in = Number.isFinite(fadeIn) && fadeIn >= 0 ? fadeIn : 0;
       const fade_out = Number.isFinite(fadeOut) && fadeOut >= 0 ? fadeOut : 0;
-      let source_offset_seconds = getLeadingSilenceOffsetSeconds(waveform_peaks, length_seconds);
-      // Fallback: when peak-based offset is 0 (e.g. WAV with low/normalized peaks or no peaks), detect from file
-      if (source_offset_seconds === 0) {
-        source_offset_seconds = await computeLeadingSilenceFromFile(pathToSend);
-      }
+      const source_offset_seconds = getLeadingSilenceOffsetSeconds(waveform_peaks, length_seconds);
       const payload = {
         track_id: trackId,
         source_path: pathToSend,
@@ -1504,10 +1376,17 @@ async function syncPlaylistClipsToNative() {
         fade_out_curve: fadeOutCurve ?? 'linear',
         type: 'audio',
       };
-      if (source_offset_seconds > 0) payload.source_offset_seconds = Number(source_offset_seconds.toFixed(4));
-      await requestNativeTransport('clip:import-file', payload);
+      if (source_offset_seconds > 0) {
+        payload.source_offset_seconds = Number(source_offset_seconds.toFixed(4));
+      } else {
+        // No offset from the peaks (low/normalized peaks or none): let the native engine scan the file edges.
+        payload.auto_trim = true;
+        payload.auto_trim_threshold_db = -40;
+      }
+      const imported = await requestNativeTransport('clip:import-file', payload);
+      const trimmedSeconds = Number(imported?.leadingSilenceSeconds) || 0;
       summary.synced += 1;
-      console.log(`[thestuu-engine]   Track ${trackId} clip "${clipName || clipId}": OK (start_seconds=${start_seconds} length_seconds=${length_seconds}${source_offset_seconds > 0 ? ` source_offset=${source_offset_seconds.toFixed(2)}s` : ''})`);
+      console.log(`[thestuu-engine]   Track ${trackId} clip "${clipName || clipId}": OK (start_seconds=${start_seconds} length_seconds=${length_seconds}${source_offset_seconds > 0 ? ` source_offset=${source_offset_seconds.toFixed(2)}s` : ''}${trimmedSeconds > 0 ? ` auto_trim=${trimmedSeconds.toFixed(2)}s` : ''})`);
     } catch (error) {
       const msg = error instanceof Error ? error.message : String(error);
       errors.push(`track ${trackId} clip ${clipName || clipId}: ${msg}`);
@@ -1545,21 +1424,30 @@ async function syncNativeArrangementFromPlaylist() {
     await requestNativeTransport('edit:clear-audio-clips');
     await syncPlaylistClipsToNative();
     // Apply current mixer (mute, solo, volume, pan, record arm) to native so playback reflects UI state.
+    // One batched request: native applies all tracks and rebuilds the graph once.
     const mixer = Array.isArray(state.project.mixer) ? state.project.mixer : [];
+    const mixerTracks = [];
     for (const entry of mixer) {
       const trackId = Number(entry?.track_id);
       if (!Number.isInteger(trackId) || trackId < 1) continue;
-      await requestNativeTransport('track:set-mute', { track_id: trackId, mute: normalizeBool(entry.mute) }).catch(() => {});
-      await requestNativeTransport('track:set-solo', { track_id: trackId, solo: normalizeBool(entry.solo) }).catch(() => {});
+      const track = {
+        track_id: trackId,
+        mute: normalizeBool(entry.mute),
+        solo: normalizeBool(entry.solo),
+        record_armed: normalizeBool(entry.record_armed),
+      };
       const vol = Number(entry?.volume);
       if (Number.isFinite(vol)) {
-        await requestNativeTransport('track:set-volume', { track_id: trackId, volume: Math.max(0, Math.min(1.2, vol)) }).catch(() => {});
+        track.volume = Math.max(0, Math.min(1.2, vol));
       }
       const p = Number(entry?.pan);
       if (Number.isFinite(p)) {
-        await requestNativeTransport('track:set-pan', { track_id: trackId, pan: Math.max(-1, Math.min(1, p)) }).catch(() => {});
+        track.pan = Math.max(-1, Math.min(1, p));
       }
-      await requestNativeTransport('track:set-record-arm', { track_id: trackId, record_armed: normalizeBool(entry.record_armed) }).catch(() => {});
+      mixerTracks.push(track);
+    }
+    if (mixerTracks.length > 0) {
+      await requestNativeTransport('track:sync', { tracks: mixerTracks }).catch(() => {});
     }
     // Rebuild playback graph immediately so play works instantly (no timer wait).
     await requestNativeTransport('transport:ensure-context', {});
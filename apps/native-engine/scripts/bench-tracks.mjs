@@ -0,0 +1,63 @@
+#!/usr/bin/env node
+// Benchmark: edit:reset with many tracks plus a full mixer sync against a running thestuu-native.
+// Usage: node scripts/bench-tracks.mjs [trackCount=1000] [budgetMs=1000]
+// Exits with 1 if reset + sync + graph build takes longer than the budget.
+import { performance } from 'node:perf_hooks';
+import { NativeTransportClient } from '../../engine/src/native-transport-client.js';
+
+const trackCount = Number.parseInt(process.argv[2] ?? '1000', 10);
+const budgetMs = Number.parseFloat(process.argv[3] ?? '1000');
+const socketPath = process.env.STUU_NATIVE_SOCKET || '/tmp/thestuu-native.sock';
+
+async function timed(label, fn) {
+  const start = performance.now();
+  const result = await fn();
+  const elapsedMs = performance.now() - start;
+  console.log(`[bench-tracks] ${label}: ${elapsedMs.toFixed(1)} ms`);
+  return { result, elapsedMs };
+}
+
+async function main() {
+  const client = new NativeTransportClient({ socketPath, requestTimeoutMs: 60000 });
+  await client.start();
+  try {
+    const info = await client.request('backend.info');
+    if (!info?.tracktion) {
+      throw new Error('native engine runs without the Tracktion backend');
+    }
+
+    const tracks = [];
+    for (let trackId = 1; trackId <= trackCount; trackId += 1) {
+      tracks.push({
+        track_id: trackId,
+        mute: trackId % 7 === 0,
+        solo: false,
+        volume: 0.5 + (trackId % 5) * 0.1,
+        pan: ((trackId % 9) - 4) / 4,
+        record_armed: false,
+      });
+    }
+
+    const reset = await timed(`edit:reset (${trackCount} tracks)`, () => client.request('edit:reset', { track_count: trackCount }));
+    const sync = await timed('track:sync', () => client.request('track:sync', { tracks }));
+    const context = await timed('transport:ensure-context', () => client.request('transport:ensure-context', {}));
+    const listed = await client.request('track:list');
+
+    const missing = sync.result?.missingTrackIds?.length ?? 0;
+    if ((listed?.tracks?.length ?? 0) !== trackCount || missing > 0) {
+      throw new Error(`expected ${trackCount} tracks, got ${listed?.tracks?.length ?? 0} (${missing} missing in sync)`);
+    }
+
+    const totalMs = reset.elapsedMs + sync.elapsedMs + context.elapsedMs;
+    const ok = totalMs <= budgetMs;
+    console.log(`[bench-tracks] total: ${totalMs.toFixed(1)} ms (budget ${budgetMs} ms) ${ok ? 'OK' : 'FAIL'}`);
+    process.exitCode = ok ? 0 : 1;
+  } finally {
+    client.stop();
+  }
+}
+
+main().catch((error) => {
+  console.error('[bench-tracks] failed:', error instanceof Error ? error.message : error);
+  process.exitCode = 1;
+});
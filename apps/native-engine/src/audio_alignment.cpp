@@ -0,0 +1,217 @@
+#include "audio_alignment.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <memory>
+
+#include <juce_dsp/juce_dsp.h>
+
+namespace thestuu::native {
+
+namespace {
+
+/** -60 dBFS mean square; quieter frames count as silence so noise floors do not produce onsets. */
+constexpr float kSilenceEnergy = 1.0e-6F;
+constexpr int kEnvelopeBlockFrames = 256;
+
+/** Linear cross-correlation r[m] = sum_i target[i] * guide[i + m] for m in [0, maxLag] through one real
+ *  FFT pair. The FFT is kept between calls of the same size (all windows of one target). */
+class Correlator {
+ public:
+  /** Best lag in [0, maxLag] with parabolic sub-frame refinement; -1 if there is no positive peak.
+   *  guide must hold targetLength + maxLag values. */
+  double bestLag(const float* target, int targetLength, const float* guide, int maxLag) {
+    const int guideLength = targetLength + maxLag;
+    int order = 1;
+    while ((1 << order) < guideLength) {
+      ++order;
+    }
+    if (fft == nullptr || fft->getSize() != (1 << order)) {
+      fft = std::make_unique<juce::dsp::FFT>(order);
+    }
+    const int size = fft->getSize();
+    targetSpectrum.assign(static_cast<size_t>(size) * 2, 0.0F);
+    correlation.assign(static_cast<size_t>(size) * 2, 0.0F);
+    std::copy(target, target + targetLength, targetSpectrum.begin());
+    std::copy(guide, guide + guideLength, correlation.begin());
+    fft->performRealOnlyForwardTransform(targetSpectrum.data(), true);
+    fft->performRealOnlyForwardTransform(correlation.data(), true);
+    auto* t = reinterpret_cast<std::complex<float>*>(targetSpectrum.data());
+    auto* g = reinterpret_cast<std::complex<float>*>(correlation.data());
+    for (int bin = 0; bin <= size / 2; ++bin) {
+      g[bin] = std::conj(t[bin]) * g[bin];
+    }
+    fft->performRealOnlyInverseTransform(correlation.data());
+
+    int best = 0;
+    for (int lag = 1; lag <= maxLag; ++lag) {
+      if (correlation[static_cast<size_t>(lag)] > correlation[static_cast<size_t>(best)]) {
+        best = lag;
+      }
+    }
+    const float peak = correlation[static_cast<size_t>(best)];
+    if (!(peak > 0.0F)) {
+      return -1.0;
+    }
+    if (best > 0 && best < maxLag) {
+      const float before = correlation[static_cast<size_t>(best - 1)];
+      const float after = correlation[static_cast<size_t>(best + 1)];
+      const float curvature = before - 2.0F * peak + after;
+      if (curvature < 0.0F) {
+        return best + 0.5 * static_cast<double>(before - after) / curvature;
+      }
+    }
+    return best;
+  }
+
+ private:
+  std::unique_ptr<juce::dsp::FFT> fft;
+  std::vector<float> targetSpectrum;
+  std::vector<float> correlation;
+};
+
+/** Normalised correlation (0..1 for non-negative envelopes) at an integer lag. */
+double correlationAt(const float* target, int length, const float* guide, int lag) {
+  double dot = 0.0;
+  double targetEnergy = 0.0;
+  double guideEnergy = 0.0;
+  for (int i = 0; i < length; ++i) {
+    const double a = target[i];
+    const double b = guide[i + lag];
+    dot += a * b;
+    targetEnergy += a * a;
+    guideEnergy += b * b;
+  }
+  if (targetEnergy <= 0.0 || guideEnergy <= 0.0) {
+    return 0.0;
+  }
+  return dot / std::sqrt(targetEnergy * guideEnergy);
+}
+
+}  // namespace
+
+bool computeOnsetEnvelope(
+  juce::AudioFormatReader& reader,
+  double startSeconds,
+  double lengthSeconds,
+  double frameRate,
+  OnsetEnvelope& envelope
+) {
+  envelope.frameRate = frameRate;
+  envelope.values.clear();
+  if (reader.sampleRate <= 0.0 || frameRate <= 0.0 || lengthSeconds <= 0.0) {
+    return false;
+  }
+  const auto frames = static_cast<int64_t>(std::ceil(lengthSeconds * frameRate));
+  envelope.values.assign(static_cast<size_t>(frames), 0.0F);
+
+  const double samplesPerFrame = reader.sampleRate / frameRate;
+  const auto firstSample = static_cast<juce::int64>(std::llround(startSeconds * reader.sampleRate));
+  const auto frameStart = [&](int64_t frame) {
+    return firstSample + static_cast<juce::int64>(std::llround(static_cast<double>(frame) * samplesPerFrame));
+  };
+  const bool stereo = reader.numChannels > 1;
+  juce::AudioBuffer<float> block(stereo ? 2 : 1, static_cast<int>(std::ceil(samplesPerFrame * kEnvelopeBlockFrames)) + 1);
+  float previousLevel = std::log10(kSilenceEnergy);
+
+  for (int64_t frame = 0; frame < frames; frame += kEnvelopeBlockFrames) {
+    const int64_t blockFrames = std::min<int64_t>(kEnvelopeBlockFrames, frames - frame);
+    const juce::int64 blockStart = frameStart(frame);
+    const int blockSamples = static_cast<int>(frameStart(frame + blockFrames) - blockStart);
+    if (blockSamples <= 0) {
+      continue;
+    }
+    // Out-of-file ranges (negative or past the end) read as silence.
+    if (!reader.read(&block, 0, blockSamples, blockStart, true, stereo)) {
+      return false;
+    }
+    for (int64_t i = 0; i < blockFrames; ++i) {
+      const int begin = static_cast<int>(frameStart(frame + i) - blockStart);
+      const int count = static_cast<int>(frameStart(frame + i + 1) - blockStart) - begin;
+      float energy = 0.0F;
+      if (count > 0) {
+        for (int ch = 0; ch < block.getNumChannels(); ++ch) {
+          const float rms = block.getRMSLevel(ch, begin, count);
+          energy += rms * rms;
+        }
+        energy /= static_cast<float>(block.getNumChannels());
+      }
+      const float level = std::log10(std::max(energy, kSilenceEnergy));
+      envelope.values[static_cast<size_t>(frame + i)] = std::max(0.0F, level - previousLevel);
+      previousLevel = level;
+    }
+  }
+  return true;
+}
+
+int alignmentPadFrames(const AlignmentOptions& options, double frameRate) {
+  return std::max(1, static_cast<int>(std::lround(options.maxShiftSeconds * frameRate)));
+}
+
+AlignmentResult alignOnsetEnvelopes(
+  const OnsetEnvelope& guide,
+  const OnsetEnvelope& target,
+  const AlignmentOptions& options
+) {
+  AlignmentResult result;
+  const double rate = target.frameRate;
+  const int length = static_cast<int>(target.values.size());
+  if (rate <= 0.0 || guide.frameRate != rate || length == 0) {
+    return result;
+  }
+  const int pad = alignmentPadFrames(options, rate);
+  const int maxLag = 2 * pad;
+  if (static_cast<int>(guide.values.size()) < length + maxLag) {
+    return result;
+  }
+  const double maxShift = pad / rate;
+  const auto lagToOffset = [&](double lag) { return std::clamp((pad - lag) / rate, -maxShift, maxShift); };
+
+  Correlator correlator;
+  const float* targetData = target.values.data();
+  const float* guideData = guide.values.data();
+
+  if (const double lag = correlator.bestLag(targetData, length, guideData, maxLag); lag >= 0.0) {
+    result.offsetSeconds = lagToOffset(lag);
+    result.confidence = correlationAt(targetData, length, guideData, static_cast<int>(std::lround(lag)));
+  }
+
+  const int window = std::min(length, std::max(4 * pad, static_cast<int>(std::lround(options.windowSeconds * rate))));
+  const int hop = std::max(1, static_cast<int>(std::lround(options.hopSeconds * rate)));
+  std::vector<int> starts;
+  for (int start = 0; start + window <= length; start += hop) {
+    starts.push_back(start);
+  }
+  if (!starts.empty() && starts.back() + window < length) {
+    starts.push_back(length - window);  // cover the tail
+  }
+  for (const int start : starts) {
+    const double lag = correlator.bestLag(targetData + start, window, guideData + start, maxLag);
+    if (lag < 0.0) {
+      continue;
+    }
+    const double confidence = correlationAt(targetData + start, window, guideData + start, static_cast<int>(std::lround(lag)));
+    if (confidence < options.minConfidence) {
+      continue;
+    }
+    result.markers.push_back({(start + 0.5 * window) / rate, lagToOffset(lag), confidence});
+  }
+
+  // Median of three against single-window outliers (e.g. a repeated phrase matching one beat off).
+  if (result.markers.size() >= 3) {
+    std::vector<double> smoothed(result.markers.size());
+    for (size_t i = 1; i + 1 < result.markers.size(); ++i) {
+      const double a = result.markers[i - 1].offsetSeconds;
+      const double b = result.markers[i].offsetSeconds;
+      const double c = result.markers[i + 1].offsetSeconds;
+      smoothed[i] = std::max(std::min(a, b), std::min(std::max(a, b), c));
+    }
+    for (size_t i = 1; i + 1 < result.markers.size(); ++i) {
+      result.markers[i].offsetSeconds = smoothed[i];
+    }
+  }
+  return result;
+}
+
+}  // namespace thestuu::native
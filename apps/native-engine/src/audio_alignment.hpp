@@ -0,0 +1,62 @@
+#pragma once
+
+#include <vector>
+
+#include <juce_audio_formats/juce_audio_formats.h>
+
+namespace thestuu::native {
+
+/** Onset strength per frame: half-wave rectified rise of the log energy, mono mixdown. */
+struct OnsetEnvelope {
+  double frameRate = 0.0;
+  std::vector<float> values;
+};
+
+/** Computes the envelope of [startSeconds, startSeconds + lengthSeconds) of reader at frameRate.
+ *  Regions outside the file are silent. Returns false if the reader fails. */
+bool computeOnsetEnvelope(
+  juce::AudioFormatReader& reader,
+  double startSeconds,
+  double lengthSeconds,
+  double frameRate,
+  OnsetEnvelope& envelope
+);
+
+struct AlignmentOptions {
+  /** Hard limit for any offset, global or local. */
+  double maxShiftSeconds = 0.08;
+  /** Length and hop of the correlation windows for time-varying offsets. */
+  double windowSeconds = 2.0;
+  double hopSeconds = 0.5;
+  /** Windows whose normalised correlation peak stays below this yield no marker. */
+  double minConfidence = 0.3;
+};
+
+/** Guide padding on each side of the target, in frames: round(maxShiftSeconds * frameRate), at least 1. */
+int alignmentPadFrames(const AlignmentOptions& options, double frameRate);
+
+struct AlignmentMarker {
+  /** Window centre, seconds from the start of the target envelope. */
+  double timeSeconds = 0.0;
+  /** Positive: the target is late against the guide here. */
+  double offsetSeconds = 0.0;
+  double confidence = 0.0;
+};
+
+struct AlignmentResult {
+  double offsetSeconds = 0.0;
+  double confidence = 0.0;
+  std::vector<AlignmentMarker> markers;
+};
+
+/** Aligns target against guide by FFT cross-correlation: one global offset over the whole overlap, then
+ *  windowed offsets (median-smoothed, clamped to maxShiftSeconds). guide must cover the target's time
+ *  range padded by alignmentPadFrames() on both sides, i.e. guide frame i + pad lines up with target
+ *  frame i at zero offset. Both envelopes need the same frame rate. Thread-safe; call once per target. */
+AlignmentResult alignOnsetEnvelopes(
+  const OnsetEnvelope& guide,
+  const OnsetEnvelope& target,
+  const AlignmentOptions& options
+);
+
+}  // namespace thestuu::native
@@ -0,0 +1,296 @@
+#include "loudness_meter.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <vector>
+
+#include <juce_dsp/juce_dsp.h>
+
+namespace thestuu::native {
+
+namespace {
+
+constexpr int kBlockSamples = 4096;
+constexpr int kMaxChannels = 8;
+constexpr double kAbsoluteGateLufs = -70.0;
+constexpr double kIntegratedRelativeGateLu = -10.0;
+constexpr double kRangeRelativeGateLu = -20.0;
+/** Sub-blocks of 100 ms; momentary = 4, short-term = 30 of them. */
+constexpr int kMomentarySubBlocks = 4;
+constexpr int kShortTermSubBlocks = 30;
+
+using Lanes = juce::dsp::SIMDRegister<double>;
+
+struct Biquad {
+  double b0 = 1.0;
+  double b1 = 0.0;
+  double b2 = 0.0;
+  double a1 = 0.0;
+  double a2 = 0.0;
+};
+
+/** BS.1770 pre-filter (high shelf) and RLB high-pass, derived for any sample rate. */
+std::array<Biquad, 2> kWeightingFor(double sampleRate) {
+  std::array<Biquad, 2> stages;
+  {
+    const double f0 = 1681.974450955533;
+    const double gainDb = 3.999843853973347;
+    const double q = 0.7071752369554196;
+    const double k = std::tan(juce::MathConstants<double>::pi * f0 / sampleRate);
+    const double vh = std::pow(10.0, gainDb / 20.0);
+    const double vb = std::pow(vh, 0.4996667741545416);
+    const double a0 = 1.0 + k / q + k * k;
+    stages[0] = {
+      (vh + vb * k / q + k * k) / a0,
+      2.0 * (k * k - vh) / a0,
+      (vh - vb * k / q + k * k) / a0,
+      2.0 * (k * k - 1.0) / a0,
+      (1.0 - k / q + k * k) / a0,
+    };
+  }
+  {
+    const double f0 = 38.13547087602444;
+    const double q = 0.5003270373238773;
+    const double k = std::tan(juce::MathConstants<double>::pi * f0 / sampleRate);
+    const double a0 = 1.0 + k / q + k * k;
+    stages[1] = {1.0, -2.0, 1.0, 2.0 * (k * k - 1.0) / a0, (1.0 - k / q + k * k) / a0};
+  }
+  return stages;
+}
+
+/** Both K-weighting stages (transposed direct form II) for Lanes::size() channels at once. */
+class KWeightingLanes {
+ public:
+  explicit KWeightingLanes(const std::array<Biquad, 2>& stages) {
+    for (size_t i = 0; i < stages.size(); ++i) {
+      b0[i] = Lanes::expand(stages[i].b0);
+      b1[i] = Lanes::expand(stages[i].b1);
+      b2[i] = Lanes::expand(stages[i].b2);
+      a1[i] = Lanes::expand(stages[i].a1);
+      a2[i] = Lanes::expand(stages[i].a2);
+      s1[i] = Lanes::expand(0.0);
+      s2[i] = Lanes::expand(0.0);
+    }
+  }
+
+  Lanes process(Lanes x) noexcept {
+    for (size_t i = 0; i < 2; ++i) {
+      const Lanes y = b0[i] * x + s1[i];
+      s1[i] = b1[i] * x - a1[i] * y + s2[i];
+      s2[i] = b2[i] * x - a2[i] * y;
+      x = y;
+    }
+    return x;
+  }
+
+ private:
+  std::array<Lanes, 2> b0, b1, b2, a1, a2, s1, s2;
+};
+
+double channelWeight(int channel, int numChannels) {
+  if (numChannels < 6) {
+    return 1.0;
+  }
+  if (channel == 3) {
+    return 0.0;  // LFE
+  }
+  return channel == 4 || channel == 5 ? 1.41 : 1.0;
+}
+
+double energyToLufs(double energy) {
+  return energy > 0.0 ? std::max(kLoudnessFloorDb, -0.691 + 10.0 * std::log10(energy)) : kLoudnessFloorDb;
+}
+
+double lufsToEnergy(double lufs) {
+  return std::pow(10.0, (lufs + 0.691) / 10.0);
+}
+
+/** Mean energy of windows of `span` sub-blocks, one per sub-block step. */
+std::vector<double> slidingWindows(const std::vector<double>& subBlocks, int span) {
+  std::vector<double> windows;
+  if (static_cast<int>(subBlocks.size()) < span) {
+    return windows;
+  }
+  double sum = 0.0;
+  for (int i = 0; i < span; ++i) {
+    sum += subBlocks[static_cast<size_t>(i)];
+  }
+  windows.push_back(sum / span);
+  for (size_t i = static_cast<size_t>(span); i < subBlocks.size(); ++i) {
+    sum += subBlocks[i] - subBlocks[i - static_cast<size_t>(span)];
+    windows.push_back(std::max(0.0, sum) / span);
+  }
+  return windows;
+}
+
+double percentile(std::vector<double> values, double fraction) {
+  std::sort(values.begin(), values.end());
+  const double index = fraction * static_cast<double>(values.size() - 1);
+  const auto lower = static_cast<size_t>(std::floor(index));
+  const auto upper = std::min(values.size() - 1, lower + 1);
+  return values[lower] + (values[upper] - values[lower]) * (index - static_cast<double>(lower));
+}
+
+}  // namespace
+
+bool measureLoudness(juce::AudioFormatReader& reader, double startSeconds, double lengthSeconds, LoudnessStats& stats) {
+  stats = {};
+  if (reader.sampleRate <= 0.0 || reader.numChannels == 0) {
+    return false;
+  }
+  const double sampleRate = reader.sampleRate;
+  const int channels = std::min(static_cast<int>(reader.numChannels), kMaxChannels);
+  const auto firstSample = std::max<juce::int64>(0, static_cast<juce::int64>(std::llround(startSeconds * sampleRate)));
+  juce::int64 totalSamples = lengthSeconds > 0.0
+    ? static_cast<juce::int64>(std::llround(lengthSeconds * sampleRate))
+    : reader.lengthInSamples - firstSample;
+  totalSamples = std::min(totalSamples, reader.lengthInSamples - firstSample);
+  if (totalSamples <= 0) {
+    return true;
+  }
+  stats.durationSeconds = static_cast<double>(totalSamples) / sampleRate;
+
+  const int laneCount = static_cast<int>(Lanes::size());
+  const int groups = (channels + laneCount - 1) / laneCount;
+  std::vector<KWeightingLanes> filters(static_cast<size_t>(groups), KWeightingLanes(kWeightingFor(sampleRate)));
+  std::vector<double> weights(static_cast<size_t>(groups * laneCount), 0.0);
+  for (int ch = 0; ch < channels; ++ch) {
+    weights[static_cast<size_t>(ch)] = channelWeight(ch, channels);
+  }
+
+  juce::dsp::Oversampling<float> oversampler(
+    static_cast<size_t>(channels),
+    2,  // 2^2 = 4x
+    juce::dsp::Oversampling<float>::filterHalfBandFIREquiripple,
+    true,
+    false
+  );
+  oversampler.initProcessing(static_cast<size_t>(kBlockSamples));
+
+  juce::AudioBuffer<float> buffer(channels, kBlockSamples);
+  const auto subBlockSamples = static_cast<int>(std::lround(sampleRate * 0.1));
+  std::vector<Lanes> squares(static_cast<size_t>(groups), Lanes::expand(0.0));
+  int subBlockFill = 0;
+  std::vector<double> subBlocks;
+  subBlocks.reserve(static_cast<size_t>(totalSamples / subBlockSamples + 1));
+  float samplePeak = 0.0F;
+  float truePeak = 0.0F;
+
+  const auto trackTruePeak = [&](int numSamples) {
+    juce::dsp::AudioBlock<float> block(buffer.getArrayOfWritePointers(), static_cast<size_t>(channels), static_cast<size_t>(numSamples));
+    const auto upsampled = oversampler.processSamplesUp(block);
+    for (int ch = 0; ch < channels; ++ch) {
+      const auto range = juce::FloatVectorOperations::findMinAndMax(
+        upsampled.getChannelPointer(static_cast<size_t>(ch)),
+        static_cast<int>(upsampled.getNumSamples())
+      );
+      truePeak = std::max({truePeak, -range.getStart(), range.getEnd()});
+    }
+  };
+
+  for (juce::int64 position = 0; position < totalSamples; position += kBlockSamples) {
+    const int count = static_cast<int>(std::min<juce::int64>(kBlockSamples, totalSamples - position));
+    if (!reader.read(buffer.getArrayOfWritePointers(), channels, firstSample + position, count)) {
+      return false;
+    }
+    for (int ch = 0; ch < channels; ++ch) {
+      const auto range = juce::FloatVectorOperations::findMinAndMax(buffer.getReadPointer(ch), count);
+      samplePeak = std::max({samplePeak, -range.getStart(), range.getEnd()});
+    }
+    trackTruePeak(count);
+
+    for (int i = 0; i < count; ++i) {
+      for (int group = 0; group < groups; ++group) {
+        Lanes x = Lanes::expand(0.0);
+        for (int lane = 0; lane < laneCount; ++lane) {
+          const int ch = group * laneCount + lane;
+          if (ch < channels) {
+            x.set(static_cast<size_t>(lane), static_cast<double>(buffer.getSample(ch, i)));
+          }
+        }
+        const Lanes y = filters[static_cast<size_t>(group)].process(x);
+        squares[static_cast<size_t>(group)] = squares[static_cast<size_t>(group)] + y * y;
+      }
+      if (++subBlockFill == subBlockSamples) {
+        double energy = 0.0;
+        for (int group = 0; group < groups; ++group) {
+          for (int lane = 0; lane < laneCount; ++lane) {
+            energy += weights[static_cast<size_t>(group * laneCount + lane)] * squares[static_cast<size_t>(group)].get(static_cast<size_t>(lane));
+          }
+          squares[static_cast<size_t>(group)] = Lanes::expand(0.0);
+        }
+        subBlocks.push_back(energy / subBlockSamples);
+        subBlockFill = 0;
+      }
+    }
+  }
+  // Flush the oversampling filter so peaks in its latency window are not lost.
+  const int tail = std::min(kBlockSamples, static_cast<int>(std::ceil(oversampler.getLatencyInSamples())) + 1);
+  buffer.clear();
+  trackTruePeak(tail);
+
+  stats.samplePeakDbfs = std::max(kLoudnessFloorDb, static_cast<double>(juce::Decibels::gainToDecibels(samplePeak, -1000.0F)));
+  stats.truePeakDbtp = std::max(kLoudnessFloorDb, static_cast<double>(juce::Decibels::gainToDecibels(truePeak, -1000.0F)));
+
+  const auto momentary = slidingWindows(subBlocks, kMomentarySubBlocks);
+  const auto shortTerm = slidingWindows(subBlocks, kShortTermSubBlocks);
+  for (const double energy : momentary) {
+    stats.momentaryMaxLufs = std::max(stats.momentaryMaxLufs, energyToLufs(energy));
+  }
+  for (const double energy : shortTerm) {
+    stats.shortTermMaxLufs = std::max(stats.shortTermMaxLufs, energyToLufs(energy));
+  }
+
+  // Integrated: absolute gate, then relative gate at -10 LU below the absolute-gated mean.
+  const double absoluteGate = lufsToEnergy(kAbsoluteGateLufs);
+  double sum = 0.0;
+  int gated = 0;
+  for (const double energy : momentary) {
+    if (energy > absoluteGate) {
+      sum += energy;
+      ++gated;
+    }
+  }
+  if (gated > 0) {
+    const double relativeGate = lufsToEnergy(energyToLufs(sum / gated) + kIntegratedRelativeGateLu);
+    double relativeSum = 0.0;
+    int relativeCount = 0;
+    for (const double energy : momentary) {
+      if (energy > absoluteGate && energy > relativeGate) {
+        relativeSum += energy;
+        ++relativeCount;
+      }
+    }
+    if (relativeCount > 0) {
+      stats.integratedLufs = energyToLufs(relativeSum / relativeCount);
+    }
+  }
+
+  // Loudness range over short-term values: absolute gate, relative gate at -20 LU, P95 - P10.
+  std::vector<double> rangeEnergies;
+  for (const double energy : shortTerm) {
+    if (energy > absoluteGate) {
+      rangeEnergies.push_back(energy);
+    }
+  }
+  if (!rangeEnergies.empty()) {
+    double rangeSum = 0.0;
+    for (const double energy : rangeEnergies) {
+      rangeSum += energy;
+    }
+    const double relativeGate = lufsToEnergy(energyToLufs(rangeSum / rangeEnergies.size()) + kRangeRelativeGateLu);
+    std::vector<double> levels;
+    for (const double energy : rangeEnergies) {
+      if (energy > relativeGate) {
+        levels.push_back(energyToLufs(energy));
+      }
+    }
+    if (!levels.empty()) {
+      stats.loudnessRangeLu = percentile(levels, 0.95) - percentile(levels, 0.10);
+    }
+  }
+  return true;
+}
+
+}  // namespace thestuu::native
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <juce_audio_formats/juce_audio_formats.h>
+
+namespace thestuu::native {
+
+/** Reported for silence (nothing above the -70 LUFS absolute gate) and for empty ranges. */
+constexpr double kLoudnessFloorDb = -120.0;
+
+/** EBU R128 / ITU-R BS.1770-4 measurement of one range of audio. */
+struct LoudnessStats {
+  double integratedLufs = kLoudnessFloorDb;
+  /** Maximum of the 400 ms momentary and 3 s short-term loudness (100 ms steps). */
+  double momentaryMaxLufs = kLoudnessFloorDb;
+  double shortTermMaxLufs = kLoudnessFloorDb;
+  /** EBU Tech 3342: spread of the gated short-term loudness (10th to 95th percentile). */
+  double loudnessRangeLu = 0.0;
+  /** 4x oversampled peak (dBTP) and plain sample peak (dBFS). */
+  double truePeakDbtp = kLoudnessFloorDb;
+  double samplePeakDbfs = kLoudnessFloorDb;
+  double durationSeconds = 0.0;
+};
+
+/** Measures [startSeconds, startSeconds + lengthSeconds) of reader (lengthSeconds <= 0: to the end),
+ *  streamed block by block. The K-weighting runs with all channels of a sample side by side in SIMD
+ *  lanes. Channels 4 and 5 of 5.1 material count as surrounds (+1.5 dB), channel 3 as LFE (excluded).
+ *  Returns false if the reader fails. Thread-safe per reader. */
+bool measureLoudness(juce::AudioFormatReader& reader, double startSeconds, double lengthSeconds, LoudnessStats& stats);
+
+}  // namespace thestuu::native
@@ -31,6 +31,15 @@ namespace {
 constexpr int kBeatsPerBar = 4;
 constexpr int kStepsPerBeat = 4;
 constexpr int kTickMs = 40;
+/** Tick interval and select() timeout while the backend is in idle power mode. */
+constexpr int kIdleTickMs = 1000;
+constexpr int kIdleSelectTimeoutUs = 250000;
+/** Queries the UI polls; they change nothing, so they do not restart the idle power countdown. */
+constexpr std::array<const char*, 13> kPassiveCommands = {
+  "transport.get_state", "backend.info", "health.ping", "audio.get_outputs", "audio.get_inputs",
+  "track:list", "eq:spectrum", "perf:stats", "latency:report", "cache:stats", "clip:source-pool",
+  "vst:scan", "power:idle",
+};
 constexpr size_t kFrameHeaderBytes = 4;
 constexpr uint32_t kMaxFrameSize = 1024 * 1024;
 
@@ -40,7 +49,9 @@ static bool g_useTracktionTransport = false;
 struct MsgValue {
   using Object = std::map<std::string, MsgValue>;
   using Array = std::vector<MsgValue>;
-  using Storage = std::variant<std::monostate, bool, int64_t, double, std::string, Object, Array>;
+  /** Encoded as an array of msgpack float32 (half the size of doubles); never produced by the decoder. */
+  using Float32Array = std::vector<float>;
+  using Storage = std::variant<std::monostate, bool, int64_t, double, std::string, Object, Array, Float32Array>;
 
   Storage value;
 
@@ -53,6 +64,7 @@ struct MsgValue {
   MsgValue(const char* v) : value(std::string(v)) {}
   MsgValue(Object v) : value(std::move(v)) {}
   MsgValue(Array v) : value(std::move(v)) {}
+  MsgValue(Float32Array v) : value(std::move(v)) {}
 };
 
 void writeUint16BE(std::vector<uint8_t>& out, uint16_t value) {
@@ -147,6 +159,18 @@ void encodeInt(int64_t number, std::vector<uint8_t>& out) {
   writeUint64BE(out, static_cast<uint64_t>(number));
 }
 
+void encodeArrayHeader(size_t length, std::vector<uint8_t>& out) {
+  if (length <= 15) {
+    out.push_back(static_cast<uint8_t>(0x90 | length));
+  } else if (length <= 0xFFFF) {
+    out.push_back(0xDC);
+    writeUint16BE(out, static_cast<uint16_t>(length));
+  } else {
+    out.push_back(0xDD);
+    writeUint32BE(out, static_cast<uint32_t>(length));
+  }
+}
+
 void encodeValue(const MsgValue& value, std::vector<uint8_t>& out) {
   if (std::holds_alternative<std::monostate>(value.value)) {
     out.push_back(0xC0);
@@ -190,19 +214,20 @@ void encodeValue(const MsgValue& value, std::vector<uint8_t>& out) {
     return;
   }
   if (const auto* arrayValue = std::get_if<MsgValue::Array>(&value.value)) {
-    const size_t length = arrayValue->size();
-    if (length <= 15) {
-      out.push_back(static_cast<uint8_t>(0x90 | length));
-    } else if (length <= 0xFFFF) {
-      out.push_back(0xDC);
-      writeUint16BE(out, static_cast<uint16_t>(length));
-    } else {
-      out.push_back(0xDD);
-      writeUint32BE(out, static_cast<uint32_t>(length));
-    }
+    encodeArrayHeader(arrayValue->size(), out);
     for (const auto& entry : *arrayValue) {
       encodeValue(entry, out);
     }
+    return;
+  }
+  if (const auto* floatValues = std::get_if<MsgValue::Float32Array>(&value.value)) {
+    encodeArrayHeader(floatValues->size(), out);
+    for (const float entry : *floatValues) {
+      out.push_back(0xCA);
+      uint32_t bits = 0;
+      std::memcpy(&bits, &entry, sizeof(bits));
+      writeUint32BE(out, bits);
+    }
   }
 }
 
@@ -382,6 +407,12 @@ const MsgValue* getField(const MsgValue::Object& object, const std::string& key)
   return &it->second;
 }
 
+const MsgValue& getOrNull(const MsgValue::Object& object, const std::string& key) {
+  static const MsgValue kNull;
+  const auto* value = getField(object, key);
+  return value != nullptr ? *value : kNull;
+}
+
 const MsgValue::Object* asObject(const MsgValue* value) {
   if (value == nullptr) {
     return nullptr;
@@ -499,6 +530,9 @@ struct TransportCore {
   bool playing = false;
   double bpm = 128.0;
   double offsetBeats = 0.0;
+  bool looping = false;
+  double loopStartBeats = 0.0;
+  double loopEndBeats = 0.0;
   std::chrono::steady_clock::time_point startedAt = std::chrono::steady_clock::now();
 
   double positionBeatsAt(std::chrono::steady_clock::time_point now) const {
@@ -507,7 +541,22 @@ struct TransportCore {
     }
     const auto elapsedMs = std::chrono::duration_cast<std::chrono::milliseconds>(now - startedAt).count();
     const double elapsedBeats = static_cast<double>(elapsedMs) * (bpm / 60000.0);
-    return std::max(0.0, offsetBeats + elapsedBeats);
+    const double position = std::max(0.0, offsetBeats + elapsedBeats);
+    const double loopLength = loopEndBeats - loopStartBeats;
+    if (looping && loopLength > 0.0 && position >= loopEndBeats) {
+      return loopStartBeats + std::fmod(position - loopStartBeats, loopLength);
+    }
+    return position;
+  }
+
+  void setLoop(bool enabled, double startBeats, double endBeats) {
+    if (playing) {
+      offsetBeats = positionBeatsAt(std::chrono::steady_clock::now());
+      startedAt = std::chrono::steady_clock::now();
+    }
+    looping = enabled && endBeats > startBeats;
+    loopStartBeats = std::max(0.0, startBeats);
+    loopEndBeats = std::max(loopStartBeats, endBeats);
   }
 
   void play() {
@@ -568,6 +617,9 @@ struct TransportCore {
       {"stepIndex", MsgValue(stepIndex)},
       {"positionBars", MsgValue(positionBars)},
       {"positionBeats", MsgValue(positionBeats)},
+      {"looping", MsgValue(looping)},
+      {"loopStartBeats", MsgValue(loopStartBeats)},
+      {"loopEndBeats", MsgValue(loopEndBeats)},
       {"timestamp", MsgValue(static_cast<int64_t>(timestamp))},
     };
   }
@@ -620,6 +672,19 @@ void logJson(const std::string& type, const std::string& message) {
   std::cerr << "{\"type\":\"" << escapeJson(type) << "\",\"message\":\"" << escapeJson(message) << "\"}\n";
 }
 
+/** General MIDI drum notes for the default .stu lanes (Kick/Snare/CH/OH/Clap). */
+int64_t defaultDrumLaneNote(const std::string& lane) {
+  static const std::map<std::string, int64_t> kLaneNotes{
+    {"Kick", 36},
+    {"Snare", 38},
+    {"Clap", 39},
+    {"CH", 42},
+    {"OH", 46},
+  };
+  const auto it = kLaneNotes.find(lane);
+  return it != kLaneNotes.end() ? it->second : 60;
+}
+
 MsgValue toMsgValue(const thestuu::native::PluginParameterInfo& parameter) {
   return MsgValue(MsgValue::Object{
     {"id", MsgValue(parameter.id)},
@@ -697,6 +762,9 @@ MsgValue::Object snapshotToMsgObject(const thestuu::native::TransportSnapshot& s
     {"stepIndex", MsgValue(s.stepIndex)},
     {"positionBars", MsgValue(s.positionBars)},
     {"positionBeats", MsgValue(s.positionBeats)},
+    {"looping", MsgValue(s.looping)},
+    {"loopStartBeats", MsgValue(s.loopStartBeats)},
+    {"loopEndBeats", MsgValue(s.loopEndBeats)},
     {"timestamp", MsgValue(s.timestamp)},
   };
 }
@@ -730,7 +798,115 @@ MsgValue makeTickEvent(const TransportCore& transport) {
   });
 }
 
-MsgValue handleRequest(const MsgValue::Object& request, TransportCore& transport) {
+MsgValue toMsgValue(const thestuu::native::PluginLatencyInfo& plugin) {
+  return MsgValue(MsgValue::Object{
+    {"pluginIndex", MsgValue(static_cast<int64_t>(plugin.pluginIndex))},
+    {"name", MsgValue(plugin.name)},
+    {"latencySeconds", MsgValue(plugin.latencySeconds)},
+    {"enabled", MsgValue(plugin.enabled)},
+    {"lowLatencyBypassed", MsgValue(plugin.lowLatencyBypassed)},
+  });
+}
+
+MsgValue toMsgValue(const thestuu::native::LatencyReport& report) {
+  MsgValue::Array tracks;
+  tracks.reserve(report.tracks.size());
+  for (const auto& track : report.tracks) {
+    MsgValue::Array plugins;
+    for (const auto& plugin : track.plugins) {
+      plugins.push_back(toMsgValue(plugin));
+    }
+    tracks.push_back(MsgValue(MsgValue::Object{
+      {"trackId", MsgValue(static_cast<int64_t>(track.trackId))},
+      {"armed", MsgValue(track.armed)},
+      {"pluginLatencySeconds", MsgValue(track.pluginLatencySeconds)},
+      {"pathLatencySeconds", MsgValue(track.pathLatencySeconds)},
+      {"plugins", MsgValue(std::move(plugins))},
+    }));
+  }
+  MsgValue::Array masterPlugins;
+  for (const auto& plugin : report.masterPlugins) {
+    masterPlugins.push_back(toMsgValue(plugin));
+  }
+  return MsgValue(MsgValue::Object{
+    {"sampleRate", MsgValue(report.sampleRate)},
+    {"tracks", MsgValue(std::move(tracks))},
+    {"masterPlugins", MsgValue(std::move(masterPlugins))},
+    {"masterLatencySeconds", MsgValue(report.masterLatencySeconds)},
+    {"graphLatencySeconds", MsgValue(report.graphLatencySeconds)},
+    {"outputLatencySeconds", MsgValue(report.outputLatencySeconds)},
+    {"totalLatencySeconds", MsgValue(report.totalLatencySeconds)},
+    {"lowLatencyMonitoring", MsgValue(report.lowLatencyMonitoring)},
+    {"lowLatencyThresholdMs", MsgValue(report.lowLatencyThresholdSeconds * 1000.0)},
+  });
+}
+
+MsgValue toMsgValue(const thestuu::native::PerfStats& stats) {
+  MsgValue::Array tracks;
+  tracks.reserve(stats.tracks.size());
+  for (const auto& track : stats.tracks) {
+    tracks.push_back(MsgValue(MsgValue::Object{
+      {"trackId", MsgValue(static_cast<int64_t>(track.trackId))},
+      {"suspended", MsgValue(track.suspended)},
+      {"peakDb", MsgValue(track.peakDb)},
+    }));
+  }
+  return MsgValue(MsgValue::Object{
+    {"cpuUsage", MsgValue(stats.cpuUsage)},
+    {"suspensionEnabled", MsgValue(stats.suspensionEnabled)},
+    {"suspendedCount", MsgValue(static_cast<int64_t>(stats.suspendedCount))},
+    {"tracks", MsgValue(std::move(tracks))},
+  });
+}
+
+MsgValue makePluginLoadEvent(const thestuu::native::PluginLoadEvent& loadEvent) {
+  MsgValue::Object payload{
+    {"loadId", MsgValue(loadEvent.loadId)},
+    {"stage", MsgValue(loadEvent.stage)},
+    {"progress", MsgValue(loadEvent.progress)},
+  };
+  if (loadEvent.stage == "done") {
+    payload["plugin"] = toMsgValue(loadEvent.plugin);
+  } else if (!loadEvent.error.empty()) {
+    payload["error"] = MsgValue(loadEvent.error);
+  }
+  return MsgValue(MsgValue::Object{
+    {"type", MsgValue("event")},
+    {"event", MsgValue("vst:load-progress")},
+    {"payload", MsgValue(payload)},
+  });
+}
+
+/** track_uid (stable) wins over track_id/trackId (1-based position); an unknown uid yields 0, which every
+ *  track command rejects as out of range. */
+int32_t readTrackId(const MsgValue::Object& payload, int64_t fallback) {
+  if (g_useTracktionTransport) {
+    std::string trackUid = asString(getField(payload, "track_uid"));
+    if (trackUid.empty()) {
+      trackUid = asString(getField(payload, "trackUid"));
+    }
+    if (!trackUid.empty()) {
+      return thestuu::native::resolveTrackUid(trackUid);
+    }
+  }
+  return static_cast<int32_t>(asInt(getField(payload, "track_id"), asInt(getField(payload, "trackId"), fallback)));
+}
+
+MsgValue makeSandboxEvent(const thestuu::native::SandboxEvent& sandboxEvent) {
+  return MsgValue(MsgValue::Object{
+    {"type", MsgValue("event")},
+    {"event", MsgValue("vst:sandbox")},
+    {"payload", MsgValue(MsgValue::Object{
+      {"trackId", MsgValue(static_cast<int64_t>(sandboxEvent.trackId))},
+      {"pluginIndex", MsgValue(static_cast<int64_t>(sandboxEvent.pluginIndex))},
+      {"name", MsgValue(sandboxEvent.name)},
+      {"status", MsgValue(sandboxEvent.status)},
+      {"restarts", MsgValue(static_cast<int64_t>(sandboxEvent.restarts))},
+    })},
+  });
+}
+
+MsgValue dispatchRequest(const MsgValue::Object& request, TransportCore& transport) {
   const int64_t id = asInt(getField(request, "id"), 0);
   const std::string type = asString(getField(request, "type"));
   if (type != "request") {
@@ -829,6 +1005,101 @@ MsgValue handleRequest(const MsgValue::Object& request, TransportCore& transport
     }
     return makeResponse(id, MsgValue::Object{{"transport", MsgValue(transport.snapshot())}});
   }
+  if (cmd == "transport.set-loop" || cmd == "transport:set-loop") {
+    if (payload == nullptr) {
+      return makeErrorResponse(id, "transport.set-loop requires payload");
+    }
+    const double startBeats = asDouble(
+      getField(*payload, "start_beats"),
+      asDouble(getField(*payload, "startBeats"), 0.0)
+    );
+    const double endBeats = asDouble(
+      getField(*payload, "end_beats"),
+      asDouble(getField(*payload, "endBeats"), 0.0)
+    );
+    const bool enabled = asBool(getField(*payload, "enabled"), endBeats > startBeats);
+    if (enabled && !(std::isfinite(startBeats) && std::isfinite(endBeats) && endBeats > startBeats && startBeats >= 0.0)) {
+      return makeErrorResponse(id, "transport.set-loop requires 0 <= start_beats < end_beats");
+    }
+    if (g_useTracktionTransport) {
+      std::string error;
+      if (!thestuu::native::transportSetLoop(enabled, startBeats, endBeats, error)) {
+        return makeErrorResponse(id, error);
+      }
+      thestuu::native::TransportSnapshot backendSnap;
+      if (thestuu::native::getTransportSnapshot(backendSnap)) {
+        return makeResponse(id, MsgValue::Object{{"transport", MsgValue(snapshotToMsgObject(backendSnap))}});
+      }
+    } else {
+      transport.setLoop(enabled, startBeats, endBeats);
+    }
+    return makeResponse(id, MsgValue::Object{{"transport", MsgValue(transport.snapshot())}});
+  }
+  if (cmd == "transport.scrub" || cmd == "transport:scrub") {
+    if (payload == nullptr) {
+      return makeErrorResponse(id, "transport.scrub requires payload");
+    }
+    const std::string action = asString(getField(*payload, "action"), "update");
+    thestuu::native::ScrubAction scrubAction = thestuu::native::ScrubAction::update;
+    if (action == "begin") {
+      scrubAction = thestuu::native::ScrubAction::begin;
+    } else if (action == "end") {
+      scrubAction = thestuu::native::ScrubAction::end;
+    } else if (action != "update") {
+      return makeErrorResponse(id, "transport.scrub action must be begin, update or end");
+    }
+    const double positionBeats = asDouble(
+      getField(*payload, "position_beats"),
+      asDouble(getField(*payload, "positionBeats"), 0.0)
+    );
+    const double velocity = asDouble(getField(*payload, "velocity"), 0.0);
+    if (!std::isfinite(positionBeats) || !std::isfinite(velocity)) {
+      return makeErrorResponse(id, "transport.scrub requires finite position_beats/velocity");
+    }
+    if (!g_useTracktionTransport) {
+      if (scrubAction == thestuu::native::ScrubAction::begin) {
+        transport.pause();
+      }
+      transport.seekToBeats(positionBeats);
+      return makeResponse(id, MsgValue::Object{{"transport", MsgValue(transport.snapshot())}});
+    }
+    std::string error;
+    if (!thestuu::native::transportScrub(scrubAction, positionBeats, velocity, error)) {
+      return makeErrorResponse(id, error);
+    }
+    if (scrubAction == thestuu::native::ScrubAction::update) {
+      // Keep the hot path cheap: updates arrive at UI rate and don't need a full snapshot.
+      return makeResponse(id, MsgValue::Object{{"positionBeats", MsgValue(positionBeats)}});
+    }
+    thestuu::native::TransportSnapshot backendSnap;
+    if (thestuu::native::getTransportSnapshot(backendSnap)) {
+      return makeResponse(id, MsgValue::Object{{"transport", MsgValue(snapshotToMsgObject(backendSnap))}});
+    }
+    return makeResponse(id, MsgValue::Object{{"transport", MsgValue(transport.snapshot())}});
+  }
+  if (cmd == "metronome:set") {
+    if (payload == nullptr) {
+      return makeErrorResponse(id, "metronome:set requires payload");
+    }
+    thestuu::native::MetronomeSettings settings;
+    settings.enabled = asBool(getField(*payload, "enabled"), false);
+    settings.level = asDouble(getField(*payload, "level"), 0.6);
+    settings.accentBars = asBool(getField(*payload, "accent_bars"), asBool(getField(*payload, "accentBars"), true));
+    settings.countInBars = static_cast<int32_t>(
+      asInt(getField(*payload, "count_in_bars"), asInt(getField(*payload, "countInBars"), 0))
+    );
+    thestuu::native::MetronomeSettings applied;
+    std::string error;
+    if (!thestuu::native::setMetronome(settings, applied, error)) {
+      return makeErrorResponse(id, error);
+    }
+    return makeResponse(id, MsgValue::Object{
+      {"enabled", MsgValue(applied.enabled)},
+      {"level", MsgValue(applied.level)},
+      {"accentBars", MsgValue(applied.accentBars)},
+      {"countInBars", MsgValue(applied.countInBars)},
+    });
+  }
   if (cmd == "edit:reset") {
     const int32_t requestedTrackCount = static_cast<int32_t>(
       payload ? asInt(getField(*payload, "track_count"), asInt(getField(*payload, "trackCount"), 16)) : 16
@@ -858,7 +1129,32 @@ MsgValue handleRequest(const MsgValue::Object& request, TransportCore& transport
     return makeResponse(id, MsgValue::Object{});
   }
   if (cmd == "backend.info") {
-    return makeResponse(id, MsgValue::Object{{"tracktion", MsgValue(g_useTracktionTransport)}});
+    MsgValue::Array threads;
+    for (const auto& state : thestuu::native::getThreadSchedulingReport()) {
+      MsgValue::Array cpus;
+      cpus.reserve(state.cpus.size());
+      for (const int cpu : state.cpus) {
+        cpus.push_back(MsgValue(static_cast<int64_t>(cpu)));
+      }
+      MsgValue::Object entry{
+        {"role", MsgValue(state.role)},
+        {"threadId", MsgValue(static_cast<int64_t>(state.threadId))},
+        {"policy", MsgValue(state.policy)},
+        {"priority", MsgValue(static_cast<int64_t>(state.priority))},
+        {"cpus", MsgValue(std::move(cpus))},
+      };
+      if (!state.error.empty()) {
+        entry["error"] = MsgValue(state.error);
+      }
+      threads.push_back(MsgValue(std::move(entry)));
+    }
+    return makeResponse(
+      id,
+      MsgValue::Object{
+        {"tracktion", MsgValue(g_useTracktionTransport)},
+        {"threads", MsgValue(std::move(threads))},
+      }
+    );
   }
   if (cmd == "health.ping") {
     return makeResponse(id, MsgValue::Object{{"pong", MsgValue(true)}});
@@ -938,12 +1234,32 @@ MsgValue handleRequest(const MsgValue::Object& request, TransportCore& transport
       return makeErrorResponse(id, "vst:load requires plugin_uid");
     }
 
-    const int32_t trackId = static_cast<int32_t>(
-      asInt(
-        getField(*payload, "track_id"),
-        asInt(getField(*payload, "trackId"), 1)
-      )
-    );
+    const int32_t trackId = readTrackId(*payload, 1);
+
+    if (g_useTracktionTransport && asBool(getField(*payload, "sandbox"), false)) {
+      thestuu::native::LoadPluginResult result;
+      std::string error;
+      if (!thestuu::native::loadPluginSandboxed(pluginUid, trackId, result, error)) {
+        return makeErrorResponse(id, error);
+      }
+      MsgValue::Object response{{"plugin", toMsgValue(result)}};
+      response["sandboxed"] = MsgValue(true);
+      return makeResponse(id, response);
+    }
+    if (g_useTracktionTransport && asBool(getField(*payload, "async"), false)) {
+      std::string error;
+      const int64_t loadId = thestuu::native::loadPluginAsync(pluginUid, trackId, error);
+      if (loadId == 0) {
+        return makeErrorResponse(id, error);
+      }
+      return makeResponse(
+        id,
+        MsgValue::Object{
+          {"loadId", MsgValue(loadId)},
+          {"status", MsgValue("queued")},
+        }
+      );
+    }
 
     thestuu::native::LoadPluginResult result;
     std::string error;
@@ -953,17 +1269,41 @@ MsgValue handleRequest(const MsgValue::Object& request, TransportCore& transport
 
     return makeResponse(id, MsgValue::Object{{"plugin", toMsgValue(result)}});
   }
+  if (cmd == "vst:pool") {
+    thestuu::native::PluginPoolConfig config;
+    if (payload != nullptr) {
+      const MsgValue& uids = getOrNull(*payload, "uids");
+      if (const auto* list = std::get_if<MsgValue::Array>(&uids.value)) {
+        for (const auto& entry : *list) {
+          const std::string uid = asString(&entry);
+          if (!uid.empty()) {
+            config.uids.push_back(uid);
+          }
+        }
+      }
+      config.perUid = static_cast<int32_t>(asInt(getField(*payload, "per_uid"), asInt(getField(*payload, "perUid"), 1)));
+      config.topN = static_cast<int32_t>(asInt(getField(*payload, "top_n"), asInt(getField(*payload, "topN"), 3)));
+    }
+    thestuu::native::PluginPoolStats stats;
+    std::string error;
+    if (!thestuu::native::configurePluginPool(config, stats, error)) {
+      return makeErrorResponse(id, error);
+    }
+    return makeResponse(
+      id,
+      MsgValue::Object{
+        {"perUid", MsgValue(static_cast<int64_t>(stats.perUid))},
+        {"topN", MsgValue(static_cast<int64_t>(stats.topN))},
+        {"pooledInstances", MsgValue(static_cast<int64_t>(stats.pooledInstances))},
+      }
+    );
+  }
   if (cmd == "vst:editor:open") {
     if (payload == nullptr) {
       return makeErrorResponse(id, "vst:editor:open requires payload");
     }
 
-    const int32_t trackId = static_cast<int32_t>(
-      asInt(
-        getField(*payload, "track_id"),
-        asInt(getField(*payload, "trackId"), 1)
-      )
-    );
+    const int32_t trackId = readTrackId(*payload, 1);
     const int32_t pluginIndex = static_cast<int32_t>(
       asInt(
         getField(*payload, "plugin_index"),
@@ -989,17 +1329,264 @@ MsgValue handleRequest(const MsgValue::Object& request, TransportCore& transport
       }
     );
   }
+  if (cmd == "eq:spectrum") {
+    if (payload == nullptr) {
+      return makeErrorResponse(id, "eq:spectrum requires payload");
+    }
+    thestuu::native::EqualiserSpectrumRequest request;
+    request.trackId = readTrackId(*payload, 1);
+    request.pluginIndex = static_cast<int32_t>(
+      asInt(getField(*payload, "plugin_index"), asInt(getField(*payload, "pluginIndex"), -1))
+    );
+    if (request.trackId <= 0 || request.pluginIndex < 0) {
+      return makeErrorResponse(id, "eq:spectrum requires track_id and plugin_index");
+    }
+    request.binCount = static_cast<int32_t>(asInt(getField(*payload, "bins"), request.binCount));
+    request.minHz = asDouble(getField(*payload, "min_hz"), request.minHz);
+    request.maxHz = asDouble(getField(*payload, "max_hz"), request.maxHz);
+
+    thestuu::native::EqualiserSpectrum spectrum;
+    std::string error;
+    if (!thestuu::native::getEqualiserSpectrum(request, spectrum, error)) {
+      return makeErrorResponse(id, error);
+    }
+    return makeResponse(
+      id,
+      MsgValue::Object{
+        {"trackId", MsgValue(request.trackId)},
+        {"pluginIndex", MsgValue(request.pluginIndex)},
+        {"sampleRate", MsgValue(spectrum.sampleRate)},
+        {"minHz", MsgValue(request.minHz)},
+        {"maxHz", MsgValue(request.maxHz)},
+        {"live", MsgValue(spectrum.live)},
+        {"preDb", MsgValue(std::move(spectrum.preDb))},
+        {"postDb", MsgValue(std::move(spectrum.postDb))},
+      }
+    );
+  }
+
+  if (cmd == "vst:remove" || cmd == "vst:move" || cmd == "vst:bypass") {
+    if (payload == nullptr) {
+      return makeErrorResponse(id, cmd + " requires payload");
+    }
+    const int32_t trackId = readTrackId(*payload, 0);
+    const int32_t pluginIndex = static_cast<int32_t>(
+      asInt(getField(*payload, "plugin_index"), asInt(getField(*payload, "pluginIndex"), -1))
+    );
+    if (trackId <= 0 || pluginIndex < 0) {
+      return makeErrorResponse(id, cmd + " requires track_id and plugin_index");
+    }
+
+    MsgValue::Object response{
+      {"trackId", MsgValue(static_cast<int64_t>(trackId))},
+      {"pluginIndex", MsgValue(static_cast<int64_t>(pluginIndex))},
+    };
+    std::string error;
+    bool ok = false;
+    if (cmd == "vst:remove") {
+      ok = thestuu::native::removePlugin(trackId, pluginIndex, error);
+    } else if (cmd == "vst:move") {
+      const int32_t toIndex = static_cast<int32_t>(asInt(getField(*payload, "to_index"), asInt(getField(*payload, "toIndex"), -1)));
+      if (toIndex < 0) {
+        return makeErrorResponse(id, "vst:move requires to_index");
+      }
+      ok = thestuu::native::movePlugin(trackId, pluginIndex, toIndex, error);
+      response["toIndex"] = MsgValue(static_cast<int64_t>(toIndex));
+    } else {
+      const bool bypass = asBool(getField(*payload, "bypass"), true);
+      ok = thestuu::native::setPluginBypass(trackId, pluginIndex, bypass, error);
+      response["bypass"] = MsgValue(bypass);
+    }
+    if (!ok) {
+      return makeErrorResponse(id, error);
+    }
+    return makeResponse(id, response);
+  }
+  if (cmd == "power:idle") {
+    const bool enabled = payload ? asBool(getField(*payload, "enabled"), true) : true;
+    const double timeoutSeconds = payload
+      ? asDouble(getField(*payload, "timeout_seconds"), asDouble(getField(*payload, "timeoutSeconds"), 0.0))
+      : 0.0;
+    thestuu::native::IdlePowerStatus status;
+    std::string error;
+    if (!thestuu::native::setIdlePower(enabled, timeoutSeconds, status, error)) {
+      return makeErrorResponse(id, error);
+    }
+    return makeResponse(
+      id,
+      MsgValue::Object{
+        {"enabled", MsgValue(status.enabled)},
+        {"timeoutSeconds", MsgValue(status.timeoutSeconds)},
+        {"idle", MsgValue(status.idle)},
+      }
+    );
+  }
+  if (cmd == "perf:stats" || cmd == "perf:suspension") {
+    thestuu::native::PerfStats stats;
+    std::string error;
+    bool ok = false;
+    if (cmd == "perf:suspension") {
+      const bool enabled = payload ? asBool(getField(*payload, "enabled"), true) : true;
+      const double lookahead = payload
+        ? asDouble(getField(*payload, "lookahead_seconds"), asDouble(getField(*payload, "lookaheadSeconds"), 0.0))
+        : 0.0;
+      ok = thestuu::native::setTrackSuspension(enabled, lookahead, stats, error);
+    } else {
+      ok = thestuu::native::getPerfStats(stats, error);
+    }
+    if (!ok) {
+      return makeErrorResponse(id, error);
+    }
+    return makeResponse(id, MsgValue::Object{{"perf", toMsgValue(stats)}});
+  }
+  if (cmd == "latency:report" || cmd == "latency:monitoring") {
+    std::string error;
+    if (cmd == "latency:monitoring") {
+      if (payload == nullptr) {
+        return makeErrorResponse(id, "latency:monitoring requires payload");
+      }
+      const bool enabled = asBool(getField(*payload, "enabled"), false);
+      const double thresholdMs = asDouble(getField(*payload, "threshold_ms"), asDouble(getField(*payload, "thresholdMs"), -1.0));
+      if (!thestuu::native::setLowLatencyMonitoring(enabled, thresholdMs >= 0.0 ? thresholdMs / 1000.0 : -1.0, error)) {
+        return makeErrorResponse(id, error);
+      }
+    }
+    thestuu::native::LatencyReport report;
+    if (!thestuu::native::getLatencyReport(report, error)) {
+      return makeErrorResponse(id, error);
+    }
+    return makeResponse(id, MsgValue::Object{{"latency", toMsgValue(report)}});
+  }
+  if (cmd == "vst:set-sidechain") {
+    if (payload == nullptr) {
+      return makeErrorResponse(id, "vst:set-sidechain requires payload");
+    }
+    thestuu::native::SidechainRequest request;
+    request.trackId = readTrackId(*payload, 0);
+    request.pluginIndex = static_cast<int32_t>(
+      asInt(getField(*payload, "plugin_index"), asInt(getField(*payload, "pluginIndex"), -1))
+    );
+    request.sourceTrackId = static_cast<int32_t>(
+      asInt(getField(*payload, "source_track_id"), asInt(getField(*payload, "sourceTrackId"), 0))
+    );
+    request.preFader = asBool(getField(*payload, "pre_fader"), asBool(getField(*payload, "preFader"), false));
+    if (request.trackId <= 0 || request.pluginIndex < 0 || request.sourceTrackId < 0) {
+      return makeErrorResponse(id, "vst:set-sidechain requires track_id, plugin_index and source_track_id");
+    }
+    std::string error;
+    if (!thestuu::native::setPluginSidechain(request, error)) {
+      return makeErrorResponse(id, error);
+    }
+    return makeResponse(
+      id,
+      MsgValue::Object{
+        {"trackId", MsgValue(static_cast<int64_t>(request.trackId))},
+        {"pluginIndex", MsgValue(static_cast<int64_t>(request.pluginIndex))},
+        {"sourceTrackId", MsgValue(static_cast<int64_t>(request.sourceTrackId))},
+        {"preFader", MsgValue(request.preFader)},
+      }
+    );
+  }
+  if (cmd == "bus:create") {
+    const std::string kind = payload ? asString(getField(*payload, "kind"), "aux") : std::string("aux");
+    const std::string name = payload ? asString(getField(*payload, "name")) : std::string();
+    thestuu::native::BusInfo bus;
+    std::string error;
+    if (!thestuu::native::createBus(kind, name, bus, error)) {
+      return makeErrorResponse(id, error);
+    }
+    return makeResponse(
+      id,
+      MsgValue::Object{
+        {"busId", MsgValue(static_cast<int64_t>(bus.busId))},
+        {"kind", MsgValue(bus.kind)},
+        {"name", MsgValue(bus.name)},
+        {"auxBus", MsgValue(static_cast<int64_t>(bus.auxBusNumber))},
+      }
+    );
+  }
+  if (cmd == "bus:send") {
+    if (payload == nullptr) {
+      return makeErrorResponse(id, "bus:send requires payload");
+    }
+    thestuu::native::TrackSendRequest request;
+    request.trackId = readTrackId(*payload, 0);
+    request.busId = static_cast<int32_t>(asInt(getField(*payload, "bus_id"), asInt(getField(*payload, "busId"), 0)));
+    request.levelDb = asDouble(getField(*payload, "level_db"), asDouble(getField(*payload, "levelDb"), 0.0));
+    request.preFader = asBool(getField(*payload, "pre_fader"), asBool(getField(*payload, "preFader"), false));
+    request.remove = asBool(getField(*payload, "remove"), false);
+    if (request.trackId <= 0 || request.busId <= 0) {
+      return makeErrorResponse(id, "bus:send requires track_id and bus_id");
+    }
+    thestuu::native::TrackSendResult result;
+    std::string error;
+    if (!thestuu::native::setTrackSend(request, result, error)) {
+      return makeErrorResponse(id, error);
+    }
+    return makeResponse(
+      id,
+      MsgValue::Object{
+        {"trackId", MsgValue(static_cast<int64_t>(result.trackId))},
+        {"busId", MsgValue(static_cast<int64_t>(result.busId))},
+        {"pluginIndex", MsgValue(static_cast<int64_t>(result.pluginIndex))},
+        {"levelDb", MsgValue(result.levelDb)},
+        {"preFader", MsgValue(result.preFader)},
+      }
+    );
+  }
+  if (cmd == "bus:route") {
+    if (payload == nullptr) {
+      return makeErrorResponse(id, "bus:route requires payload");
+    }
+    const int32_t trackId = readTrackId(*payload, 0);
+    const int32_t busId = static_cast<int32_t>(asInt(getField(*payload, "bus_id"), asInt(getField(*payload, "busId"), 0)));
+    if (trackId <= 0 || busId < 0) {
+      return makeErrorResponse(id, "bus:route requires track_id and bus_id (0 = master)");
+    }
+    std::string error;
+    if (!thestuu::native::setTrackOutputBus(trackId, busId, error)) {
+      return makeErrorResponse(id, error);
+    }
+    return makeResponse(
+      id,
+      MsgValue::Object{
+        {"trackId", MsgValue(static_cast<int64_t>(trackId))},
+        {"busId", MsgValue(static_cast<int64_t>(busId))},
+      }
+    );
+  }
+  if (cmd == "bus:plugin:load") {
+    if (payload == nullptr) {
+      return makeErrorResponse(id, "bus:plugin:load requires payload");
+    }
+    std::string pluginUid = asString(getField(*payload, "plugin_uid"));
+    if (pluginUid.empty()) {
+      pluginUid = asString(getField(*payload, "pluginUid"));
+    }
+    if (pluginUid.empty()) {
+      return makeErrorResponse(id, "bus:plugin:load requires plugin_uid");
+    }
+    const int32_t busId = static_cast<int32_t>(asInt(getField(*payload, "bus_id"), asInt(getField(*payload, "busId"), 0)));
+
+    thestuu::native::LoadPluginResult result;
+    std::string error;
+    if (!thestuu::native::loadBusPlugin(pluginUid, busId, result, error)) {
+      return makeErrorResponse(id, error);
+    }
+    return makeResponse(
+      id,
+      MsgValue::Object{
+        {"busId", MsgValue(static_cast<int64_t>(busId))},
+        {"plugin", toMsgValue(result)},
+      }
+    );
+  }
   if (cmd == "vst:param:set") {
     if (payload == nullptr) {
       return makeErrorResponse(id, "vst:param:set requires payload");
     }
 
-    const int32_t trackId = static_cast<int32_t>(
-      asInt(
-        getField(*payload, "track_id"),
-        asInt(getField(*payload, "trackId"), 1)
-      )
-    );
+    const int32_t trackId = readTrackId(*payload, 1);
     const int32_t pluginIndex = static_cast<int32_t>(
       asInt(
         getField(*payload, "plugin_index"),
@@ -1038,11 +1625,7 @@ MsgValue handleRequest(const MsgValue::Object& request, TransportCore& transport
     }
 
     thestuu::native::ClipImportRequest request;
-    request.trackId = static_cast<int32_t>(
-      asInt(getField(*payload, "track_id"),
-        asInt(getField(*payload, "trackId"), 1)
-      )
-    );
+    request.trackId = readTrackId(*payload, 1);
     request.sourcePath = asString(getField(*payload, "source_path"));
     if (request.sourcePath.empty()) {
       request.sourcePath = asString(getField(*payload, "sourcePath"));
@@ -1069,6 +1652,15 @@ MsgValue handleRequest(const MsgValue::Object& request, TransportCore& transport
     request.fadeOutCurve = fadeCurveFromString(foc);
     request.type = asString(getField(*payload, "type"));
     request.sourceOffsetSeconds = asDouble(getField(*payload, "source_offset_seconds"), asDouble(getField(*payload, "sourceOffsetSeconds"), -1.0));
+    request.autoTrim = asBool(getField(*payload, "auto_trim"), asBool(getField(*payload, "autoTrim"), false));
+    request.autoTrimThresholdDb = asDouble(
+      getField(*payload, "auto_trim_threshold_db"),
+      asDouble(getField(*payload, "autoTrimThresholdDb"), request.autoTrimThresholdDb)
+    );
+    request.instrumentUid = asString(getField(*payload, "instrument_uid"));
+    if (request.instrumentUid.empty()) {
+      request.instrumentUid = asString(getField(*payload, "instrumentUid"));
+    }
 
     thestuu::native::ClipImportResult importResult;
     std::string error;
@@ -1086,20 +1678,443 @@ MsgValue handleRequest(const MsgValue::Object& request, TransportCore& transport
         {"startBars", MsgValue(importResult.startBars)},
         {"lengthBars", MsgValue(importResult.lengthBars)},
         {"sourcePath", MsgValue(importResult.sourcePath)},
+        {"type", MsgValue(importResult.type)},
+        {"clipId", MsgValue(static_cast<int64_t>(importResult.clipId))},
+        {"sourceHash", MsgValue(importResult.sourceHash)},
+        {"leadingSilenceSeconds", MsgValue(importResult.leadingSilenceSeconds)},
+        {"trailingSilenceSeconds", MsgValue(importResult.trailingSilenceSeconds)},
+        {"noteCount", MsgValue(importResult.noteCount)},
+        {"hasInstrument", MsgValue(importResult.hasInstrument)},
+      }
+    );
+  }
+
+  if (cmd == "cache:stats" || cmd == "cache:config") {
+    std::string error;
+    if (cmd == "cache:config") {
+      const double maxFileMb = payload ? asDouble(getField(*payload, "max_file_mb"), asDouble(getField(*payload, "maxFileMb"), -1.0)) : -1.0;
+      const double budgetMb = payload ? asDouble(getField(*payload, "budget_mb"), asDouble(getField(*payload, "budgetMb"), -1.0)) : -1.0;
+      const auto toBytes = [](double mb) { return mb < 0.0 ? int64_t{-1} : static_cast<int64_t>(mb * 1024.0 * 1024.0); };
+      if (!thestuu::native::configureSampleStore(toBytes(maxFileMb), toBytes(budgetMb), error)) {
+        return makeErrorResponse(id, error);
+      }
+    }
+    thestuu::native::SampleCacheStats stats;
+    if (!thestuu::native::getSampleCacheStats(stats, error)) {
+      return makeErrorResponse(id, error);
+    }
+    const uint64_t reads = stats.hits + stats.misses;
+    return makeResponse(
+      id,
+      MsgValue::Object{
+        {"entries", MsgValue(static_cast<int64_t>(stats.entries))},
+        {"residentEntries", MsgValue(static_cast<int64_t>(stats.residentEntries))},
+        {"residentBytes", MsgValue(stats.residentBytes)},
+        {"budgetBytes", MsgValue(stats.budgetBytes)},
+        {"maxFileBytes", MsgValue(stats.maxFileBytes)},
+        {"hits", MsgValue(static_cast<int64_t>(stats.hits))},
+        {"misses", MsgValue(static_cast<int64_t>(stats.misses))},
+        {"hitRate", MsgValue(reads > 0 ? static_cast<double>(stats.hits) / static_cast<double>(reads) : 0.0)},
+        {"evictions", MsgValue(static_cast<int64_t>(stats.evictions))},
+      }
+    );
+  }
+
+  if (cmd == "audio:loudness") {
+    if (payload == nullptr) {
+      return makeErrorResponse(id, "audio:loudness requires payload");
+    }
+    thestuu::native::LoudnessRequest request;
+    if (const auto* paths = std::get_if<MsgValue::Array>(&getOrNull(*payload, "paths").value)) {
+      for (const auto& entry : *paths) {
+        if (std::string path = asString(&entry); !path.empty()) {
+          request.paths.push_back(std::move(path));
+        }
+      }
+    }
+    const MsgValue* clipIdField = getField(*payload, "clip_ids");
+    if (clipIdField == nullptr) {
+      clipIdField = getField(*payload, "clipIds");
+    }
+    if (const auto* clipIds = clipIdField ? std::get_if<MsgValue::Array>(&clipIdField->value) : nullptr) {
+      for (const auto& entry : *clipIds) {
+        if (const int64_t clipId = asInt(&entry, 0); clipId > 0) {
+          request.clipIds.push_back(static_cast<uint64_t>(clipId));
+        }
+      }
+    }
+    request.renderEdit = asBool(getField(*payload, "render"), false);
+
+    std::vector<thestuu::native::LoudnessReport> reports;
+    std::string error;
+    if (!thestuu::native::analyseLoudness(request, reports, error)) {
+      return makeErrorResponse(id, error);
+    }
+    MsgValue::Array results;
+    results.reserve(reports.size());
+    for (const auto& report : reports) {
+      MsgValue::Object entry{
+        {"kind", MsgValue(report.kind)},
+        {"ok", MsgValue(report.ok)},
+        {"integratedLufs", MsgValue(report.integratedLufs)},
+        {"momentaryMaxLufs", MsgValue(report.momentaryMaxLufs)},
+        {"shortTermMaxLufs", MsgValue(report.shortTermMaxLufs)},
+        {"loudnessRangeLu", MsgValue(report.loudnessRangeLu)},
+        {"truePeakDbtp", MsgValue(report.truePeakDbtp)},
+        {"samplePeakDbfs", MsgValue(report.samplePeakDbfs)},
+        {"durationSeconds", MsgValue(report.durationSeconds)},
+      };
+      if (!report.path.empty()) {
+        entry.emplace("path", MsgValue(report.path));
+      }
+      if (report.clipId != 0) {
+        entry.emplace("clipId", MsgValue(static_cast<int64_t>(report.clipId)));
+      }
+      if (!report.error.empty()) {
+        entry.emplace("error", MsgValue(report.error));
+      }
+      results.emplace_back(std::move(entry));
+    }
+    return makeResponse(id, MsgValue::Object{{"results", MsgValue(std::move(results))}});
+  }
+
+  if (cmd == "clip:detect-transients") {
+    if (payload == nullptr) {
+      return makeErrorResponse(id, "clip:detect-transients requires payload");
+    }
+    const int64_t clipId = asInt(getField(*payload, "clip_id"), asInt(getField(*payload, "clipId"), 0));
+    if (clipId <= 0) {
+      return makeErrorResponse(id, "clip:detect-transients requires clip_id");
+    }
+    std::vector<thestuu::native::ClipTransient> transients;
+    std::string error;
+    if (!thestuu::native::detectClipTransients(
+          static_cast<uint64_t>(clipId),
+          asDouble(getField(*payload, "sensitivity"), 0.5),
+          asDouble(getField(*payload, "min_gap_ms"), 50.0),
+          transients,
+          error
+        )) {
+      return makeErrorResponse(id, error);
+    }
+    MsgValue::Array entries;
+    entries.reserve(transients.size());
+    for (const auto& transient : transients) {
+      entries.emplace_back(MsgValue::Object{
+        {"timelineSeconds", MsgValue(transient.timelineSeconds)},
+        {"sourceSeconds", MsgValue(transient.sourceSeconds)},
+        {"strength", MsgValue(transient.strength)},
+      });
+    }
+    return makeResponse(
+      id,
+      MsgValue::Object{
+        {"clipId", MsgValue(clipId)},
+        {"transients", MsgValue(std::move(entries))},
       }
     );
   }
 
+  if (cmd == "clip:slice-at") {
+    if (payload == nullptr) {
+      return makeErrorResponse(id, "clip:slice-at requires payload");
+    }
+    const int64_t clipId = asInt(getField(*payload, "clip_id"), asInt(getField(*payload, "clipId"), 0));
+    if (clipId <= 0) {
+      return makeErrorResponse(id, "clip:slice-at requires clip_id");
+    }
+    std::vector<double> times;
+    if (const auto* entries = std::get_if<MsgValue::Array>(&getOrNull(*payload, "times").value)) {
+      times.reserve(entries->size());
+      for (const auto& entry : *entries) {
+        times.push_back(asDouble(&entry, -1.0));
+      }
+    }
+    std::vector<uint64_t> clipIds;
+    std::string error;
+    if (!thestuu::native::sliceClipAt(static_cast<uint64_t>(clipId), times, clipIds, error)) {
+      return makeErrorResponse(id, error);
+    }
+    MsgValue::Array ids;
+    ids.reserve(clipIds.size());
+    for (const auto sliceId : clipIds) {
+      ids.emplace_back(static_cast<int64_t>(sliceId));
+    }
+    return makeResponse(id, MsgValue::Object{{"clipIds", MsgValue(std::move(ids))}});
+  }
+
+  if (cmd == "clip:set-warp-markers") {
+    if (payload == nullptr) {
+      return makeErrorResponse(id, "clip:set-warp-markers requires payload");
+    }
+    const int64_t clipId = asInt(getField(*payload, "clip_id"), asInt(getField(*payload, "clipId"), 0));
+    if (clipId <= 0) {
+      return makeErrorResponse(id, "clip:set-warp-markers requires clip_id");
+    }
+    std::vector<thestuu::native::ClipWarpMarker> markers;
+    if (const auto* entries = std::get_if<MsgValue::Array>(&getOrNull(*payload, "markers").value)) {
+      markers.reserve(entries->size());
+      for (const auto& entry : *entries) {
+        const auto* fields = std::get_if<MsgValue::Object>(&entry.value);
+        if (fields == nullptr) {
+          continue;
+        }
+        thestuu::native::ClipWarpMarker marker;
+        // sync:align returns its markers in camelCase; they can be passed on as they are.
+        marker.sourceSeconds = asDouble(getField(*fields, "source_seconds"), asDouble(getField(*fields, "sourceSeconds"), 0.0));
+        marker.warpSeconds = asDouble(getField(*fields, "warp_seconds"), asDouble(getField(*fields, "warpSeconds"), -1.0));
+        marker.timelineSeconds =
+          asDouble(getField(*fields, "timeline_seconds"), asDouble(getField(*fields, "timelineSeconds"), -1.0));
+        if (marker.warpSeconds < 0.0 && marker.timelineSeconds < 0.0) {
+          return makeErrorResponse(id, "warp marker requires warp_seconds or timeline_seconds");
+        }
+        markers.push_back(marker);
+      }
+    }
+    thestuu::native::ClipWarpStatus status;
+    std::string error;
+    if (!thestuu::native::setClipWarpMarkers(static_cast<uint64_t>(clipId), markers, status, error)) {
+      return makeErrorResponse(id, error);
+    }
+    return makeResponse(
+      id,
+      MsgValue::Object{
+        {"clipId", MsgValue(static_cast<int64_t>(status.clipId))},
+        {"markerCount", MsgValue(status.markerCount)},
+        {"rendered", MsgValue(status.rendered)},
+      }
+    );
+  }
+
+  if (cmd == "sync:align") {
+    if (payload == nullptr) {
+      return makeErrorResponse(id, "sync:align requires payload");
+    }
+    thestuu::native::SyncAlignRequest request;
+    request.guideClipId = static_cast<uint64_t>(asInt(getField(*payload, "guide_clip_id"), asInt(getField(*payload, "guideClipId"), 0)));
+    const MsgValue* targetIds = getField(*payload, "target_clip_ids");
+    if (targetIds == nullptr) {
+      targetIds = getField(*payload, "targetClipIds");
+    }
+    if (const auto* entries = targetIds ? std::get_if<MsgValue::Array>(&targetIds->value) : nullptr) {
+      for (const auto& entry : *entries) {
+        if (const int64_t clipId = asInt(&entry, 0); clipId > 0) {
+          request.targetClipIds.push_back(static_cast<uint64_t>(clipId));
+        }
+      }
+    }
+    request.maxShiftMs = asDouble(getField(*payload, "max_shift_ms"), request.maxShiftMs);
+    request.windowMs = asDouble(getField(*payload, "window_ms"), request.windowMs);
+    request.hopMs = asDouble(getField(*payload, "hop_ms"), request.hopMs);
+    request.minConfidence = asDouble(getField(*payload, "min_confidence"), request.minConfidence);
+    request.apply = asBool(getField(*payload, "apply"), false);
+
+    thestuu::native::SyncAlignResult result;
+    std::string error;
+    if (!thestuu::native::alignClips(request, result, error)) {
+      return makeErrorResponse(id, error);
+    }
+    MsgValue::Array targets;
+    targets.reserve(result.targets.size());
+    for (const auto& target : result.targets) {
+      MsgValue::Array markers;
+      markers.reserve(target.markers.size());
+      for (const auto& marker : target.markers) {
+        markers.emplace_back(MsgValue::Object{
+          {"sourceSeconds", MsgValue(marker.sourceSeconds)},
+          {"timelineSeconds", MsgValue(marker.timelineSeconds)},
+          {"offsetMs", MsgValue(marker.offsetMs)},
+          {"confidence", MsgValue(marker.confidence)},
+        });
+      }
+      MsgValue::Object entry{
+        {"clipId", MsgValue(static_cast<int64_t>(target.clipId))},
+        {"ok", MsgValue(target.ok)},
+        {"offsetMs", MsgValue(target.offsetMs)},
+        {"confidence", MsgValue(target.confidence)},
+        {"applied", MsgValue(target.applied)},
+        {"warpMarkers", MsgValue(std::move(markers))},
+      };
+      if (!target.error.empty()) {
+        entry.emplace("error", MsgValue(target.error));
+      }
+      targets.emplace_back(std::move(entry));
+    }
+    return makeResponse(
+      id,
+      MsgValue::Object{
+        {"guideClipId", MsgValue(static_cast<int64_t>(result.guideClipId))},
+        {"targets", MsgValue(std::move(targets))},
+        {"elapsedMs", MsgValue(result.elapsedMs)},
+      }
+    );
+  }
+
+  if (cmd == "clip:source-pool") {
+    thestuu::native::SourcePoolStats stats;
+    std::string error;
+    if (!thestuu::native::getSourcePoolStats(stats, error)) {
+      return makeErrorResponse(id, error);
+    }
+    return makeResponse(
+      id,
+      MsgValue::Object{
+        {"sources", MsgValue(static_cast<int64_t>(stats.sources))},
+        {"clips", MsgValue(static_cast<int64_t>(stats.clips))},
+        {"storedSources", MsgValue(static_cast<int64_t>(stats.storedSources))},
+        {"mappedSources", MsgValue(static_cast<int64_t>(stats.mappedSources))},
+        {"deduplicatedClips", MsgValue(stats.deduplicatedClips)},
+      }
+    );
+  }
+
+  if (cmd == "pattern:set") {
+    if (payload == nullptr) {
+      return makeErrorResponse(id, "pattern:set requires payload");
+    }
+    // Accept either { track_id, pattern: {...} } or the pattern fields inline.
+    const MsgValue::Object* pattern = asObject(getField(*payload, "pattern"));
+    if (pattern == nullptr) {
+      pattern = payload;
+    }
+
+    thestuu::native::StepPatternRequest request;
+    request.trackId = readTrackId(*payload, 1);
+    request.patternId = asString(getField(*pattern, "id"), asString(getField(*payload, "pattern_id")));
+    request.lengthSteps = static_cast<int32_t>(asInt(getField(*pattern, "length"), 16));
+    request.stepBeats = asDouble(getField(*payload, "step_beats"), asDouble(getField(*payload, "stepBeats"), 0.25));
+    request.swing = asDouble(getField(*pattern, "swing"), 0.0);
+    request.gate = asDouble(getField(*payload, "gate"), 0.5);
+    request.instrumentUid = asString(getField(*payload, "instrument_uid"));
+    if (request.instrumentUid.empty()) {
+      request.instrumentUid = asString(getField(*payload, "instrumentUid"));
+    }
+
+    const MsgValue::Object* laneNotes = asObject(getField(*payload, "lane_notes"));
+    if (laneNotes == nullptr) {
+      laneNotes = asObject(getField(*payload, "laneNotes"));
+    }
+    if (const auto* steps = std::get_if<MsgValue::Array>(&getOrNull(*pattern, "steps").value)) {
+      request.steps.reserve(steps->size());
+      for (const auto& entry : *steps) {
+        const MsgValue::Object* step = asObject(&entry);
+        if (step == nullptr) {
+          continue;
+        }
+        const std::string lane = asString(getField(*step, "lane"));
+        int64_t note = laneNotes != nullptr ? asInt(getField(*laneNotes, lane), -1) : -1;
+        if (note < 0) {
+          note = asInt(getField(*step, "note"), defaultDrumLaneNote(lane));
+        }
+        thestuu::native::StepPatternStep parsed;
+        parsed.stepIndex = static_cast<int32_t>(asInt(getField(*step, "index"), 0));
+        parsed.note = static_cast<int32_t>(note);
+        parsed.velocity = asDouble(getField(*step, "velocity"), 1.0);
+        request.steps.push_back(parsed);
+      }
+    }
+    if (const auto* ranges = std::get_if<MsgValue::Array>(&getOrNull(*payload, "ranges").value)) {
+      for (const auto& entry : *ranges) {
+        if (const MsgValue::Object* range = asObject(&entry)) {
+          request.ranges.push_back({
+            asDouble(getField(*range, "start"), 0.0),
+            asDouble(getField(*range, "length"), 0.0),
+          });
+        }
+      }
+    }
+
+    thestuu::native::StepPatternResult result;
+    std::string error;
+    if (!thestuu::native::setStepPattern(request, result, error)) {
+      return makeErrorResponse(id, error);
+    }
+    return makeResponse(id, MsgValue::Object{
+      {"trackId", MsgValue(result.trackId)},
+      {"patternId", MsgValue(result.patternId)},
+      {"clipCount", MsgValue(result.clipCount)},
+      {"noteCount", MsgValue(result.noteCount)},
+      {"hasInstrument", MsgValue(result.hasInstrument)},
+    });
+  }
+
+  if (cmd == "track:sync") {
+    if (payload == nullptr) {
+      return makeErrorResponse(id, "track:sync requires payload");
+    }
+    const auto* entries = std::get_if<MsgValue::Array>(&getOrNull(*payload, "tracks").value);
+    if (entries == nullptr) {
+      return makeErrorResponse(id, "track:sync requires tracks");
+    }
+    std::vector<thestuu::native::TrackMixUpdate> updates;
+    updates.reserve(entries->size());
+    for (const auto& entry : *entries) {
+      const auto* fields = std::get_if<MsgValue::Object>(&entry.value);
+      if (fields == nullptr) {
+        continue;
+      }
+      thestuu::native::TrackMixUpdate update;
+      update.trackId = readTrackId(*fields, 0);
+      if (const auto* value = getField(*fields, "mute")) {
+        update.mute = asBool(value, false);
+      }
+      if (const auto* value = getField(*fields, "solo")) {
+        update.solo = asBool(value, false);
+      }
+      if (const auto* value = getField(*fields, "volume")) {
+        update.volume = asDouble(value, 1.0);
+      }
+      if (const auto* value = getField(*fields, "pan")) {
+        update.pan = asDouble(value, 0.0);
+      }
+      const auto* armed = getField(*fields, "record_armed");
+      if (armed == nullptr) {
+        armed = getField(*fields, "recordArmed");
+      }
+      if (armed != nullptr) {
+        update.recordArmed = asBool(armed, false);
+      }
+      updates.push_back(update);
+    }
+    thestuu::native::TrackMixSyncResult result;
+    std::string error;
+    if (!thestuu::native::syncTrackMixer(updates, result, error)) {
+      return makeErrorResponse(id, error);
+    }
+    MsgValue::Array missing;
+    for (const int32_t trackId : result.missingTrackIds) {
+      missing.push_back(MsgValue(static_cast<int64_t>(trackId)));
+    }
+    return makeResponse(
+      id,
+      MsgValue::Object{
+        {"applied", MsgValue(static_cast<int64_t>(result.applied))},
+        {"missingTrackIds", MsgValue(std::move(missing))},
+      }
+    );
+  }
+  if (cmd == "track:list") {
+    std::vector<thestuu::native::TrackListEntry> tracks;
+    std::string error;
+    if (!thestuu::native::listTracks(tracks, error)) {
+      return makeErrorResponse(id, error);
+    }
+    MsgValue::Array arr;
+    arr.reserve(tracks.size());
+    for (const auto& track : tracks) {
+      arr.push_back(MsgValue(MsgValue::Object{
+        {"trackId", MsgValue(static_cast<int64_t>(track.trackId))},
+        {"trackUid", MsgValue(track.trackUid)},
+        {"name", MsgValue(track.name)},
+      }));
+    }
+    return makeResponse(id, MsgValue::Object{{"tracks", MsgValue(std::move(arr))}});
+  }
   if (cmd == "track:set-mute") {
     if (payload == nullptr) {
       return makeErrorResponse(id, "track:set-mute requires payload");
     }
-    const int32_t trackId = static_cast<int32_t>(
-      asInt(
-        getField(*payload, "track_id"),
-        asInt(getField(*payload, "trackId"), 1)
-      )
-    );
+    const int32_t trackId = readTrackId(*payload, 1);
     const bool mute = asBool(getField(*payload, "mute"), false);
     std::string error;
     if (!thestuu::native::setTrackMute(trackId, mute, error)) {
@@ -1115,12 +2130,7 @@ MsgValue handleRequest(const MsgValue::Object& request, TransportCore& transport
     if (payload == nullptr) {
       return makeErrorResponse(id, "track:set-solo requires payload");
     }
-    const int32_t trackId = static_cast<int32_t>(
-      asInt(
-        getField(*payload, "track_id"),
-        asInt(getField(*payload, "trackId"), 1)
-      )
-    );
+    const int32_t trackId = readTrackId(*payload, 1);
     const bool solo = asBool(getField(*payload, "solo"), false);
     std::string error;
     if (!thestuu::native::setTrackSolo(trackId, solo, error)) {
@@ -1136,12 +2146,7 @@ MsgValue handleRequest(const MsgValue::Object& request, TransportCore& transport
     if (payload == nullptr) {
       return makeErrorResponse(id, "track:set-volume requires payload");
     }
-    const int32_t trackId = static_cast<int32_t>(
-      asInt(
-        getField(*payload, "track_id"),
-        asInt(getField(*payload, "trackId"), 1)
-      )
-    );
+    const int32_t trackId = readTrackId(*payload, 1);
     const double volume = asDouble(getField(*payload, "volume"), 0.85);
     std::string error;
     if (!thestuu::native::setTrackVolume(trackId, volume, error)) {
@@ -1157,12 +2162,7 @@ MsgValue handleRequest(const MsgValue::Object& request, TransportCore& transport
     if (payload == nullptr) {
       return makeErrorResponse(id, "track:set-pan requires payload");
     }
-    const int32_t trackId = static_cast<int32_t>(
-      asInt(
-        getField(*payload, "track_id"),
-        asInt(getField(*payload, "trackId"), 1)
-      )
-    );
+    const int32_t trackId = readTrackId(*payload, 1);
     const double pan = asDouble(getField(*payload, "pan"), 0.0);
     std::string error;
     if (!thestuu::native::setTrackPan(trackId, pan, error)) {
@@ -1178,12 +2178,7 @@ MsgValue handleRequest(const MsgValue::Object& request, TransportCore& transport
     if (payload == nullptr) {
       return makeErrorResponse(id, "track:set-record-arm requires payload");
     }
-    const int32_t trackId = static_cast<int32_t>(
-      asInt(
-        getField(*payload, "track_id"),
-        asInt(getField(*payload, "trackId"), 1)
-      )
-    );
+    const int32_t trackId = readTrackId(*payload, 1);
     const bool armed = asBool(getField(*payload, "record_armed"), asBool(getField(*payload, "recordArmed"), false));
     std::string error;
     if (!thestuu::native::setTrackRecordArm(trackId, armed, error)) {
@@ -1236,6 +2231,19 @@ MsgValue handleRequest(const MsgValue::Object& request, TransportCore& transport
   return makeErrorResponse(id, "unknown cmd: " + cmd);
 }
 
+MsgValue handleRequest(const MsgValue::Object& request, TransportCore& transport) {
+  MsgValue response = dispatchRequest(request, transport);
+  // Counted once the request has run: polling queries, unknown commands and failed requests change
+  // nothing, so a client repeating them cannot keep the engine out of idle power mode.
+  const std::string cmd = asString(getField(request, "cmd"));
+  const auto* result = asObject(&response);
+  if (g_useTracktionTransport && result != nullptr && asBool(getField(*result, "ok"))
+      && std::none_of(kPassiveCommands.begin(), kPassiveCommands.end(), [&](const char* passive) { return cmd == passive; })) {
+    thestuu::native::notePowerActivity();
+  }
+  return response;
+}
+
 bool processIncomingBuffer(std::vector<uint8_t>& buffer, int clientFd, TransportCore& transport) {
   while (buffer.size() >= kFrameHeaderBytes) {
     const uint32_t frameSize =
@@ -1378,6 +2386,10 @@ int resolveBufferSize() {
 }  // namespace
 
 int main(int argc, char** argv) {
+  if (argc >= 4 && std::string(argv[1]) == "--plugin-host") {
+    return thestuu::native::runPluginHost(argv[2], argv[3]);
+  }
+
   std::signal(SIGINT, signalHandler);
   std::signal(SIGTERM, signalHandler);
   std::signal(SIGPIPE, SIG_IGN);
@@ -1386,6 +2398,7 @@ int main(int argc, char** argv) {
   const thestuu::native::BackendConfig backendConfig{
     resolveSampleRate(),
     resolveBufferSize(),
+    thestuu::native::threadSchedulingConfigFromEnvironment(),
   };
   thestuu::native::BackendRuntimeInfo backendInfo{};
   std::string backendError;
@@ -1411,7 +2424,8 @@ int main(int argc, char** argv) {
   std::cout << "[thestuu-native] listening on " << socketPath << "\n";
 
   // Socket I/O on a background thread so the main thread can run the JUCE message loop (required on macOS).
-  std::thread socketThread([&transport, serverFd]() {
+  std::thread socketThread([&transport, serverFd, ipcCpus = backendConfig.scheduling.ipcCpus]() {
+    thestuu::native::applyCurrentThreadScheduling("ipc", "other", 0, ipcCpus);
     while (g_running) {
       const int clientFd = accept(serverFd, nullptr, nullptr);
       if (clientFd < 0) {
@@ -1436,9 +2450,10 @@ int main(int argc, char** argv) {
         FD_ZERO(&readSet);
         FD_SET(clientFd, &readSet);
 
+        const bool idle = g_useTracktionTransport && thestuu::native::isIdlePowerMode();
         timeval timeout{};
         timeout.tv_sec = 0;
-        timeout.tv_usec = 20000;
+        timeout.tv_usec = idle ? kIdleSelectTimeoutUs : 20000;
 
         const int ready = select(clientFd + 1, &readSet, nullptr, nullptr, &timeout);
         if (ready < 0) {
@@ -1460,12 +2475,31 @@ int main(int argc, char** argv) {
           }
         }
 
+        bool eventsSent = true;
+        thestuu::native::PluginLoadEvent loadEvent;
+        while (g_useTracktionTransport && thestuu::native::popPluginLoadEvent(loadEvent)) {
+          if (!sendFrame(clientFd, makePluginLoadEvent(loadEvent))) {
+            eventsSent = false;
+            break;
+          }
+        }
+        thestuu::native::SandboxEvent sandboxEvent;
+        while (eventsSent && g_useTracktionTransport && thestuu::native::popSandboxEvent(sandboxEvent)) {
+          if (!sendFrame(clientFd, makeSandboxEvent(sandboxEvent))) {
+            eventsSent = false;
+            break;
+          }
+        }
+        if (!eventsSent) {
+          break;
+        }
+
         const auto now = std::chrono::steady_clock::now();
         if (now >= nextTick) {
           if (!sendFrame(clientFd, makeTickEvent(transport))) {
             break;
           }
-          nextTick = now + std::chrono::milliseconds(kTickMs);
+          nextTick = now + std::chrono::milliseconds(idle ? kIdleTickMs : kTickMs);
         }
       }
 
@@ -0,0 +1,427 @@
+#include "plugin_sandbox.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <cstdio>
+#include <cstring>
+#include <new>
+#include <thread>
+
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#if defined(__linux__)
+#include <linux/futex.h>
+#include <sys/prctl.h>
+#include <sys/syscall.h>
+#endif
+
+namespace thestuu::native::sandbox {
+
+namespace {
+
+constexpr uint32_t kRingMask = kRingFrames - 1;
+constexpr uint32_t kMidiMask = kMidiRingEvents - 1;
+static_assert((kRingFrames & kRingMask) == 0, "kRingFrames must be a power of two");
+static_assert((kMidiRingEvents & kMidiMask) == 0, "kMidiRingEvents must be a power of two");
+static_assert(std::atomic<double>::is_always_lock_free, "shared-memory atomics must be lock-free");
+
+void futexWake(std::atomic<uint32_t>& word) {
+#if defined(__linux__)
+  syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+#else
+  (void)word;  // waiters poll on other platforms
+#endif
+}
+
+void futexWait(std::atomic<uint32_t>& word, uint32_t expected, int timeoutMs) {
+#if defined(__linux__)
+  timespec timeout{timeoutMs / 1000, static_cast<long>(timeoutMs % 1000) * 1000000L};
+  syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAIT, expected, &timeout, nullptr, 0);
+#else
+  if (word.load(std::memory_order_acquire) == expected) {
+    std::this_thread::sleep_for(std::chrono::microseconds(250));
+  }
+#endif
+}
+
+SharedBlock* mapShared(int fd) {
+  void* memory = mmap(nullptr, sizeof(SharedBlock), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  return memory == MAP_FAILED ? nullptr : static_cast<SharedBlock*>(memory);
+}
+
+std::string makeShmName() {
+  static std::atomic<int> counter{0};
+  return "/thestuu-sbx-" + std::to_string(static_cast<long>(getpid())) + "-" + std::to_string(counter.fetch_add(1));
+}
+
+/** Child side: silences the output ring over [from, to), at most one ring's worth. */
+void clearOutput(SharedBlock& shared, uint64_t from, uint64_t to) {
+  for (uint64_t frame = from; frame < std::min<uint64_t>(to, from + kRingFrames); ++frame) {
+    for (int ch = 0; ch < kMaxChannels; ++ch) {
+      shared.output[ch][frame & kRingMask] = 0.0F;
+    }
+  }
+}
+
+/** Child side, after (re)preparing: skip whatever input is pending and put the output timeline one
+ *  block ahead of the input again, which is the latency the host reports. The frames skipped over
+ *  still hold a previous lap (or a previous child's output) and are silenced. */
+void resyncChild(SharedBlock& shared, int blockSize) {
+  const uint64_t inWrite = shared.inWrite.load(std::memory_order_acquire);
+  const uint64_t oldOutWrite = shared.outWrite.load(std::memory_order_relaxed);
+  const uint64_t outWrite = inWrite + static_cast<uint64_t>(blockSize);
+  clearOutput(shared, oldOutWrite, outWrite);
+  shared.inRead.store(inWrite, std::memory_order_release);
+  shared.outWrite.store(outWrite, std::memory_order_release);
+  shared.midiRead.store(shared.midiWrite.load(std::memory_order_acquire), std::memory_order_release);
+}
+
+/** Child side of one processing block: renders whatever input is pending, up to blockSize frames,
+ *  so host blocks shorter than blockSize are answered within the reported latency. Returns false
+ *  when no input is pending. */
+bool processOneBlock(
+  SharedBlock& shared,
+  int blockSize,
+  juce::AudioPluginInstance& instance,
+  juce::AudioBuffer<float>& work,
+  juce::MidiBuffer& midi
+) {
+  const uint64_t inWrite = shared.inWrite.load(std::memory_order_acquire);
+  uint64_t inRead = shared.inRead.load(std::memory_order_relaxed);
+  uint64_t outWrite = shared.outWrite.load(std::memory_order_relaxed);
+  if (inWrite == inRead) {
+    return false;
+  }
+
+  // Fell behind by more than half a ring (e.g. a long CPU spike): drop the backlog and keep the
+  // output timeline aligned to the input so the host's fixed latency stays valid.
+  const uint64_t backlog = inWrite - inRead;
+  if (backlog > kRingFrames / 2) {
+    const uint64_t skip = backlog - static_cast<uint64_t>(blockSize);
+    clearOutput(shared, outWrite, outWrite + skip);
+    inRead += skip;
+    outWrite += skip;
+  }
+  const int frames = static_cast<int>(std::min<uint64_t>(inWrite - inRead, static_cast<uint64_t>(blockSize)));
+
+  // Shrinking within the allocation made by prepare does not reallocate.
+  work.setSize(work.getNumChannels(), frames, false, false, true);
+  work.clear();
+  const int channels = std::min(work.getNumChannels(), kMaxChannels);
+  for (int ch = 0; ch < channels; ++ch) {
+    float* dest = work.getWritePointer(ch);
+    for (int n = 0; n < frames; ++n) {
+      dest[n] = shared.input[ch][(inRead + static_cast<uint64_t>(n)) & kRingMask];
+    }
+  }
+
+  midi.clear();
+  const uint64_t midiWrite = shared.midiWrite.load(std::memory_order_acquire);
+  uint64_t midiRead = shared.midiRead.load(std::memory_order_relaxed);
+  const uint64_t blockEnd = inRead + static_cast<uint64_t>(frames);
+  while (midiRead < midiWrite) {
+    const auto& event = shared.midi[midiRead & kMidiMask];
+    if (event.frame >= blockEnd) {
+      break;
+    }
+    const int offset = event.frame > inRead ? static_cast<int>(event.frame - inRead) : 0;
+    midi.addEvent(event.data, event.size, offset);
+    ++midiRead;
+  }
+  shared.midiRead.store(midiRead, std::memory_order_release);
+
+  instance.processBlock(work, midi);
+
+  for (int ch = 0; ch < kMaxChannels; ++ch) {
+    const float* src = work.getReadPointer(std::min(ch, work.getNumChannels() - 1));
+    for (int n = 0; n < frames; ++n) {
+      shared.output[ch][(outWrite + static_cast<uint64_t>(n)) & kRingMask] = src[n];
+    }
+  }
+  shared.inRead.store(inRead + static_cast<uint64_t>(frames), std::memory_order_release);
+  shared.outWrite.store(outWrite + static_cast<uint64_t>(frames), std::memory_order_release);
+  shared.outputSeq.fetch_add(1, std::memory_order_release);
+  return true;
+}
+
+}  // namespace
+
+SandboxBridge::~SandboxBridge() {
+  stop();
+}
+
+bool SandboxBridge::start(const juce::PluginDescription& description, double sampleRate, int blockSize, std::string& error) {
+  stop();
+  if (blockSize <= 0 || blockSize > static_cast<int>(kRingFrames / 4)) {
+    error = "sandbox: unsupported block size";
+    return false;
+  }
+  bypassed.store(false, std::memory_order_relaxed);
+
+  shmName = makeShmName();
+  const int fd = shm_open(shmName.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+  if (fd < 0) {
+    error = std::string("sandbox: shm_open failed: ") + std::strerror(errno);
+    return false;
+  }
+  if (ftruncate(fd, static_cast<off_t>(sizeof(SharedBlock))) != 0 || (shared = mapShared(fd)) == nullptr) {
+    error = std::string("sandbox: shared memory setup failed: ") + std::strerror(errno);
+    close(fd);
+    shm_unlink(shmName.c_str());
+    shared = nullptr;
+    return false;
+  }
+  close(fd);
+
+  // ftruncate zero-fills, so the rings start silent; the atomics need proper construction.
+  new (shared) SharedBlock();
+  shared->sampleRate.store(sampleRate, std::memory_order_relaxed);
+  shared->blockSize.store(blockSize, std::memory_order_relaxed);
+  // One block of silence ahead of the child: the host reads block N-1 while the child renders N.
+  latencySamples.store(blockSize, std::memory_order_relaxed);
+
+  descriptionFile = juce::File::createTempFile(".stuu-sandbox.xml");
+  if (auto xml = description.createXml(); xml == nullptr || !xml->writeTo(descriptionFile)) {
+    error = "sandbox: cannot write plugin description";
+    stop();
+    return false;
+  }
+  if (!launchChild(error)) {
+    stop();
+    return false;
+  }
+  std::fprintf(stderr, "[thestuu-native] sandbox: hosting %s in child (%s)\n", description.name.toRawUTF8(), shmName.c_str());
+  return true;
+}
+
+bool SandboxBridge::launchChild(std::string& error) {
+  child = std::make_unique<juce::ChildProcess>();
+  const auto executable = juce::File::getSpecialLocation(juce::File::currentExecutableFile).getFullPathName();
+  juce::StringArray args{executable, "--plugin-host", juce::String(shmName), descriptionFile.getFullPathName()};
+  if (!child->start(args, 0)) {
+    child.reset();
+    error = "sandbox: failed to launch plugin host process";
+    return false;
+  }
+  error.clear();
+  return true;
+}
+
+bool SandboxBridge::prepare(double sampleRate, int blockSize, std::string& error) {
+  if (shared == nullptr) {
+    error = "sandbox: bridge is not running";
+    return false;
+  }
+  if (blockSize <= 0 || blockSize > static_cast<int>(kRingFrames / 4)) {
+    error = "sandbox: unsupported block size";
+    return false;
+  }
+  if (shared->sampleRate.load(std::memory_order_relaxed) == sampleRate
+      && shared->blockSize.load(std::memory_order_relaxed) == blockSize) {
+    error.clear();
+    return true;
+  }
+  shared->sampleRate.store(sampleRate, std::memory_order_relaxed);
+  shared->blockSize.store(blockSize, std::memory_order_relaxed);
+  latencySamples.store(blockSize, std::memory_order_relaxed);
+  shared->prepareSeq.fetch_add(1, std::memory_order_release);
+  shared->inputSeq.fetch_add(1, std::memory_order_release);
+  futexWake(shared->inputSeq);
+  error.clear();
+  return true;
+}
+
+bool SandboxBridge::restartChild(std::string& error) {
+  if (shared == nullptr) {
+    error = "sandbox: bridge is not running";
+    return false;
+  }
+  if (child != nullptr && child->isRunning()) {
+    error.clear();
+    return true;
+  }
+  shared->childReady.store(0, std::memory_order_release);
+  return launchChild(error);
+}
+
+void SandboxBridge::stop() {
+  if (shared != nullptr) {
+    shared->shutdown.store(1, std::memory_order_release);
+    shared->inputSeq.fetch_add(1, std::memory_order_release);
+    futexWake(shared->inputSeq);
+  }
+  if (child != nullptr) {
+    if (!child->waitForProcessToFinish(1000)) {
+      child->kill();
+    }
+    child.reset();
+  }
+  if (shared != nullptr) {
+    shared->~SharedBlock();
+    munmap(shared, sizeof(SharedBlock));
+    shared = nullptr;
+  }
+  if (!shmName.empty()) {
+    shm_unlink(shmName.c_str());
+    shmName.clear();
+  }
+  if (descriptionFile != juce::File()) {
+    descriptionFile.deleteFile();
+    descriptionFile = juce::File();
+  }
+}
+
+bool SandboxBridge::isChildRunning() const {
+  return child != nullptr && child->isRunning();
+}
+
+void SandboxBridge::process(juce::AudioBuffer<float>& buffer, int startSample, int numSamples, const juce::MidiBuffer& midi) {
+  if (shared == nullptr || numSamples <= 0) {
+    buffer.clear(startSample, numSamples);
+    return;
+  }
+
+  const uint64_t inWrite = shared->inWrite.load(std::memory_order_relaxed);
+  const int numChannels = buffer.getNumChannels();
+  for (int ch = 0; ch < kMaxChannels; ++ch) {
+    const float* src = numChannels > 0 ? buffer.getReadPointer(std::min(ch, numChannels - 1), startSample) : nullptr;
+    for (int n = 0; n < numSamples; ++n) {
+      shared->input[ch][(inWrite + static_cast<uint64_t>(n)) & kRingMask] = src != nullptr ? src[n] : 0.0F;
+    }
+  }
+
+  uint64_t midiWrite = shared->midiWrite.load(std::memory_order_relaxed);
+  const uint64_t midiRead = shared->midiRead.load(std::memory_order_acquire);
+  for (const auto metadata : midi) {
+    if (metadata.numBytes > 3 || midiWrite - midiRead >= kMidiRingEvents) {
+      continue;  // sysex is not bridged; a full ring drops events rather than blocking
+    }
+    auto& event = shared->midi[midiWrite & kMidiMask];
+    event.frame = inWrite + static_cast<uint64_t>(std::max(0, metadata.samplePosition));
+    event.size = static_cast<uint8_t>(metadata.numBytes);
+    std::memcpy(event.data, metadata.data, static_cast<size_t>(metadata.numBytes));
+    ++midiWrite;
+  }
+  shared->midiWrite.store(midiWrite, std::memory_order_release);
+  shared->inWrite.store(inWrite + static_cast<uint64_t>(numSamples), std::memory_order_release);
+  shared->inputSeq.fetch_add(1, std::memory_order_release);
+  futexWake(shared->inputSeq);
+
+  // Output timeline = input timeline + latency; read what the child has finished, silence the rest.
+  const uint64_t readPos = shared->outRead.load(std::memory_order_relaxed);
+  if (bypassed.load(std::memory_order_relaxed)) {
+    // The input ring still holds the last latency's worth of frames: pass them through in place of
+    // the plugin, so delay compensation stays valid.
+    const auto latency = static_cast<uint64_t>(latencySamples.load(std::memory_order_relaxed));
+    for (int ch = 0; ch < numChannels; ++ch) {
+      float* dest = buffer.getWritePointer(ch, startSample);
+      const int srcCh = std::min(ch, kMaxChannels - 1);
+      for (int n = 0; n < numSamples; ++n) {
+        const uint64_t frame = readPos + static_cast<uint64_t>(n);
+        dest[n] = frame >= latency ? shared->input[srcCh][(frame - latency) & kRingMask] : 0.0F;
+      }
+    }
+    shared->outRead.store(readPos + static_cast<uint64_t>(numSamples), std::memory_order_release);
+    return;
+  }
+  const uint64_t ready = shared->outWrite.load(std::memory_order_acquire);
+  const int available = ready > readPos ? static_cast<int>(std::min<uint64_t>(ready - readPos, static_cast<uint64_t>(numSamples))) : 0;
+  for (int ch = 0; ch < numChannels; ++ch) {
+    float* dest = buffer.getWritePointer(ch, startSample);
+    const int srcCh = std::min(ch, kMaxChannels - 1);
+    for (int n = 0; n < available; ++n) {
+      dest[n] = shared->output[srcCh][(readPos + static_cast<uint64_t>(n)) & kRingMask];
+    }
+    if (available < numSamples) {
+      juce::FloatVectorOperations::clear(dest + available, numSamples - available);
+    }
+  }
+  if (available < numSamples) {
+    underrunFrames.fetch_add(static_cast<uint64_t>(numSamples - available), std::memory_order_relaxed);
+  }
+  shared->outRead.store(readPos + static_cast<uint64_t>(numSamples), std::memory_order_release);
+}
+
+int runPluginHostProcess(const std::string& shmName, const std::string& descriptionPath) {
+#if defined(__linux__)
+  prctl(PR_SET_PDEATHSIG, SIGKILL);
+#endif
+  const pid_t parent = getppid();
+
+  const int fd = shm_open(shmName.c_str(), O_RDWR, 0600);
+  if (fd < 0) {
+    std::fprintf(stderr, "[thestuu-plugin-host] cannot open %s\n", shmName.c_str());
+    return 2;
+  }
+  SharedBlock* shared = mapShared(fd);
+  close(fd);
+  if (shared == nullptr) {
+    return 2;
+  }
+
+  juce::ScopedJuceInitialiser_GUI juceInit;
+  juce::PluginDescription description;
+  const auto xml = juce::parseXML(juce::File(descriptionPath));
+  if (xml == nullptr || !description.loadFromXml(*xml)) {
+    std::fprintf(stderr, "[thestuu-plugin-host] invalid plugin description %s\n", descriptionPath.c_str());
+    munmap(shared, sizeof(SharedBlock));
+    return 2;
+  }
+
+  juce::AudioPluginFormatManager formats;
+  formats.addDefaultFormats();
+  juce::String createError;
+  uint32_t preparedSeq = shared->prepareSeq.load(std::memory_order_acquire);
+  double sampleRate = shared->sampleRate.load(std::memory_order_relaxed);
+  int blockSize = shared->blockSize.load(std::memory_order_relaxed);
+  auto instance = formats.createPluginInstance(description, sampleRate, blockSize, createError);
+  if (instance == nullptr) {
+    std::fprintf(stderr, "[thestuu-plugin-host] %s: %s\n", description.name.toRawUTF8(), createError.toRawUTF8());
+    munmap(shared, sizeof(SharedBlock));
+    return 3;
+  }
+  instance->enableAllBuses();
+  instance->prepareToPlay(sampleRate, blockSize);
+  const int numChannels = std::max({kMaxChannels, instance->getTotalNumInputChannels(), instance->getTotalNumOutputChannels()});
+  juce::AudioBuffer<float> work(numChannels, blockSize);
+  juce::MidiBuffer midi;
+  midi.ensureSize(kMidiRingEvents * (sizeof(int32_t) + sizeof(uint16_t) + 3));
+  resyncChild(*shared, blockSize);
+  shared->childReady.store(1, std::memory_order_release);
+
+  std::thread audioThread([&]() {
+    while (shared->shutdown.load(std::memory_order_acquire) == 0) {
+      const uint32_t seq = shared->inputSeq.load(std::memory_order_acquire);
+      if (const uint32_t requested = shared->prepareSeq.load(std::memory_order_acquire); requested != preparedSeq) {
+        preparedSeq = requested;
+        sampleRate = shared->sampleRate.load(std::memory_order_relaxed);
+        blockSize = shared->blockSize.load(std::memory_order_relaxed);
+        instance->releaseResources();
+        instance->prepareToPlay(sampleRate, blockSize);
+        work.setSize(numChannels, blockSize);
+        resyncChild(*shared, blockSize);
+      }
+      if (!processOneBlock(*shared, blockSize, *instance, work, midi)) {
+        futexWait(shared->inputSeq, seq, 100);
+      }
+    }
+  });
+
+  // The plugin may need its message thread (timers, async updates); run it until told to stop.
+  while (shared->shutdown.load(std::memory_order_acquire) == 0 && getppid() == parent) {
+    juce::MessageManager::getInstance()->runDispatchLoopUntil(50);
+  }
+  shared->shutdown.store(1, std::memory_order_release);
+  futexWake(shared->inputSeq);
+  audioThread.join();
+  instance->releaseResources();
+  instance.reset();
+  munmap(shared, sizeof(SharedBlock));
+  return 0;
+}
+
+}  // namespace thestuu::native::sandbox
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+#include <juce_audio_processors/juce_audio_processors.h>
+
+namespace thestuu::native::sandbox {
+
+constexpr int kMaxChannels = 2;
+/** Frames per ring; must be a power of two and hold several blocks of the largest buffer size (8192). */
+constexpr uint32_t kRingFrames = 1u << 15;
+constexpr uint32_t kMidiRingEvents = 1024;
+
+struct MidiEvent {
+  /** Absolute frame position in the input ring's timeline. */
+  uint64_t frame = 0;
+  uint8_t size = 0;
+  uint8_t data[3] = {0, 0, 0};
+};
+
+/** Single-producer/single-consumer rings shared between the host audio thread and one plugin
+ *  child process. Positions only grow; the ring index is position & (size - 1). */
+struct SharedBlock {
+  std::atomic<uint64_t> inWrite{0};
+  std::atomic<uint64_t> inRead{0};
+  std::atomic<uint64_t> outWrite{0};
+  std::atomic<uint64_t> outRead{0};
+  std::atomic<uint64_t> midiWrite{0};
+  std::atomic<uint64_t> midiRead{0};
+  /** Futex words: bumped by the host when input is available, by the child when a block is done. */
+  std::atomic<uint32_t> inputSeq{0};
+  std::atomic<uint32_t> outputSeq{0};
+  std::atomic<uint32_t> shutdown{0};
+  std::atomic<uint32_t> childReady{0};
+  /** Format requested by the host; bumping prepareSeq makes the child prepare the plugin again. */
+  std::atomic<double> sampleRate{48000.0};
+  std::atomic<int32_t> blockSize{256};
+  std::atomic<uint32_t> prepareSeq{0};
+  float input[kMaxChannels][kRingFrames];
+  float output[kMaxChannels][kRingFrames];
+  MidiEvent midi[kMidiRingEvents];
+};
+
+/** Host side of one sandboxed plugin: owns the shared memory and the child process.
+ *  process() is called on the audio thread, never blocks, and returns audio exactly one
+ *  block late; if the child is late or gone, the missing frames are silent. */
+class SandboxBridge {
+ public:
+  SandboxBridge() = default;
+  ~SandboxBridge();
+
+  /** Message thread. Creates the shared memory and launches the child; it lives until stop(). */
+  bool start(const juce::PluginDescription& description, double sampleRate, int blockSize, std::string& error);
+  void stop();
+  bool isStarted() const noexcept {
+    return shared != nullptr;
+  }
+  /** Message thread. Asks the running child to prepare the plugin for a new format. Does not wait;
+   *  the output is silent until the child has caught up. */
+  bool prepare(double sampleRate, int blockSize, std::string& error);
+  /** Message thread. Launches a new child on the same shared memory after the previous one exited. */
+  bool restartChild(std::string& error);
+  /** While bypassed the input is passed through, delayed by the reported latency. Any thread. */
+  void setBypassed(bool shouldBypass) noexcept {
+    bypassed.store(shouldBypass, std::memory_order_relaxed);
+  }
+
+  void process(juce::AudioBuffer<float>& buffer, int startSample, int numSamples, const juce::MidiBuffer& midi);
+
+  /** False once the child has exited (crash or kill). Message thread. */
+  bool isChildRunning() const;
+  int getLatencySamples() const noexcept {
+    return latencySamples.load(std::memory_order_relaxed);
+  }
+  uint64_t getUnderrunFrames() const noexcept {
+    return underrunFrames.load();
+  }
+
+ private:
+  bool launchChild(std::string& error);
+
+  std::string shmName;
+  SharedBlock* shared = nullptr;
+  juce::File descriptionFile;
+  std::unique_ptr<juce::ChildProcess> child;
+  std::atomic<int> latencySamples{0};
+  std::atomic<bool> bypassed{false};
+  std::atomic<uint64_t> underrunFrames{0};
+};
+
+/** Entry point of a `--plugin-host <shm-name> <description.xml>` child process. */
+int runPluginHostProcess(const std::string& shmName, const std::string& descriptionPath);
+
+}  // namespace thestuu::native::sandbox
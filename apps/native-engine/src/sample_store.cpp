@@ -0,0 +1,376 @@
+#include "sample_store.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+namespace thestuu::native {
+
+namespace {
+
+constexpr size_t kAlignment = 32;
+constexpr const char* kStubExtension = ".stuusample";
+/** Fallback reads go through a scratch buffer of this many frames, allocated with the reader. */
+constexpr int kScratchSamples = 8192;
+
+/** Decoded channels in one allocation; every channel starts on a 32-byte boundary. */
+struct AlignedSamples {
+  float* data = nullptr;
+  int numChannels = 0;
+  int64_t stride = 0;
+
+  AlignedSamples(int channels, int64_t length) : numChannels(channels) {
+    const int64_t floatsPerAlign = static_cast<int64_t>(kAlignment / sizeof(float));
+    stride = (length + floatsPerAlign - 1) / floatsPerAlign * floatsPerAlign;
+    const size_t bytes = static_cast<size_t>(stride * channels) * sizeof(float);
+    void* block = nullptr;
+    if (posix_memalign(&block, kAlignment, std::max(bytes, kAlignment)) == 0) {
+      data = static_cast<float*>(block);
+    }
+  }
+
+  ~AlignedSamples() {
+    std::free(data);
+  }
+
+  AlignedSamples(const AlignedSamples&) = delete;
+  AlignedSamples& operator=(const AlignedSamples&) = delete;
+
+  float* channel(int index) const noexcept {
+    return data + stride * index;
+  }
+
+  int64_t bytes() const noexcept {
+    return stride * numChannels * static_cast<int64_t>(sizeof(float));
+  }
+};
+
+}  // namespace
+
+struct SampleStore::Entry {
+  std::string hash;
+  juce::File source;
+  double sampleRate = 0.0;
+  unsigned int numChannels = 0;
+  int64_t lengthInSamples = 0;
+  std::atomic<uint64_t> lastUse{0};
+
+  /** Readers on the audio thread only load; admit/evict publish under the store mutex. */
+  std::shared_ptr<const AlignedSamples> load() const {
+    return samples.load(std::memory_order_acquire);
+  }
+
+  void store(std::shared_ptr<const AlignedSamples> next) {
+    samples.store(std::move(next), std::memory_order_release);
+  }
+
+ private:
+  std::atomic<std::shared_ptr<const AlignedSamples>> samples;
+};
+
+namespace {
+
+/** Serves a stub from the RAM copy; switches to a streaming reader on the original once evicted.
+ *  The fallback reader and its scratch buffer are set up here, so readSamples neither locks, opens
+ *  files nor allocates. */
+class StoreReader final : public juce::AudioFormatReader {
+ public:
+  StoreReader(juce::InputStream* stream, std::shared_ptr<SampleStore> owner, std::shared_ptr<SampleStore::Entry> entryToUse)
+      : juce::AudioFormatReader(stream, "Stuu sample store"), store(std::move(owner)), entry(std::move(entryToUse)) {
+    sampleRate = entry->sampleRate;
+    bitsPerSample = 32;
+    lengthInSamples = entry->lengthInSamples;
+    numChannels = entry->numChannels;
+    usesFloatingPointData = true;
+    fallback.reset(store->createFallbackReader(entry->source));
+    scratch.setSize(static_cast<int>(numChannels), kScratchSamples);
+  }
+
+  bool readSamples(
+    int* const* destChannels,
+    int numDestChannels,
+    int startOffsetInDestBuffer,
+    juce::int64 startSampleInFile,
+    int numSamples
+  ) override {
+    clearSamplesBeyondAvailableLength(
+      destChannels, numDestChannels, startOffsetInDestBuffer, startSampleInFile, numSamples, lengthInSamples
+    );
+    if (numSamples <= 0) {
+      return true;
+    }
+    if (const auto samples = entry->load()) {
+      store->countRead(true);
+      entry->lastUse = store->nextUseTick();
+      for (int ch = 0; ch < numDestChannels; ++ch) {
+        if (destChannels[ch] == nullptr) {
+          continue;
+        }
+        auto* dest = reinterpret_cast<float*>(destChannels[ch]) + startOffsetInDestBuffer;
+        if (ch < samples->numChannels) {
+          std::memcpy(dest, samples->channel(ch) + startSampleInFile, static_cast<size_t>(numSamples) * sizeof(float));
+        } else {
+          std::fill(dest, dest + numSamples, 0.0F);
+        }
+      }
+      return true;
+    }
+
+    store->countRead(false);
+    if (fallback == nullptr) {
+      return false;
+    }
+    const int channels = static_cast<int>(numChannels);
+    for (int done = 0; done < numSamples;) {
+      const int count = std::min(kScratchSamples, numSamples - done);
+      if (!fallback->read(scratch.getArrayOfWritePointers(), channels, startSampleInFile + done, count)) {
+        return false;
+      }
+      for (int ch = 0; ch < numDestChannels; ++ch) {
+        if (destChannels[ch] == nullptr) {
+          continue;
+        }
+        auto* dest = reinterpret_cast<float*>(destChannels[ch]) + startOffsetInDestBuffer + done;
+        if (ch < channels) {
+          std::memcpy(dest, scratch.getReadPointer(ch), static_cast<size_t>(count) * sizeof(float));
+        } else {
+          std::fill(dest, dest + count, 0.0F);
+        }
+      }
+      done += count;
+    }
+    return true;
+  }
+
+ private:
+  std::shared_ptr<SampleStore> store;
+  std::shared_ptr<SampleStore::Entry> entry;
+  std::unique_ptr<juce::AudioFormatReader> fallback;
+  juce::AudioBuffer<float> scratch;
+};
+
+class StoreFormat final : public juce::AudioFormat {
+ public:
+  explicit StoreFormat(std::shared_ptr<SampleStore> owner)
+      : juce::AudioFormat("Stuu sample store", kStubExtension), store(std::move(owner)) {}
+
+  juce::Array<int> getPossibleSampleRates() override {
+    return {};
+  }
+
+  juce::Array<int> getPossibleBitDepths() override {
+    return {32};
+  }
+
+  bool canDoStereo() override {
+    return true;
+  }
+
+  bool canDoMono() override {
+    return true;
+  }
+
+  /** The stub holds "<hash>\n<original path>". */
+  juce::AudioFormatReader* createReaderFor(juce::InputStream* stream, bool deleteStreamIfOpeningFails) override {
+    std::unique_ptr<juce::InputStream> owned(stream);
+    const auto lines = juce::StringArray::fromLines(owned->readEntireStreamAsString());
+    if (lines.size() < 2) {
+      if (!deleteStreamIfOpeningFails) {
+        owned.release();
+      }
+      return nullptr;
+    }
+    if (auto entry = store->find(lines[0].trim().toStdString())) {
+      owned->setPosition(0);
+      return new StoreReader(owned.release(), store, std::move(entry));
+    }
+    // Unknown hash (e.g. the stub outlived a restart): stream the original.
+    return store->createFallbackReader(juce::File(lines[1].trim()));
+  }
+
+  juce::AudioFormatWriter* createWriterFor(
+    juce::OutputStream*,
+    double,
+    unsigned int,
+    int,
+    const juce::StringPairArray&,
+    int
+  ) override {
+    return nullptr;
+  }
+
+ private:
+  std::shared_ptr<SampleStore> store;
+};
+
+}  // namespace
+
+SampleStore::SampleStore(juce::AudioFormatManager& decodeFormats) : formats(decodeFormats) {}
+
+SampleStore::~SampleStore() = default;
+
+void SampleStore::configure(const SampleStoreConfig& next) {
+  std::lock_guard<std::mutex> lock(mutex);
+  config = next;
+  config.maxFileBytes = std::max<int64_t>(0, config.maxFileBytes);
+  config.budgetBytes = std::max<int64_t>(0, config.budgetBytes);
+  evictUntilFits(0);
+  dropRetired();
+}
+
+SampleStoreConfig SampleStore::getConfig() const {
+  std::lock_guard<std::mutex> lock(mutex);
+  return config;
+}
+
+juce::File SampleStore::admit(const std::string& hash, const juce::File& source, const juce::File& stubDirectory) {
+  const auto stub = stubDirectory.getChildFile(juce::String(hash) + kStubExtension);
+  int64_t maxFileBytes = 0;
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    dropRetired();
+    maxFileBytes = config.maxFileBytes;
+    if (const auto it = entries.find(hash); it != entries.end() && it->second->load() != nullptr) {
+      it->second->lastUse = nextUseTick();
+      return stub;
+    }
+  }
+  if (maxFileBytes <= 0) {
+    return {};
+  }
+
+  std::unique_ptr<juce::AudioFormatReader> reader(formats.createReaderFor(source));
+  if (reader == nullptr || reader->lengthInSamples <= 0 || reader->numChannels == 0) {
+    return {};
+  }
+  const int channels = static_cast<int>(reader->numChannels);
+  const int64_t decodedBytes = reader->lengthInSamples * channels * static_cast<int64_t>(sizeof(float));
+  if (decodedBytes > maxFileBytes || reader->lengthInSamples > std::numeric_limits<int>::max()) {
+    return {};
+  }
+  auto samples = std::make_shared<AlignedSamples>(channels, reader->lengthInSamples);
+  if (samples->data == nullptr) {
+    return {};
+  }
+  std::vector<float*> pointers(static_cast<size_t>(channels));
+  for (int ch = 0; ch < channels; ++ch) {
+    pointers[static_cast<size_t>(ch)] = samples->channel(ch);
+  }
+  if (!reader->read(pointers.data(), channels, 0, static_cast<int>(reader->lengthInSamples))) {
+    return {};
+  }
+
+  stubDirectory.createDirectory();
+  if (!stub.replaceWithText(juce::String(hash) + "\n" + source.getFullPathName() + "\n")) {
+    return {};
+  }
+
+  std::lock_guard<std::mutex> lock(mutex);
+  if (samples->bytes() > config.budgetBytes) {
+    return {};
+  }
+  if (const auto it = entries.find(hash); it != entries.end() && it->second->load() != nullptr) {
+    return stub;  // admitted concurrently
+  }
+  evictUntilFits(samples->bytes());
+  auto& entry = entries[hash];
+  if (entry == nullptr) {
+    // Metadata is fixed from here on: readers of an evicted entry use it while it is re-admitted.
+    entry = std::make_shared<Entry>();
+    entry->hash = hash;
+    entry->source = source;
+    entry->sampleRate = reader->sampleRate;
+    entry->numChannels = reader->numChannels;
+    entry->lengthInSamples = reader->lengthInSamples;
+  }
+  entry->lastUse = nextUseTick();
+  residentBytes += samples->bytes();
+  entry->store(std::move(samples));
+  return stub;
+}
+
+void SampleStore::release(const std::string& hash) {
+  std::lock_guard<std::mutex> lock(mutex);
+  const auto it = entries.find(hash);
+  if (it == entries.end()) {
+    return;
+  }
+  if (auto samples = it->second->load()) {
+    residentBytes -= samples->bytes();
+    retired.push_back(std::move(samples));
+  }
+  it->second->store(nullptr);
+  entries.erase(it);
+  dropRetired();
+}
+
+/** Caller holds mutex. Evicted entries stay known (metadata, source) so open readers can stream. */
+void SampleStore::evictUntilFits(int64_t incomingBytes) {
+  while (residentBytes + incomingBytes > config.budgetBytes) {
+    std::shared_ptr<Entry> oldest;
+    for (const auto& [hash, entry] : entries) {
+      if (entry->load() != nullptr && (oldest == nullptr || entry->lastUse.load() < oldest->lastUse.load())) {
+        oldest = entry;
+      }
+    }
+    if (oldest == nullptr) {
+      return;
+    }
+    auto samples = oldest->load();
+    residentBytes -= samples->bytes();
+    oldest->store(nullptr);
+    retired.push_back(std::move(samples));
+    ++evictions;
+  }
+}
+
+/** Caller holds mutex. A reader that loaded a buffer just before its eviction must not be the one to
+ *  free it on the audio thread, so evicted buffers are kept until nobody else holds them. */
+void SampleStore::dropRetired() {
+  retired.erase(
+    std::remove_if(retired.begin(), retired.end(), [](const auto& samples) { return samples.use_count() == 1; }),
+    retired.end()
+  );
+}
+
+SampleStoreStats SampleStore::getStats() const {
+  std::lock_guard<std::mutex> lock(mutex);
+  SampleStoreStats stats;
+  stats.entries = static_cast<int32_t>(entries.size());
+  for (const auto& [hash, entry] : entries) {
+    stats.residentEntries += entry->load() != nullptr ? 1 : 0;
+  }
+  stats.residentBytes = residentBytes;
+  stats.budgetBytes = config.budgetBytes;
+  stats.maxFileBytes = config.maxFileBytes;
+  stats.hits = hits.load();
+  stats.misses = misses.load();
+  stats.evictions = evictions;
+  return stats;
+}
+
+std::unique_ptr<juce::AudioFormat> SampleStore::createFormat() {
+  return std::make_unique<StoreFormat>(shared_from_this());
+}
+
+std::shared_ptr<SampleStore::Entry> SampleStore::find(const std::string& hash) const {
+  std::lock_guard<std::mutex> lock(mutex);
+  const auto it = entries.find(hash);
+  return it != entries.end() ? it->second : nullptr;
+}
+
+juce::AudioFormatReader* SampleStore::createFallbackReader(const juce::File& source) {
+  return formats.createReaderFor(source);
+}
+
+void SampleStore::countRead(bool hit) {
+  (hit ? hits : misses).fetch_add(1, std::memory_order_relaxed);
+}
+
+uint64_t SampleStore::nextUseTick() {
+  return useTick.fetch_add(1, std::memory_order_relaxed) + 1;
+}
+
+}  // namespace thestuu::native
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <juce_audio_formats/juce_audio_formats.h>
+
+namespace thestuu::native {
+
+struct SampleStoreConfig {
+  /** Sources with more decoded float data than this keep streaming from disk. 0 disables the store. */
+  int64_t maxFileBytes = 8 * 1024 * 1024;
+  /** Total decoded bytes held in RAM; least recently used entries fall back to streaming beyond it. */
+  int64_t budgetBytes = 256 * 1024 * 1024;
+};
+
+struct SampleStoreStats {
+  int32_t entries = 0;
+  int32_t residentEntries = 0;
+  int64_t residentBytes = 0;
+  int64_t budgetBytes = 0;
+  int64_t maxFileBytes = 0;
+  /** Reads served from RAM vs. from the streaming fallback (evicted or never admitted). */
+  uint64_t hits = 0;
+  uint64_t misses = 0;
+  uint64_t evictions = 0;
+};
+
+/** Fully decoded short samples in 32-byte aligned float buffers, under a global budget with LRU eviction.
+ *  Clips reference a small stub file ("<hash>.stuusample"); the format returned by createFormat() is
+ *  registered with the engine's read format manager and turns such a stub into a reader over the RAM
+ *  copy, or over the original file once the entry has been evicted. */
+class SampleStore : public std::enable_shared_from_this<SampleStore> {
+ public:
+  struct Entry;
+
+  /** decodeFormats decodes sources and opens the streaming fallback. It may be the manager createFormat()
+   *  is registered with: sources are never stubs. */
+  explicit SampleStore(juce::AudioFormatManager& decodeFormats);
+  ~SampleStore();
+
+  void configure(const SampleStoreConfig& config);
+  SampleStoreConfig getConfig() const;
+
+  /** Decodes source into RAM if it is short enough and fits the budget (evicting LRU entries), writes the
+   *  stub into stubDirectory and returns it. Returns an empty File if the source should keep streaming. */
+  juce::File admit(const std::string& hash, const juce::File& source, const juce::File& stubDirectory);
+
+  /** Drops the entry; readers still open on it continue from the original file. */
+  void release(const std::string& hash);
+
+  SampleStoreStats getStats() const;
+
+  /** Format for the engine's read format manager; keeps the store alive as long as it is registered. */
+  std::unique_ptr<juce::AudioFormat> createFormat();
+
+  std::shared_ptr<Entry> find(const std::string& hash) const;
+  juce::AudioFormatReader* createFallbackReader(const juce::File& source);
+  void countRead(bool hit);
+  uint64_t nextUseTick();
+
+ private:
+  void evictUntilFits(int64_t incomingBytes);
+  void dropRetired();
+
+  juce::AudioFormatManager& formats;
+  mutable std::mutex mutex;
+  SampleStoreConfig config;
+  std::unordered_map<std::string, std::shared_ptr<Entry>> entries;
+  int64_t residentBytes = 0;
+  /** Evicted buffers a reader may still hold; see dropRetired. */
+  std::vector<std::shared_ptr<const void>> retired;
+  std::atomic<uint64_t> useTick{0};
+  std::atomic<uint64_t> hits{0};
+  std::atomic<uint64_t> misses{0};
+  uint64_t evictions = 0;
+};
+
+}  // namespace thestuu::native
@@ -0,0 +1,92 @@
+#include "silence_scan.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace thestuu::native {
+
+namespace {
+
+constexpr int kScanBlockSamples = 4096;
+
+/** Index of the first (or last) sample in block whose magnitude reaches threshold on any channel, or -1. */
+int findAudibleSample(const juce::AudioBuffer<float>& block, int numSamples, float threshold, bool fromEnd) {
+  int found = -1;
+  for (int ch = 0; ch < block.getNumChannels(); ++ch) {
+    const float* data = block.getReadPointer(ch);
+    if (fromEnd) {
+      for (int i = numSamples; --i > found;) {
+        if (std::abs(data[i]) >= threshold) {
+          found = i;
+          break;
+        }
+      }
+    } else {
+      const int limit = found >= 0 ? found : numSamples;
+      for (int i = 0; i < limit; ++i) {
+        if (std::abs(data[i]) >= threshold) {
+          found = i;
+          break;
+        }
+      }
+    }
+  }
+  return found;
+}
+
+}  // namespace
+
+bool scanSilence(juce::AudioFormatReader& reader, double thresholdDb, SilenceScan& scan) {
+  scan = {};
+  if (reader.sampleRate <= 0.0 || reader.numChannels == 0) {
+    return false;
+  }
+  const float threshold = juce::Decibels::decibelsToGain(static_cast<float>(thresholdDb));
+  const int channels = static_cast<int>(reader.numChannels);
+  const juce::int64 length = reader.lengthInSamples;
+  juce::AudioBuffer<float> block(channels, kScanBlockSamples);
+
+  // Peak per block via FloatVectorOperations min/max (SIMD); only the hit block is searched per sample.
+  const auto blockPeak = [&](int numSamples) {
+    float peak = 0.0F;
+    for (int ch = 0; ch < channels; ++ch) {
+      const auto range = juce::FloatVectorOperations::findMinAndMax(block.getReadPointer(ch), numSamples);
+      peak = std::max({peak, -range.getStart(), range.getEnd()});
+    }
+    return peak;
+  };
+
+  juce::int64 firstAudible = length;
+  for (juce::int64 pos = 0; pos < length; pos += kScanBlockSamples) {
+    const int count = static_cast<int>(std::min<juce::int64>(kScanBlockSamples, length - pos));
+    if (!reader.read(&block, 0, count, pos, true, true)) {
+      return false;
+    }
+    if (blockPeak(count) >= threshold) {
+      firstAudible = pos + findAudibleSample(block, count, threshold, false);
+      break;
+    }
+  }
+
+  juce::int64 lastAudible = firstAudible;
+  for (juce::int64 end = length; end > firstAudible; end -= kScanBlockSamples) {
+    const juce::int64 pos = std::max(firstAudible, end - kScanBlockSamples);
+    const int count = static_cast<int>(end - pos);
+    if (!reader.read(&block, 0, count, pos, true, true)) {
+      return false;
+    }
+    if (blockPeak(count) >= threshold) {
+      lastAudible = pos + findAudibleSample(block, count, threshold, true);
+      break;
+    }
+  }
+
+  if (firstAudible >= length) {
+    return true;  // nothing above the threshold: leave the file untrimmed
+  }
+  scan.leadingSeconds = static_cast<double>(firstAudible) / reader.sampleRate;
+  scan.trailingSeconds = static_cast<double>(length - 1 - lastAudible) / reader.sampleRate;
+  return true;
+}
+
+}  // namespace thestuu::native
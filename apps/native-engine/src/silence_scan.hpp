@@ -0,0 +1,18 @@
+#pragma once
+
+#include <juce_audio_formats/juce_audio_formats.h>
+
+namespace thestuu::native {
+
+struct SilenceScan {
+  double leadingSeconds = 0.0;
+  double trailingSeconds = 0.0;
+};
+
+/** Measures leading and trailing silence of reader: everything below thresholdDb (peak, any channel)
+ *  at either end. Reads block by block from each end and stops at the first block whose peak reaches
+ *  the threshold, so only the silent edges are decoded. A reader with nothing above the threshold
+ *  reports no silence (the file stays untrimmed). Returns false if the reader fails. */
+bool scanSilence(juce::AudioFormatReader& reader, double thresholdDb, SilenceScan& scan);
+
+}  // namespace thestuu::native
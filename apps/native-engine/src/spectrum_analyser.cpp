@@ -0,0 +1,188 @@
+#include "spectrum_analyser.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace thestuu::native {
+
+namespace {
+
+/** 4096 points: about 11 Hz per bin at 48 kHz, enough to separate the lowest EQ band from DC. */
+constexpr int kFftOrder = 12;
+constexpr int kFftSize = 1 << kFftOrder;
+constexpr int kFftBins = kFftSize / 2 + 1;
+/** Room for several frames of audio at 192 kHz; a stalled message thread drops audio instead of blocking. */
+constexpr int kFifoSize = 1 << 15;
+/** Hann window (coherent gain 0.5) and single-sided spectrum (2 / N): a full-scale sine reads 1.0. */
+constexpr float kMagnitudeScale = 4.0F / static_cast<float>(kFftSize);
+/** Release of the displayed levels; peaks are taken immediately. */
+constexpr float kReleaseDbPerFrame = 1.5F;
+constexpr juce::uint32 kKeepAliveMs = 2000;
+
+void toLogBins(
+  const std::vector<float>& levels,
+  double sampleRate,
+  int binCount,
+  double minHz,
+  double maxHz,
+  std::vector<float>& bins
+) {
+  bins.assign(static_cast<size_t>(std::max(0, binCount)), kSpectrumFloorDb);
+  if (sampleRate <= 0.0 || binCount <= 0 || !(minHz > 0.0) || !(maxHz > minHz)) {
+    return;
+  }
+  const double hzPerBin = sampleRate / kFftSize;
+  const int lastBin = kFftBins - 1;
+  const double ratio = maxHz / minHz;
+  for (int i = 0; i < binCount; ++i) {
+    const double lowHz = minHz * std::pow(ratio, static_cast<double>(i) / binCount);
+    const double highHz = minHz * std::pow(ratio, static_cast<double>(i + 1) / binCount);
+    const int from = static_cast<int>(std::ceil(lowHz / hzPerBin));
+    const int to = std::min(lastBin, static_cast<int>(std::floor(highHz / hzPerBin)));
+    auto& bin = bins[static_cast<size_t>(i)];
+    if (from <= to) {
+      bin = *std::max_element(levels.begin() + from, levels.begin() + to + 1);
+      continue;
+    }
+    // Low end: the band lies between two FFT bins, interpolate at its (geometric) centre.
+    const double position = std::sqrt(lowHz * highHz) / hzPerBin;
+    const int below = std::clamp(static_cast<int>(position), 0, lastBin - 1);
+    const auto fraction = static_cast<float>(std::clamp(position - below, 0.0, 1.0));
+    const float low = levels[static_cast<size_t>(below)];
+    bin = low + (levels[static_cast<size_t>(below) + 1] - low) * fraction;
+  }
+}
+
+}  // namespace
+
+struct SpectrumAnalyser::Tap {
+  juce::AbstractFifo fifo{kFifoSize};
+  std::vector<float> fifoData = std::vector<float>(static_cast<size_t>(kFifoSize), 0.0F);
+  /** The latest kFftSize samples, oldest first. */
+  std::vector<float> history = std::vector<float>(static_cast<size_t>(kFftSize), 0.0F);
+  std::vector<float> levelsDb = std::vector<float>(static_cast<size_t>(kFftBins), kSpectrumFloorDb);
+
+  /** Moves everything the audio thread wrote into history; returns the number of samples. */
+  int drain() {
+    const int ready = fifo.getNumReady();
+    if (ready <= 0) {
+      return 0;
+    }
+    const auto scope = fifo.read(ready);
+    const auto append = [this](int start, int size) {
+      if (size <= 0) {
+        return;
+      }
+      const float* source = fifoData.data() + start;
+      if (size >= kFftSize) {
+        std::copy(source + size - kFftSize, source + size, history.begin());
+        return;
+      }
+      std::copy(history.begin() + size, history.end(), history.begin());
+      std::copy(source, source + size, history.end() - size);
+    };
+    append(scope.startIndex1, scope.blockSize1);
+    append(scope.startIndex2, scope.blockSize2);
+    return ready;
+  }
+};
+
+SpectrumAnalyser::SpectrumAnalyser()
+  : pre(std::make_unique<Tap>()),
+    post(std::make_unique<Tap>()),
+    fft(kFftOrder),
+    window(static_cast<size_t>(kFftSize), juce::dsp::WindowingFunction<float>::hann, false),
+    fftData(static_cast<size_t>(kFftSize) * 2, 0.0F) {}
+
+SpectrumAnalyser::~SpectrumAnalyser() {
+  stopTimer();
+}
+
+void SpectrumAnalyser::setSampleRate(double rate) noexcept {
+  sampleRate.store(rate, std::memory_order_relaxed);
+}
+
+void SpectrumAnalyser::pushPre(const juce::AudioBuffer<float>& buffer, int startSample, int numSamples) noexcept {
+  push(*pre, buffer, startSample, numSamples);
+}
+
+void SpectrumAnalyser::pushPost(const juce::AudioBuffer<float>& buffer, int startSample, int numSamples) noexcept {
+  push(*post, buffer, startSample, numSamples);
+}
+
+void SpectrumAnalyser::push(Tap& tap, const juce::AudioBuffer<float>& buffer, int startSample, int numSamples) noexcept {
+  const int channels = buffer.getNumChannels();
+  if (!isWatched() || channels <= 0 || numSamples <= 0) {
+    return;
+  }
+  const int count = std::min(numSamples, tap.fifo.getFreeSpace());
+  const auto scope = tap.fifo.write(count);
+  const float gain = 1.0F / static_cast<float>(channels);
+  const auto mixDown = [&](int fifoStart, int size, int offset) {
+    if (size <= 0) {
+      return;
+    }
+    float* destination = tap.fifoData.data() + fifoStart;
+    juce::FloatVectorOperations::copyWithMultiply(destination, buffer.getReadPointer(0, startSample + offset), gain, size);
+    for (int channel = 1; channel < channels; ++channel) {
+      juce::FloatVectorOperations::addWithMultiply(destination, buffer.getReadPointer(channel, startSample + offset), gain, size);
+    }
+  };
+  mixDown(scope.startIndex1, scope.blockSize1, 0);
+  mixDown(scope.startIndex2, scope.blockSize2, scope.blockSize1);
+}
+
+void SpectrumAnalyser::keepAlive() {
+  lastKeepAliveMs = juce::Time::getMillisecondCounter();
+  if (!isTimerRunning()) {
+    watched.store(true, std::memory_order_relaxed);
+    startTimerHz(kFramesPerSecond);
+  }
+}
+
+void SpectrumAnalyser::getLogBins(
+  int binCount,
+  double minHz,
+  double maxHz,
+  std::vector<float>& preDb,
+  std::vector<float>& postDb
+) const {
+  const double rate = getSampleRate();
+  toLogBins(pre->levelsDb, rate, binCount, minHz, maxHz, preDb);
+  toLogBins(post->levelsDb, rate, binCount, minHz, maxHz, postDb);
+}
+
+void SpectrumAnalyser::timerCallback() {
+  if (juce::Time::getMillisecondCounter() - lastKeepAliveMs > kKeepAliveMs) {
+    stopTimer();
+    watched.store(false, std::memory_order_relaxed);
+    signal = false;
+    for (auto* tap : {pre.get(), post.get()}) {
+      tap->drain();
+      std::fill(tap->levelsDb.begin(), tap->levelsDb.end(), kSpectrumFloorDb);
+    }
+    return;
+  }
+
+  signal = false;
+  for (auto* tap : {pre.get(), post.get()}) {
+    // Without new audio (transport stopped, plugin bypassed) the levels just fall.
+    const bool fresh = tap->drain() > 0;
+    if (fresh) {
+      signal = true;
+      std::copy(tap->history.begin(), tap->history.end(), fftData.begin());
+      std::fill(fftData.begin() + kFftSize, fftData.end(), 0.0F);
+      window.multiplyWithWindowingTable(fftData.data(), static_cast<size_t>(kFftSize));
+      fft.performFrequencyOnlyForwardTransform(fftData.data(), true);
+    }
+    for (int bin = 0; bin < kFftBins; ++bin) {
+      const float db = fresh
+        ? juce::Decibels::gainToDecibels(fftData[static_cast<size_t>(bin)] * kMagnitudeScale, kSpectrumFloorDb)
+        : kSpectrumFloorDb;
+      auto& level = tap->levelsDb[static_cast<size_t>(bin)];
+      level = std::max(db, level - kReleaseDbPerFrame);
+    }
+  }
+}
+
+}  // namespace thestuu::native
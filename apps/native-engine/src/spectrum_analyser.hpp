@@ -0,0 +1,59 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include <juce_dsp/juce_dsp.h>
+
+namespace thestuu::native {
+
+/** Level reported for empty bands and while the analyser has not seen any audio. */
+constexpr float kSpectrumFloorDb = -120.0F;
+
+/** Pre/post spectrum of one insert effect. The audio thread only mixes each block down to mono into a
+ *  lock-free FIFO per tap, and only while someone is watching; the FFTs run on the message thread at
+ *  kFramesPerSecond. A full-scale sine reads 0 dB. */
+class SpectrumAnalyser final : private juce::Timer {
+ public:
+  static constexpr int kFramesPerSecond = 30;
+
+  SpectrumAnalyser();
+  ~SpectrumAnalyser() override;
+
+  /** Any thread; called when the plugin is initialised for playback. */
+  void setSampleRate(double sampleRate) noexcept;
+  double getSampleRate() const noexcept { return sampleRate.load(std::memory_order_relaxed); }
+
+  /** Audio thread. Cheap no-ops unless the analyser is watched. */
+  bool isWatched() const noexcept { return watched.load(std::memory_order_relaxed); }
+  void pushPre(const juce::AudioBuffer<float>& buffer, int startSample, int numSamples) noexcept;
+  void pushPost(const juce::AudioBuffer<float>& buffer, int startSample, int numSamples) noexcept;
+
+  /** Message thread. Starts the analysis (if needed) and keeps it running for another two seconds;
+   *  call it on every poll or repaint. */
+  void keepAlive();
+  /** Message thread. True if the tapped plugin delivered audio since the previous frame. */
+  bool hasSignal() const noexcept { return signal; }
+  /** Message thread. binCount log-spaced bands between minHz and maxHz (peak of the FFT bins in each
+   *  band, interpolated where a band is narrower than one bin), in dB with peak hold and release. */
+  void getLogBins(int binCount, double minHz, double maxHz, std::vector<float>& preDb, std::vector<float>& postDb) const;
+
+ private:
+  struct Tap;
+
+  void push(Tap& tap, const juce::AudioBuffer<float>& buffer, int startSample, int numSamples) noexcept;
+  void timerCallback() override;
+
+  std::unique_ptr<Tap> pre;
+  std::unique_ptr<Tap> post;
+  juce::dsp::FFT fft;
+  juce::dsp::WindowingFunction<float> window;
+  std::vector<float> fftData;
+  std::atomic<double> sampleRate{0.0};
+  std::atomic<bool> watched{false};
+  juce::uint32 lastKeepAliveMs = 0;
+  bool signal = false;
+};
+
+}  // namespace thestuu::native
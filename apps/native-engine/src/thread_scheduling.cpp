@@ -0,0 +1,357 @@
+#include "thread_scheduling.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+
+#include <pthread.h>
+#include <sched.h>
+
+#if defined(__linux__)
+#include <dirent.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace thestuu::native {
+
+namespace {
+
+std::mutex gReportMutex;
+std::vector<ThreadSchedulingState> gReport;
+
+int policyFromName(const std::string& name) {
+  if (name == "fifo") {
+    return SCHED_FIFO;
+  }
+  if (name == "rr") {
+    return SCHED_RR;
+  }
+  return SCHED_OTHER;
+}
+
+std::string policyName(int policy) {
+  switch (policy) {
+    case SCHED_FIFO:
+      return "fifo";
+    case SCHED_RR:
+      return "rr";
+    default:
+      return "other";
+  }
+}
+
+int envInt(const char* name, int fallback, int minValue, int maxValue) {
+  if (const char* envValue = std::getenv(name)) {
+    char* end = nullptr;
+    const long value = std::strtol(envValue, &end, 10);
+    if (end != envValue && *end == '\0' && value >= minValue && value <= maxValue) {
+      return static_cast<int>(value);
+    }
+  }
+  return fallback;
+}
+
+std::vector<int> envCpus(const char* name) {
+  std::vector<int> cpus;
+  if (const char* envValue = std::getenv(name)) {
+    if (!parseCpuList(envValue, cpus)) {
+      cpus.clear();
+    }
+  }
+  return cpus;
+}
+
+void appendError(std::string& error, const std::string& text) {
+  if (!error.empty()) {
+    error += "; ";
+  }
+  error += text;
+}
+
+int currentThreadId() {
+#if defined(__linux__)
+  return static_cast<int>(syscall(SYS_gettid));
+#else
+  return 0;
+#endif
+}
+
+/** Affinity of \a threadId (0 = calling thread). */
+bool readAffinity(std::vector<int>& cpus, int threadId = 0) {
+  cpus.clear();
+#if defined(__linux__)
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  if (sched_getaffinity(threadId, sizeof(set), &set) != 0) {
+    return false;
+  }
+  for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+    if (CPU_ISSET(cpu, &set)) {
+      cpus.push_back(cpu);
+    }
+  }
+  return true;
+#else
+  (void) threadId;
+  return false;
+#endif
+}
+
+int writeAffinity(const std::vector<int>& cpus) {
+#if defined(__linux__)
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  for (const int cpu : cpus) {
+    CPU_SET(cpu, &set);
+  }
+  return pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#else
+  (void) cpus;
+  return ENOTSUP;
+#endif
+}
+
+/** Reads policy, priority and mask of \a threadId back from the kernel; false if it has exited. */
+bool readThreadScheduling(int threadId, ThreadSchedulingState& state) {
+#if defined(__linux__)
+  const int policy = sched_getscheduler(threadId);
+  sched_param param{};
+  if (policy < 0 || sched_getparam(threadId, &param) != 0) {
+    return false;
+  }
+  state.policy = policyName(policy);
+  state.priority = param.sched_priority;
+  readAffinity(state.cpus, threadId);
+  return true;
+#else
+  (void) threadId;
+  (void) state;
+  return false;
+#endif
+}
+
+/** One entry per live thread: a thread id replaces its old entry, and with ids unavailable the role does. */
+void record(const ThreadSchedulingState& state) {
+  std::lock_guard<std::mutex> lock(gReportMutex);
+  for (auto& entry : gReport) {
+    if (state.threadId != 0 ? entry.threadId == state.threadId : entry.role == state.role) {
+      entry = state;
+      return;
+    }
+  }
+  gReport.push_back(state);
+}
+
+}  // namespace
+
+bool parseCpuList(const std::string& text, std::vector<int>& cpus) {
+  cpus.clear();
+  size_t pos = 0;
+  while (pos < text.size()) {
+    size_t comma = text.find(',', pos);
+    if (comma == std::string::npos) {
+      comma = text.size();
+    }
+    const std::string part = text.substr(pos, comma - pos);
+    pos = comma + 1;
+    if (part.empty()) {
+      continue;
+    }
+    char* end = nullptr;
+    const long first = std::strtol(part.c_str(), &end, 10);
+    long last = first;
+    if (end == part.c_str()) {
+      return false;
+    }
+    if (*end == '-') {
+      const char* rangeStart = end + 1;
+      last = std::strtol(rangeStart, &end, 10);
+      if (end == rangeStart) {
+        return false;
+      }
+    }
+    if (*end != '\0' || first < 0 || last < first || last >= 1024) {
+      return false;
+    }
+    for (long cpu = first; cpu <= last; ++cpu) {
+      cpus.push_back(static_cast<int>(cpu));
+    }
+  }
+  std::sort(cpus.begin(), cpus.end());
+  cpus.erase(std::unique(cpus.begin(), cpus.end()), cpus.end());
+  return !cpus.empty();
+}
+
+ThreadSchedulingConfig threadSchedulingConfigFromEnvironment() {
+  ThreadSchedulingConfig config;
+  if (const char* envValue = std::getenv("STUU_RT_POLICY")) {
+    const std::string policy = envValue;
+    if (policy == "fifo" || policy == "rr" || policy == "other") {
+      config.policy = policy;
+    }
+  }
+  if (config.policy != "other") {
+    const int minPriority = sched_get_priority_min(policyFromName(config.policy));
+    const int maxPriority = sched_get_priority_max(policyFromName(config.policy));
+    config.audioPriority = envInt("STUU_RT_AUDIO_PRIORITY", std::min(80, maxPriority), minPriority, maxPriority);
+    config.workerPriority = envInt(
+      "STUU_RT_WORKER_PRIORITY",
+      std::max(minPriority, config.audioPriority - 10),
+      minPriority,
+      maxPriority
+    );
+  }
+  config.audioCpus = envCpus("STUU_AUDIO_CPUS");
+  config.messageCpus = envCpus("STUU_MESSAGE_CPUS");
+  config.ipcCpus = envCpus("STUU_IPC_CPUS");
+  if (!config.messageCpus.empty()) {
+    // Threads started from the pinned message thread inherit its mask; give unset roles the startup mask back.
+    std::vector<int> startupCpus;
+    readAffinity(startupCpus);
+    if (config.audioCpus.empty()) {
+      config.audioCpus = startupCpus;
+    }
+    if (config.ipcCpus.empty()) {
+      config.ipcCpus = startupCpus;
+    }
+  }
+  return config;
+}
+
+ThreadSchedulingState applyCurrentThreadScheduling(
+  const std::string& role,
+  const std::string& policy,
+  int priority,
+  const std::vector<int>& cpus
+) {
+  std::string error;
+  const int policyId = policyFromName(policy);
+  if (policyId != SCHED_OTHER && priority > 0) {
+    sched_param param{};
+    param.sched_priority = priority;
+    if (const int result = pthread_setschedparam(pthread_self(), policyId, &param); result != 0) {
+      appendError(error, "sched " + policy + ": " + std::strerror(result));
+    }
+  }
+  if (!cpus.empty()) {
+    if (const int result = writeAffinity(cpus); result != 0) {
+      appendError(error, std::string("affinity: ") + std::strerror(result));
+    }
+  }
+  ThreadSchedulingState state = queryCurrentThreadScheduling(role);
+  state.error = error;
+  record(state);
+  return state;
+}
+
+ThreadSchedulingState queryCurrentThreadScheduling(const std::string& role) {
+  ThreadSchedulingState state;
+  state.role = role;
+  state.threadId = currentThreadId();
+  int policy = SCHED_OTHER;
+  sched_param param{};
+  if (pthread_getschedparam(pthread_self(), &policy, &param) == 0) {
+    state.policy = policyName(policy);
+    state.priority = param.sched_priority;
+  }
+  readAffinity(state.cpus);
+  return state;
+}
+
+std::vector<int> listProcessThreadIds() {
+  std::vector<int> ids;
+#if defined(__linux__)
+  if (DIR* dir = opendir("/proc/self/task")) {
+    while (const dirent* entry = readdir(dir)) {
+      char* end = nullptr;
+      const long id = std::strtol(entry->d_name, &end, 10);
+      if (end != entry->d_name && *end == '\0' && id > 0) {
+        ids.push_back(static_cast<int>(id));
+      }
+    }
+    closedir(dir);
+  }
+  std::sort(ids.begin(), ids.end());
+#endif
+  return ids;
+}
+
+std::string readThreadName(int threadId) {
+  std::string name;
+#if defined(__linux__)
+  const std::string path = "/proc/self/task/" + std::to_string(threadId != 0 ? threadId : currentThreadId()) + "/comm";
+  if (std::FILE* file = std::fopen(path.c_str(), "r")) {
+    char buffer[64] = {};
+    if (std::fgets(buffer, sizeof(buffer), file) != nullptr) {
+      name = buffer;
+      while (!name.empty() && (name.back() == '\n' || name.back() == '\r')) {
+        name.pop_back();
+      }
+    }
+    std::fclose(file);
+  }
+#else
+  (void)threadId;
+#endif
+  return name;
+}
+
+ThreadSchedulingState applyThreadScheduling(
+  int threadId,
+  const std::string& role,
+  const std::string& policy,
+  int priority,
+  const std::vector<int>& cpus
+) {
+  ThreadSchedulingState state;
+  state.role = role;
+  state.threadId = threadId;
+#if defined(__linux__)
+  const int policyId = policyFromName(policy);
+  if (policyId != SCHED_OTHER && priority > 0) {
+    sched_param param{};
+    param.sched_priority = priority;
+    if (sched_setscheduler(threadId, policyId, &param) != 0) {
+      appendError(state.error, "sched " + policy + ": " + std::strerror(errno));
+    }
+  }
+  if (!cpus.empty()) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (const int cpu : cpus) {
+      CPU_SET(cpu, &set);
+    }
+    if (sched_setaffinity(threadId, sizeof(set), &set) != 0) {
+      appendError(state.error, std::string("affinity: ") + std::strerror(errno));
+    }
+  }
+  if (!readThreadScheduling(threadId, state)) {
+    return state;  // exited meanwhile
+  }
+#else
+  (void) policy;
+  (void) priority;
+  (void) cpus;
+  state.error = "per-thread scheduling is only supported on Linux";
+#endif
+  record(state);
+  return state;
+}
+
+std::vector<ThreadSchedulingState> getThreadSchedulingReport() {
+  std::lock_guard<std::mutex> lock(gReportMutex);
+  for (auto it = gReport.begin(); it != gReport.end();) {
+    if (it->threadId == 0 || readThreadScheduling(it->threadId, *it)) {
+      ++it;
+    } else {
+      it = gReport.erase(it);
+    }
+  }
+  return gReport;
+}
+
+}  // namespace thestuu::native
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+namespace thestuu::native {
+
+/** Real-time scheduling and CPU affinity per thread role (audio, worker, message, ipc).
+ *  Configured from the environment at startup; see docs/native-ipc.md. */
+struct ThreadSchedulingConfig {
+  /** "other" (default scheduler), "fifo" or "rr". Applies to the audio and graph worker threads. */
+  std::string policy = "other";
+  int audioPriority = 0;
+  int workerPriority = 0;
+  /** Empty mask = leave the affinity alone. */
+  std::vector<int> audioCpus;
+  std::vector<int> messageCpus;
+  std::vector<int> ipcCpus;
+};
+
+/** Effective settings of one thread after applying its role. */
+struct ThreadSchedulingState {
+  std::string role;
+  /** Kernel thread id (Linux); 0 where thread ids are not available. */
+  int threadId = 0;
+  std::string policy;
+  int priority = 0;
+  std::vector<int> cpus;
+  /** Empty if everything requested was applied (e.g. EPERM without CAP_SYS_NICE / RLIMIT_RTPRIO). */
+  std::string error;
+};
+
+/** Reads STUU_RT_POLICY, STUU_RT_AUDIO_PRIORITY, STUU_RT_WORKER_PRIORITY, STUU_AUDIO_CPUS,
+ *  STUU_MESSAGE_CPUS and STUU_IPC_CPUS. Invalid values fall back to the defaults. Call on the main
+ *  thread before anything is pinned: with a message mask set, unset audio/ipc masks get the startup mask. */
+ThreadSchedulingConfig threadSchedulingConfigFromEnvironment();
+
+/** Parses "0,2,4-7" into a sorted CPU list. */
+bool parseCpuList(const std::string& text, std::vector<int>& cpus);
+
+/** Applies policy/priority (policy "other" or priority 0 = unchanged) and CPU mask to the calling
+ *  thread and records the result under role. Not real-time safe; call once per thread. */
+ThreadSchedulingState applyCurrentThreadScheduling(
+  const std::string& role,
+  const std::string& policy,
+  int priority,
+  const std::vector<int>& cpus
+);
+
+/** Effective settings of the calling thread without changing anything. */
+ThreadSchedulingState queryCurrentThreadScheduling(const std::string& role);
+
+/** Ids of all threads of this process (Linux: /proc/self/task), sorted; empty elsewhere. */
+std::vector<int> listProcessThreadIds();
+
+/** Kernel name of a thread of this process (0 = calling thread), as in /proc/self/task/<id>/comm.
+ *  Unnamed threads carry the name of the thread that created them. Empty if unavailable. */
+std::string readThreadName(int threadId);
+
+/** Like applyCurrentThreadScheduling, for another thread of this process (Linux only). Used for
+ *  threads Tracktion spawns, which run no code of ours before they process audio. */
+ThreadSchedulingState applyThreadScheduling(
+  int threadId,
+  const std::string& role,
+  const std::string& policy,
+  int priority,
+  const std::vector<int>& cpus
+);
+
+/** Recorded threads with their settings read back from the kernel now; threads that have exited are
+ *  dropped. The apply error of each thread is kept. */
+std::vector<ThreadSchedulingState> getThreadSchedulingReport();
+
+}  // namespace thestuu::native
@@ -1,14 +1,18 @@
 #pragma once
 
 #include <cstdint>
+#include <optional>
 #include <string>
 #include <vector>
 
+#include "thread_scheduling.hpp"
+
 namespace thestuu::native {
 
 struct BackendConfig {
   double sampleRate = 48000.0;
   int bufferSize = 256;
+  ThreadSchedulingConfig scheduling;
 };
 
 struct BackendRuntimeInfo {
@@ -61,9 +65,16 @@ struct ClipImportRequest {
   /** Fade curve type: 1=linear, 2=convex, 3=concave, 4=sCurve (tracktion AudioFadeCurve::Type). */
   int fadeInCurve = 1;
   int fadeOutCurve = 1;
+  /** "audio" or "midi". Files with a .mid/.midi extension are always imported as MIDI clips. */
   std::string type;
   /** Start reading the source file from this time in seconds (skip leading silence). If < 0, ignored. */
   double sourceOffsetSeconds = -1.0;
+  /** Audio only: detect leading silence below autoTrimThresholdDb and use it as source offset
+   *  (overrides sourceOffsetSeconds). */
+  bool autoTrim = false;
+  double autoTrimThresholdDb = -60.0;
+  /** MIDI only: plugin UID loaded onto the track when it has no instrument yet (e.g. "internal:ultrasound"). */
+  std::string instrumentUid;
 };
 
 struct ClipImportResult {
@@ -71,6 +82,52 @@ struct ClipImportResult {
   double startBars = 0.0;
   double lengthBars = 0.0;
   std::string sourcePath;
+  std::string type = "audio";
+  /** Tracktion EditItemID of the inserted clip (stable across moves). */
+  uint64_t clipId = 0;
+  /** Audio only: content hash of the source in the shared source pool. */
+  std::string sourceHash;
+  /** Audio only, with autoTrim: detected leading silence (applied as source offset) and trailing silence. */
+  double leadingSilenceSeconds = 0.0;
+  double trailingSilenceSeconds = 0.0;
+  /** MIDI only: number of imported notes and whether an instrument on the track receives them. */
+  int32_t noteCount = 0;
+  bool hasInstrument = false;
+};
+
+/** Progress of an asynchronous vst:load. stage: "queued", "instantiating", "done" or "failed". */
+struct PluginLoadEvent {
+  int64_t loadId = 0;
+  std::string stage;
+  double progress = 0.0;
+  std::string error;
+  LoadPluginResult plugin;
+};
+
+/** A sandboxed plugin's child process exited. status: "restarted" (relaunched; restarts counts the
+ *  relaunches so far) or "bypassed" (gave up; the plugin passes its input through). trackId is 0 for
+ *  plugins outside the user tracks. */
+struct SandboxEvent {
+  int32_t trackId = 0;
+  int32_t pluginIndex = -1;
+  std::string name;
+  std::string status;
+  int32_t restarts = 0;
+};
+
+struct PluginPoolConfig {
+  /** UIDs always kept prewarmed (in addition to built-ins read during vst:scan). */
+  std::vector<std::string> uids;
+  /** Ready instances kept per UID. */
+  int32_t perUid = 1;
+  /** Also prewarm the N most frequently loaded UIDs of this session. */
+  int32_t topN = 3;
+};
+
+struct PluginPoolStats {
+  int32_t perUid = 0;
+  int32_t topN = 0;
+  int32_t pooledInstances = 0;
 };
 
 bool initialiseBackend(const BackendConfig& config, BackendRuntimeInfo& info, std::string& error);
@@ -78,6 +135,23 @@ void shutdownBackend();
 bool resetDefaultEdit(int32_t trackCount, std::string& error);
 bool scanPlugins(std::vector<PluginInfo>& plugins, std::string& error);
 bool loadPlugin(const std::string& pluginUid, int32_t trackId, LoadPluginResult& result, std::string& error);
+/** Load a scanned external plugin into a child process (sandbox). A crash there only affects this plugin:
+ *  the child is relaunched a few times, then the plugin is bypassed (see popSandboxEvent). One block of
+ *  latency is added and reported to delay compensation. Parameters, editor and plugin state are not
+ *  bridged; setPluginParameter and openPluginEditor reject sandboxed plugins. */
+bool loadPluginSandboxed(const std::string& pluginUid, int32_t trackId, LoadPluginResult& result, std::string& error);
+/** Next pending sandbox crash report, if any. Called from the socket loop. */
+bool popSandboxEvent(SandboxEvent& out);
+/** Entry point for `thestuu-native --plugin-host <shm-name> <description.xml>` (sandbox child). */
+int runPluginHost(const std::string& shmName, const std::string& descriptionPath);
+/** Queue a plugin load and return its load id (0 on error). The plugin is built on a loader thread and
+ *  only inserted into the track on the message thread; progress and the result arrive through
+ *  popPluginLoadEvent, so neither the socket nor the message thread blocks on plugin construction. */
+int64_t loadPluginAsync(const std::string& pluginUid, int32_t trackId, std::string& error);
+/** Next pending async load event, if any. Called from the socket loop. */
+bool popPluginLoadEvent(PluginLoadEvent& out);
+/** Set the prewarm pool targets; missing instances are created one at a time on the plugin loader thread. */
+bool configurePluginPool(const PluginPoolConfig& config, PluginPoolStats& stats, std::string& error);
 bool openPluginEditor(int32_t trackId, int32_t pluginIndex, std::string& error);
 bool setPluginParameter(
   int32_t trackId,
@@ -107,16 +181,243 @@ bool setTrackPan(int32_t trackId, double pan, std::string& error);
 /** Set track record arm (trackId 1-based). When armed, track uses default wave input for recording. */
 bool setTrackRecordArm(int32_t trackId, bool armed, std::string& error);
 
+/** One track's mixer state for syncTrackMixer; unset fields are left as they are. */
+struct TrackMixUpdate {
+  int32_t trackId = 0;
+  std::optional<bool> mute;
+  std::optional<bool> solo;
+  std::optional<double> volume;
+  std::optional<double> pan;
+  std::optional<bool> recordArmed;
+};
+
+struct TrackMixSyncResult {
+  int32_t applied = 0;
+  std::vector<int32_t> missingTrackIds;
+};
+
+/** Applies many tracks' mixer state on the message thread; rebuilds the graph once, and only if something changed. */
+bool syncTrackMixer(const std::vector<TrackMixUpdate>& updates, TrackMixSyncResult& result, std::string& error);
+
 /** Removes all audio (wave) clips from all audio tracks. Edit and VSTs are unchanged. Must run on message thread or use clearAllAudioClipsOnMessageThread from other threads. */
 bool clearAllAudioClips(std::string& error);
 /** Same as clearAllAudioClips but runs on the JUCE message thread. */
 bool clearAllAudioClipsOnMessageThread(std::string& error);
 
+/** Content-addressed clip source pool: clips with identical audio share one file, reader and cache. */
+struct SourcePoolStats {
+  int32_t sources = 0;
+  int32_t clips = 0;
+  /** Held decoded in the SampleStore (see cache:stats). */
+  int32_t storedSources = 0;
+  /** Sources that stream through Tracktion's readers (too long for the SampleStore or over its budget). */
+  int32_t mappedSources = 0;
+  /** Imports whose content was already in the pool. */
+  int64_t deduplicatedClips = 0;
+};
+
+bool getSourcePoolStats(SourcePoolStats& stats, std::string& error);
+
+struct SampleCacheStats {
+  int32_t entries = 0;
+  int32_t residentEntries = 0;
+  int64_t residentBytes = 0;
+  int64_t budgetBytes = 0;
+  int64_t maxFileBytes = 0;
+  /** Reads served from RAM vs. streamed from disk (evicted samples). */
+  uint64_t hits = 0;
+  uint64_t misses = 0;
+  uint64_t evictions = 0;
+};
+
+/** RAM sample store limits; a negative value keeps the current setting. Lowering the budget evicts
+ *  least recently used samples to streaming right away. */
+bool configureSampleStore(int64_t maxFileBytes, int64_t budgetBytes, std::string& error);
+bool getSampleCacheStats(SampleCacheStats& stats, std::string& error);
+
+/** Guide/dub alignment of audio clips (Sync button, "Vocal Align" / "Reference Sync"). */
+struct SyncAlignRequest {
+  uint64_t guideClipId = 0;
+  std::vector<uint64_t> targetClipIds;
+  /** Hard limit for every offset; also the search range of the correlation. */
+  double maxShiftMs = 80.0;
+  /** Correlation windows for time-varying offsets. */
+  double windowMs = 2000.0;
+  double hopMs = 500.0;
+  /** Windows below this normalised correlation yield no warp marker. */
+  double minConfidence = 0.3;
+  /** Move each target clip by its overall offset. */
+  bool apply = false;
+};
+
+/** A source moment of the target and the edit time it should sound at to line up with the guide. */
+struct SyncWarpMarker {
+  double sourceSeconds = 0.0;
+  double timelineSeconds = 0.0;
+  /** Positive: the target is late here. */
+  double offsetMs = 0.0;
+  double confidence = 0.0;
+};
+
+struct SyncAlignTarget {
+  uint64_t clipId = 0;
+  bool ok = false;
+  std::string error;
+  /** Positive: the target is late against the guide; apply moves it earlier by this amount. */
+  double offsetMs = 0.0;
+  double confidence = 0.0;
+  bool applied = false;
+  std::vector<SyncWarpMarker> markers;
+};
+
+struct SyncAlignResult {
+  uint64_t guideClipId = 0;
+  std::vector<SyncAlignTarget> targets;
+  double elapsedMs = 0.0;
+};
+
+/** Measures guide/target timing offsets by windowed FFT cross-correlation of onset envelopes, with
+ *  the targets analysed in parallel. Clip positions are read (and, with apply, written) on the message
+ *  thread; the analysis runs on the calling thread and workers. Per-target failures are reported in
+ *  the result; error is set only if the guide cannot be analysed. */
+bool alignClips(const SyncAlignRequest& request, SyncAlignResult& result, std::string& error);
+
+/** audio:loudness. Any mix of source files, wave clips (their played range) and an offline render of
+ *  the whole edit; all sources are measured in parallel. */
+struct LoudnessRequest {
+  std::vector<std::string> paths;
+  std::vector<uint64_t> clipIds;
+  bool renderEdit = false;
+};
+
+/** EBU R128 values; silence and failed sources report -120 (see loudness_meter.hpp). */
+struct LoudnessReport {
+  /** "file", "clip" or "render". */
+  std::string kind;
+  std::string path;
+  uint64_t clipId = 0;
+  bool ok = false;
+  std::string error;
+  double integratedLufs = -120.0;
+  double momentaryMaxLufs = -120.0;
+  double shortTermMaxLufs = -120.0;
+  double loudnessRangeLu = 0.0;
+  double truePeakDbtp = -120.0;
+  double samplePeakDbfs = -120.0;
+  double durationSeconds = 0.0;
+};
+
+/** One report per requested source, in request order (files, clips, render). Per-source failures are
+ *  reported in the entries; error is set only for an invalid request. */
+bool analyseLoudness(const LoudnessRequest& request, std::vector<LoudnessReport>& reports, std::string& error);
+
+struct ClipTransient {
+  double timelineSeconds = 0.0;
+  double sourceSeconds = 0.0;
+  /** Relative to the strongest transient in the clip (0..1]. */
+  double strength = 0.0;
+};
+
+/** Multi-band spectral-flux onsets of the played range of a wave clip (Slice tool). The source is
+ *  streamed on the calling thread; only the clip position is read on the message thread. */
+bool detectClipTransients(
+  uint64_t clipId,
+  double sensitivity,
+  double minGapMs,
+  std::vector<ClipTransient>& transients,
+  std::string& error
+);
+
+/** Splits a clip at the given edit times in one message-thread call. Times outside the clip are
+ *  ignored. clipIds receives the resulting clips in timeline order, the original (left part) first. */
+bool sliceClipAt(uint64_t clipId, const std::vector<double>& timelineSeconds, std::vector<uint64_t>& clipIds, std::string& error);
+
+/** One warp marker: the source moment at sourceSeconds plays at warpSeconds of the clip's content
+ *  time (the time the clip offset is measured in). Instead of warpSeconds, timelineSeconds gives the
+ *  edit time (as returned by sync:align) and is converted with the clip's current position. */
+struct ClipWarpMarker {
+  double sourceSeconds = 0.0;
+  double warpSeconds = -1.0;
+  double timelineSeconds = -1.0;
+};
+
+struct ClipWarpStatus {
+  uint64_t clipId = 0;
+  /** Markers including the start/end markers added at the source edges. */
+  int32_t markerCount = 0;
+  /** false: real-time stretch while markers are edited; true: playing a background-rendered proxy. */
+  bool rendered = false;
+};
+
+/** Replaces the warp markers of a wave clip (empty list = unwarped). The clip plays through a real-time,
+ *  pitch-preserving stretcher (allocated when the graph is built) and switches to a pre-rendered proxy
+ *  once its markers stay unchanged for a few seconds. Markers must increase in source and warp time. */
+bool setClipWarpMarkers(uint64_t clipId, const std::vector<ClipWarpMarker>& markers, ClipWarpStatus& status, std::string& error);
+
+struct TrackListEntry {
+  int32_t trackId = 0;
+  /** Tracktion item ID; stays the same when tracks are added, removed or reordered. */
+  std::string trackUid;
+  std::string name;
+};
+
+/** Current audio tracks (buses excluded) with their 1-based track_id and stable track_uid. */
+bool listTracks(std::vector<TrackListEntry>& tracks, std::string& error);
+/** Current 1-based track_id for a track_uid, or 0 if no such track. */
+int32_t resolveTrackUid(const std::string& trackUid);
+
+//-----------------------------------------------------------------------------
+// Step sequencer patterns (.stu drum patterns rendered natively).
+struct StepPatternStep {
+  int32_t stepIndex = 0;
+  int32_t note = 36;
+  /** 0..1, mapped to MIDI velocity 1..127. */
+  double velocity = 1.0;
+};
+
+struct StepPatternRange {
+  double startBars = 0.0;
+  double lengthBars = 0.0;
+};
+
+struct StepPatternRequest {
+  int32_t trackId = 1;
+  std::string patternId;
+  int32_t lengthSteps = 16;
+  /** Step resolution in beats (0.25 = 1/16 notes). */
+  double stepBeats = 0.25;
+  /** 0..0.95; delays every odd step by swing * stepBeats / 2. */
+  double swing = 0.0;
+  /** Note length as fraction of one step. */
+  double gate = 0.5;
+  std::vector<StepPatternStep> steps;
+  /** Timeline ranges where the pattern loops (playlist clips). Empty = one pass from bar 0 over the edit length. */
+  std::vector<StepPatternRange> ranges;
+  /** Plugin UID loaded onto the track when it has no instrument yet (e.g. "internal:tracktion:sampler"). */
+  std::string instrumentUid;
+};
+
+struct StepPatternResult {
+  int32_t trackId = 0;
+  std::string patternId;
+  int32_t clipCount = 0;
+  /** Notes written across all clips of the pattern. */
+  int32_t noteCount = 0;
+  bool hasInstrument = false;
+};
+
+/** Uploads a step pattern to a track: replaces the pattern's previous clips with looped MIDI clips
+ *  (swing baked into note positions) so steps play sample-accurately from the audio graph. Runs on the message thread. */
+bool setStepPattern(const StepPatternRequest& request, StepPatternResult& result, std::string& error);
+
 struct TransportSnapshot {
   bool playing = false;
   double bpm = 128.0;
   double positionBars = 0.0;
   double positionBeats = 0.0;
+  bool looping = false;
+  double loopStartBeats = 0.0;
+  double loopEndBeats = 0.0;
   int64_t bar = 1;
   int64_t beat = 1;
   int64_t step = 1;
@@ -132,6 +433,191 @@ void transportPause();
 void transportStop();
 void transportSeek(double positionBeats);
 void transportSetBpm(double bpm);
+/** Set (or clear) the edit's loop range in beats. Playback wraps inside the graph; the loop-start
+ *  region of every overlapping wave clip is pre-read into the audio file cache in the background. */
+bool transportSetLoop(bool enabled, double startBeats, double endBeats, std::string& error);
+
+enum class ScrubAction { begin, update, end };
+/** Scrub/jog audition. begin pauses the transport and opens per-clip buffering readers; update pushes
+ *  a target position (and optional velocity in beats/s, 0 = follow the target) through a lock-free FIFO
+ *  to the audio callback without touching the message thread; end stops and leaves the playhead there. */
+bool transportScrub(ScrubAction action, double positionBeats, double velocityBeatsPerSecond, std::string& error);
+
+struct MetronomeSettings {
+  bool enabled = false;
+  /** Click level 0..1 (linear); 0 disables the click. */
+  double level = 0.6;
+  /** Louder click on the first beat of each bar. */
+  bool accentBars = true;
+  /** Count-in before recording: 0, 1 or 2 bars. */
+  int32_t countInBars = 0;
+};
+
+/** Configure the edit's click track. The click is rendered inside the playback graph from preloaded
+ *  samples and follows tempoSequence. \a applied receives the clamped values. */
+bool setMetronome(const MetronomeSettings& settings, MetronomeSettings& applied, std::string& error);
+
+//-----------------------------------------------------------------------------
+// Buses: aux returns (shared effects fed by per-track sends) and submixes. Bus tracks are kept out
+// of the 1-based track_id range; bus_id 0 addresses the master.
+struct BusInfo {
+  int32_t busId = 0;
+  std::string kind;
+  std::string name;
+  int32_t auxBusNumber = -1;
+};
+
+struct TrackSendRequest {
+  int32_t trackId = 1;
+  int32_t busId = 0;
+  double levelDb = 0.0;
+  /** Pre-fader sends sit before the track's volume plugin and shift later plugin indices by one. */
+  bool preFader = false;
+  bool remove = false;
+};
+
+struct TrackSendResult {
+  int32_t trackId = 0;
+  int32_t busId = 0;
+  /** Index of the send in the track's plugin list, -1 after removal. */
+  int32_t pluginIndex = -1;
+  double levelDb = 0.0;
+  bool preFader = false;
+};
+
+/** Create an "aux" (aux return) or "submix" bus routed to the default output. Runs on the message thread. */
+bool createBus(const std::string& kind, const std::string& name, BusInfo& result, std::string& error);
+/** Create, update or remove the send from a track to an aux bus. Runs on the message thread. */
+bool setTrackSend(const TrackSendRequest& request, TrackSendResult& result, std::string& error);
+/** Route a track's output into a bus (busId 0 = back to the default output). Runs on the message thread. */
+bool setTrackOutputBus(int32_t trackId, int32_t busId, std::string& error);
+/** Append a plugin to a bus track or, with busId 0, to the master plugin chain. */
+bool loadBusPlugin(const std::string& pluginUid, int32_t busId, LoadPluginResult& result, std::string& error);
+
+/** FX-chain edits on an existing plugin (pluginIndex as returned by vst:load). The track's own volume
+ *  and meter plugins are refused. All run on the message thread and keep plugin instances alive. */
+bool removePlugin(int32_t trackId, int32_t pluginIndex, std::string& error);
+/** Move a plugin to \a toIndex as a single graph change; plugins in between shift by one. */
+bool movePlugin(int32_t trackId, int32_t fromIndex, int32_t toIndex, std::string& error);
+/** Toggle the plugin's enable state live (no graph rebuild). */
+bool setPluginBypass(int32_t trackId, int32_t pluginIndex, bool bypass, std::string& error);
+
+struct SidechainRequest {
+  int32_t trackId = 1;
+  int32_t pluginIndex = -1;
+  /** 1-based source track; 0 clears the sidechain. */
+  int32_t sourceTrackId = 0;
+  bool preFader = false;
+};
+
+/** Feed another track's output into a plugin's sidechain bus (compressor, gate, external plugins
+ *  with a sidechain input). Pre-fader sources are tapped through a hidden aux bus fed in front of the
+ *  source's fader. Runs on the message thread. */
+bool setPluginSidechain(const SidechainRequest& request, std::string& error);
+
+struct EqualiserSpectrumRequest {
+  int32_t trackId = 1;
+  int32_t pluginIndex = -1;
+  int32_t binCount = 128;
+  double minHz = 20.0;
+  double maxHz = 20000.0;
+};
+
+struct EqualiserSpectrum {
+  double sampleRate = 0.0;
+  /** false: no audio reached the EQ since the previous analysis frame (stopped, bypassed, first poll). */
+  bool live = false;
+  /** binCount log-spaced bands from minHz to maxHz, dB (0 dB = full-scale sine, floor -120). */
+  std::vector<float> preDb;
+  std::vector<float> postDb;
+};
+
+/** Input/output spectrum of a 4-band EQ. Each call keeps the analysis running for two more seconds, so
+ *  poll at the display rate; the first call after a pause starts it and returns the floor. Polling also
+ *  counts as editing the track, which keeps an anticipatively frozen track live. */
+bool getEqualiserSpectrum(const EqualiserSpectrumRequest& request, EqualiserSpectrum& spectrum, std::string& error);
+
+//-----------------------------------------------------------------------------
+// Plugin delay compensation.
+struct PluginLatencyInfo {
+  int32_t pluginIndex = -1;
+  std::string name;
+  double latencySeconds = 0.0;
+  bool enabled = true;
+  /** Disabled by low-latency monitoring (not by the user). */
+  bool lowLatencyBypassed = false;
+};
+
+struct TrackLatencyInfo {
+  int32_t trackId = 0;
+  bool armed = false;
+  /** Sum of the enabled plugins on the track. */
+  double pluginLatencySeconds = 0.0;
+  /** Longest route from the track input to the output: its chain, the buses it feeds through its output
+   *  or aux sends, and the master chain. */
+  double pathLatencySeconds = 0.0;
+  std::vector<PluginLatencyInfo> plugins;
+};
+
+struct LatencyReport {
+  double sampleRate = 0.0;
+  std::vector<TrackLatencyInfo> tracks;
+  std::vector<PluginLatencyInfo> masterPlugins;
+  double masterLatencySeconds = 0.0;
+  /** Longest path; every other path is delayed to match it. */
+  double graphLatencySeconds = 0.0;
+  double outputLatencySeconds = 0.0;
+  double totalLatencySeconds = 0.0;
+  bool lowLatencyMonitoring = false;
+  double lowLatencyThresholdSeconds = 0.0;
+};
+
+/** Per-plugin, per-track and total graph latency. Runs on the message thread. */
+bool getLatencyReport(LatencyReport& report, std::string& error);
+/** While enabled, plugins above \a thresholdSeconds on record-armed tracks are disabled and the graph is
+ *  rebuilt without their latency; disabling (or disarming) restores each to its previous state, except plugins the
+ *  user bypassed or re-enabled in the meantime. A negative threshold keeps the current one. */
+bool setLowLatencyMonitoring(bool enabled, double thresholdSeconds, std::string& error);
+
+//-----------------------------------------------------------------------------
+// Performance stats and idle-track suspension.
+struct TrackPerfInfo {
+  int32_t trackId = 0;
+  /** Not processed: tails decayed and no clip within the lookahead. */
+  bool suspended = false;
+  /** Peak of the last monitor tick (dBFS); only tracked while suspension is enabled. */
+  double peakDb = -100.0;
+};
+
+struct PerfStats {
+  /** Audio callback load 0..1 as measured by the device manager. */
+  double cpuUsage = 0.0;
+  bool suspensionEnabled = false;
+  int32_t suspendedCount = 0;
+  std::vector<TrackPerfInfo> tracks;
+};
+
+/** Enable/disable silence suspension: tracks that are not armed, feed no sidechain, have decayed below
+ *  -80 dBFS for 500 ms and have no clip within \a lookaheadSeconds skip their plugin chain until one is
+ *  near. The skip is a per-block runtime flag: no graph rebuild, nothing saved with the edit. Play and
+ *  seek resume everything first. A non-positive lookahead keeps the current one; others are clamped to
+ *  0.2..10 s, since the wake check runs every 100 ms. */
+bool setTrackSuspension(bool enabled, double lookaheadSeconds, PerfStats& stats, std::string& error);
+bool getPerfStats(PerfStats& stats, std::string& error);
+
+struct IdlePowerStatus {
+  bool enabled = false;
+  double timeoutSeconds = 30.0;
+  bool idle = false;
+};
+
+/** Idle power mode (default off, 30 s): stopped, unarmed and no state-changing requests for the timeout
+ *  detaches the prepared playback graph from the still open audio device; the socket loop then
+ *  throttles ticks. Play and record arm attach it again. A non-positive timeout keeps the current one. */
+bool setIdlePower(bool enabled, double timeoutSeconds, IdlePowerStatus& status, std::string& error);
+/** Called after every successful request that is not a polling query; restarts the idle countdown. */
+void notePowerActivity();
+bool isIdlePowerMode();
 
 /** Process pending JUCE/Tracktion message thread work. Only use when no main-thread message loop is running. */
 void pumpMessageLoop();
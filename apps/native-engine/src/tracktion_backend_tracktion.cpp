@@ -1,4 +1,12 @@
 #include "tracktion_backend.hpp"
+#include "audio_alignment.hpp"
+#include "loudness_meter.hpp"
+#include "plugin_sandbox.hpp"
+#include "sample_store.hpp"
+#include "silence_scan.hpp"
+#include "spectrum_analyser.hpp"
+#include "thread_scheduling.hpp"
+#include "transient_detection.hpp"
 
 #include <algorithm>
 #include <array>
@@ -10,6 +18,7 @@
 #include <cstdint>
 #include <cstdio>
 #include <cstdlib>
+#include <deque>
 #include <iostream>
 #include <memory>
 #include <limits>
@@ -18,6 +27,7 @@
 #include <string>
 #include <thread>
 #include <unordered_map>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 
@@ -27,20 +37,226 @@
 
 namespace thestuu::native {
 
+class ScrubEngine;
+struct LoudnessRender;
+
+struct BusEntry {
+  tracktion::engine::EditItemID trackItemId;
+  std::string kind;
+  std::string name;
+  /** Tracktion aux bus number (0..31) for "aux" buses, -1 for submixes. */
+  int auxBusNumber = -1;
+};
+
+/** Pre-fader sidechain source: a hidden aux bus fed by a send in front of the source track's fader. */
+struct SidechainTap {
+  tracktion::engine::EditItemID sourceTrackId;
+  tracktion::engine::EditItemID tapTrackId;
+  int auxBusNumber = -1;
+};
+
+/** A plugin latency:monitoring disabled, with its enabled state from before. */
+struct LowLatencyBypass {
+  tracktion::engine::EditItemID pluginId;
+  bool wasEnabled = true;
+};
+
+/** Per-track tap on the LevelMeterPlugin's measurer, used to detect decayed tails (silence suspension). */
+struct TrackSilenceMonitor {
+  tracktion::engine::EditItemID trackId;
+  tracktion::engine::LevelMeasurer* measurer = nullptr;
+  tracktion::engine::LevelMeasurer::Client client;
+  int silentTicks = 0;
+  bool suspended = false;
+  double peakDb = -100.0;
+
+  ~TrackSilenceMonitor() {
+    if (measurer != nullptr) {
+      measurer->removeClient(client);
+    }
+  }
+};
+
+/** Audio tracks of the current edit, in edit order and as 1-based track_ids (buses excluded), plus
+ *  itemID -> track_id. Listens to the edit state and is rebuilt lazily on the first lookup after a
+ *  track was added, removed or moved, so per-command lookups no longer walk the edit. Rebuilt and
+ *  read on the message thread only. */
+struct TrackIndexCache final : public juce::ValueTree::Listener {
+  std::mutex mutex;
+  bool valid = false;
+  juce::Array<tracktion::engine::AudioTrack*> allTracks;
+  juce::Array<tracktion::engine::AudioTrack*> userTracks;
+  std::unordered_map<uint64_t, int32_t> trackIdByItemId;
+  juce::ValueTree watched;
+
+  ~TrackIndexCache() override {
+    detach();
+  }
+
+  void attach(const juce::ValueTree& editState) {
+    detach();
+    watched = editState;
+    watched.addListener(this);
+  }
+
+  void detach() {
+    if (watched.isValid()) {
+      watched.removeListener(this);
+    }
+    watched = {};
+    invalidate();
+  }
+
+  void invalidate() {
+    std::lock_guard<std::mutex> lock(mutex);
+    valid = false;
+    allTracks.clear();
+    userTracks.clear();
+    trackIdByItemId.clear();
+  }
+
+  void valueTreeChildAdded(juce::ValueTree&, juce::ValueTree& child) override {
+    if (tracktion::engine::TrackList::isTrack(child)) {
+      invalidate();
+    }
+  }
+
+  void valueTreeChildRemoved(juce::ValueTree&, juce::ValueTree& child, int) override {
+    if (tracktion::engine::TrackList::isTrack(child)) {
+      invalidate();
+    }
+  }
+
+  void valueTreeChildOrderChanged(juce::ValueTree& parent, int, int newIndex) override {
+    if (tracktion::engine::TrackList::isTrack(parent.getChild(newIndex))) {
+      invalidate();
+    }
+  }
+};
+
+/** One unique clip source in the content-addressed pool (see acquirePooledSource). */
+struct PooledSource {
+  /** File every clip with this content points at, so Tracktion's AudioFileCache keeps one reader for it. */
+  juce::File file;
+  /** Decoded into the SampleStore; file is its stub. Otherwise file is the original, which streams. */
+  bool inSampleStore = false;
+  int refCount = 0;
+  double unreferencedSinceMs = 0.0;
+};
+
+struct SourcePool {
+  std::mutex mutex;
+  std::unordered_map<std::string, std::unique_ptr<PooledSource>> byHash;
+  /** "<path>|<size>|<mtime>" -> content hash, so an unchanged file is hashed only once. */
+  std::unordered_map<std::string, std::string> hashByFileKey;
+  std::unordered_map<uint64_t, std::string> hashByClip;
+  int64_t deduplicatedClips = 0;
+};
+
+struct WarpClipState {
+  double lastChangeMs = 0.0;
+  bool rendered = false;
+};
+
 struct BackendState {
   std::unique_ptr<juce::ScopedJuceInitialiser_GUI> juce;
   std::unique_ptr<tracktion::engine::Engine> engine;
   std::unique_ptr<tracktion::engine::Edit> edit;
   double sampleRate = 48000.0;
   int bufferSize = 256;
+  /** Scanned plugin descriptions; the plugin loader thread reads them too, hence the mutex. */
+  std::mutex pluginByUidMutex;
   std::unordered_map<std::string, juce::PluginDescription> pluginByUid;
   std::unordered_map<std::string, std::vector<PluginParameterInfo>> parameterCacheByUid;
+  /** MIDI clips generated by pattern:set, keyed by "<trackItemId>:<patternId>". */
+  std::unordered_map<std::string, std::vector<tracktion::engine::EditItemID>> patternClipsByKey;
+  /** Ready-to-insert plugin instances by UID (see configurePluginPool). poolMutex guards these,
+   *  poolConfig and parameterCacheByUid: sync vst:load runs on the socket thread, async loads and
+   *  refills on the plugin loader thread. Pooled instances are only destroyed on the message thread. */
+  std::mutex poolMutex;
+  std::unordered_map<std::string, std::vector<tracktion::engine::Plugin::Ptr>> prewarmedByUid;
+  std::unordered_map<std::string, int32_t> loadCountByUid;
+  PluginPoolConfig poolConfig;
+  std::atomic<bool> poolRefillPending{false};
+  /** vst:load async progress and sandbox crash reports, drained by the socket loop. */
+  std::mutex loadEventMutex;
+  std::deque<PluginLoadEvent> loadEvents;
+  std::deque<SandboxEvent> sandboxEvents;
+  std::atomic<int64_t> nextLoadId{1};
+  /** Bumped by edit:reset; loads queued against an older edit fail instead of touching the new one. */
+  std::atomic<int64_t> editGeneration{0};
+  /** latency:monitoring. Plugins this mode disabled and the enabled state each had before, so turning
+   *  it off restores exactly that; a plugin the user bypasses meanwhile is dropped from the list. */
+  bool lowLatencyMonitoring = false;
+  double lowLatencyThresholdSeconds = 0.005;
+  /** perf:suspension. Tracks with decayed tails and nothing ahead stop processing until content is near.
+   *  sidechainSources (raw item IDs of tracks some plugin reads as sidechain, directly or through a
+   *  pre-fader tap) is rebuilt whenever sidechain routing changes; message thread only. */
+  bool suspensionEnabled = false;
+  std::unordered_set<uint64_t> sidechainSources;
+  double suspensionLookaheadSeconds = 1.0;
+  std::vector<std::unique_ptr<TrackSilenceMonitor>> silenceMonitors;
+  std::unique_ptr<juce::Timer> suspensionTimer;
+  /** power:idle (off by default). lastActivityMs is written by the socket thread (notePowerActivity);
+   *  idlePower is only set and cleared on the message thread. */
+  bool idlePowerEnabled = false;
+  double idleTimeoutSeconds = 30.0;
+  std::atomic<bool> idlePower{false};
+  std::atomic<double> lastActivityMs{0.0};
+  std::unique_ptr<juce::Timer> idleTimer;
+  /** Policy/priority and CPU masks per thread role (see thread_scheduling.hpp). */
+  ThreadSchedulingConfig scheduling;
+  /** Extra device callback that applies the audio role on the device thread; removed before the engine goes. */
+  std::unique_ptr<juce::AudioIODeviceCallback> audioThreadScheduler;
+  std::vector<LowLatencyBypass> lowLatencyBypassed;
+  /** Aux-return and submix bus tracks (bus:create); bus_id is index + 1. Hidden from the 1-based track_id range. */
+  std::vector<BusEntry> buses;
+  /** Clip sources by content hash, shared by all clips using the same audio. */
+  SourcePool sourcePool;
+  /** clip:set-warp-markers. Last marker change per warped clip (message thread only) and the timer
+   *  that moves settled clips from real-time stretching to a rendered proxy. */
+  std::unordered_map<uint64_t, WarpClipState> warpClips;
+  std::unique_ptr<juce::Timer> warpRenderTimer;
+  /** Short samples decoded into RAM (cache:config); its format is registered with the engine. */
+  std::shared_ptr<SampleStore> sampleStore;
+  /** Sweeps the source pool so unreferenced entries go after the grace period without a stats request. */
+  std::unique_ptr<juce::Timer> sourcePoolTimer;
+  /** Item IDs of tracks idled by refreshDormantTracks (no clips, no plugins, not armed). */
+  std::mutex dormantMutex;
+  std::unordered_set<uint64_t> dormantTracks;
+  /** Track lookups by track_id / track_uid; attached to the current edit in resetDefaultEdit. */
+  TrackIndexCache trackCache;
+  /** Pre-fader sidechain taps (vst:set-sidechain pre_fader) and the silent track they all output into.
+   *  Hidden from bus_id and track_id like the buses. */
+  std::vector<SidechainTap> sidechainTaps;
+  tracktion::engine::EditItemID sidechainSinkId;
+  /** Variable-speed playhead audition (transport.scrub); shared_ptr so the type can stay incomplete here. */
+  std::shared_ptr<ScrubEngine> scrub;
+  /** Offline render of audio:loudness still running (socket thread only); edit:reset waits for it. */
+  std::shared_ptr<LoudnessRender> loudnessRender;
+  /** One thread that builds plugins for vst:load async and pool refills; only the insertion into a
+   *  track runs on the message thread. Declared after the edit so it is drained before the edit goes. */
+  std::unique_ptr<juce::ThreadPool> pluginLoader;
+  /** Background work (cache prefetch etc.). Declared last so it is drained before the edit/engine go away. */
+  std::unique_ptr<juce::ThreadPool> backgroundPool;
 };
 
 std::unique_ptr<BackendState> gState;
 
 tracktion::engine::AudioTrack* getAudioTrackByIndex(int32_t trackId);
+juce::Array<tracktion::engine::AudioTrack*> cachedAudioTracks(tracktion::engine::Edit& edit);
 void transportRebuildGraphOnly();
+void refreshLowLatencyMonitoring();
+void noteTrackEdited(tracktion::engine::AudioTrack& track);
+void resumeSuspendedTracks();
+void refreshDormantTracks();
+void startIdlePowerTimer();
+void leaveIdlePower();
+void startSourcePoolTimer();
+void drainPluginLoader();
+void reportSandboxExit(tracktion::engine::Plugin& plugin, const char* status, int restarts);
+static void runOnMessageThreadAndWait(std::function<void()> fn);
+void waitForLoudnessRender();
 
 namespace {
 
@@ -137,6 +353,166 @@ class UltrasoundPlugin final : public tracktion::engine::FourOscPlugin {
 
 const char* UltrasoundPlugin::xmlTypeName = "ultrasound";
 
+/** Proxy for an external plugin that runs in a `--plugin-host` child process. Audio and MIDI cross
+ *  through shared-memory rings (see plugin_sandbox.hpp); the extra block of latency is reported to
+ *  Tracktion's delay compensation. The child lives as long as the proxy; graph rebuilds only ask it to
+ *  prepare again. A crashed child is relaunched up to kMaxRestarts times, then the proxy passes its
+ *  input through; both are reported as vst:sandbox events. Parameters and plugin state are not bridged. */
+class SandboxedPlugin final : public tracktion::engine::Plugin, private juce::Timer {
+ public:
+  explicit SandboxedPlugin(tracktion::engine::PluginCreationInfo info)
+    : tracktion::engine::Plugin(std::move(info)) {}
+
+  ~SandboxedPlugin() override {
+    stopTimer();
+    notifyListenersOfDeletion();
+    bridge.stop();
+  }
+
+  static const char* getPluginName() {
+    return NEEDS_TRANS("Sandboxed Plugin");
+  }
+
+  static const char* xmlTypeName;
+  static constexpr int kMaxRestarts = 3;
+  static inline const juce::Identifier descriptionId{"sandboxDescription"};
+  static inline const juce::Identifier nameId{"sandboxName"};
+  static inline const juce::Identifier instrumentId{"sandboxIsInstrument"};
+
+  juce::String getName() const override {
+    const auto name = state[nameId].toString();
+    return name.isNotEmpty() ? name : TRANS("Sandboxed Plugin");
+  }
+
+  juce::String getPluginType() override {
+    return xmlTypeName;
+  }
+
+  juce::String getSelectableDescription() override {
+    return getName() + " (sandbox)";
+  }
+
+  bool takesMidiInput() override {
+    return true;
+  }
+
+  bool isSynth() override {
+    return static_cast<bool>(state[instrumentId]);
+  }
+
+  bool producesAudioWhenNoAudioInput() override {
+    return isSynth();
+  }
+
+  int getNumOutputChannelsGivenInputs(int) override {
+    return thestuu::native::sandbox::kMaxChannels;
+  }
+
+  double getLatencySeconds() override {
+    return currentSampleRate > 0.0 ? static_cast<double>(bridge.getLatencySamples()) / currentSampleRate : 0.0;
+  }
+
+  void initialise(const tracktion::engine::PluginInitialisationInfo& info) override {
+    currentSampleRate = info.sampleRate;
+    // Room for a full MIDI ring of short messages (time stamp + size + 3 bytes each), so addEvent
+    // never allocates on the audio thread.
+    midiScratch.ensureSize(thestuu::native::sandbox::kMidiRingEvents * (sizeof(int32_t) + sizeof(uint16_t) + 3));
+    std::string error;
+    if (bridge.isStarted()) {
+      if (!bridge.prepare(info.sampleRate, info.blockSizeSamples, error)) {
+        std::fprintf(stderr, "[thestuu-native] %s\n", error.c_str());
+      }
+      return;
+    }
+    juce::PluginDescription description;
+    const auto xml = juce::parseXML(state[descriptionId].toString());
+    if (xml == nullptr || !description.loadFromXml(*xml)) {
+      std::fprintf(stderr, "[thestuu-native] sandbox: missing plugin description\n");
+    } else if (!bridge.start(description, info.sampleRate, info.blockSizeSamples, error)) {
+      std::fprintf(stderr, "[thestuu-native] %s\n", error.c_str());
+    } else {
+      startTimer(1000);
+    }
+  }
+
+  /** The child keeps running between graph rebuilds; only the destructor stops it. */
+  void deinitialise() override {}
+
+  void applyToBuffer(const tracktion::engine::PluginRenderContext& fc) override {
+    if (fc.destBuffer == nullptr) {
+      return;
+    }
+    midiScratch.clear();
+    if (fc.bufferForMidiMessages != nullptr) {
+      int events = 0;
+      for (auto& message : *fc.bufferForMidiMessages) {
+        // The bridge drops sysex and anything beyond one ring anyway.
+        if (message.getRawDataSize() > 3 || events >= static_cast<int>(thestuu::native::sandbox::kMidiRingEvents)) {
+          continue;
+        }
+        ++events;
+        const int position = juce::jlimit(
+          0,
+          std::max(0, fc.bufferNumSamples - 1),
+          static_cast<int>(message.getTimeStamp() * currentSampleRate)
+        );
+        midiScratch.addEvent(message, position);
+      }
+    }
+    bridge.process(*fc.destBuffer, fc.bufferStartSample, fc.bufferNumSamples, midiScratch);
+  }
+
+ private:
+  void timerCallback() override {
+    if (bridge.isChildRunning()) {
+      return;
+    }
+    std::string error;
+    if (restarts < kMaxRestarts && bridge.restartChild(error)) {
+      ++restarts;
+      std::fprintf(stderr, "[thestuu-native] sandbox: %s exited; restarted (%d/%d)\n", getName().toRawUTF8(), restarts, kMaxRestarts);
+      reportSandboxExit(*this, "restarted", restarts);
+      return;
+    }
+    stopTimer();
+    bridge.setBypassed(true);
+    std::fprintf(stderr, "[thestuu-native] sandbox: %s exited; bypassed\n", getName().toRawUTF8());
+    reportSandboxExit(*this, "bypassed", restarts);
+  }
+
+  thestuu::native::sandbox::SandboxBridge bridge;
+  juce::MidiBuffer midiScratch;
+  double currentSampleRate = 0.0;
+  int restarts = 0;
+};
+
+const char* SandboxedPlugin::xmlTypeName = "stuuSandbox";
+
+/** Tracktion's 4-band EQ with a pre/post spectrum tap for its editor and eq:spectrum. Created in place of
+ *  EqualiserPlugin by NativeEngineBehaviour, so the "4bandEq" type and saved state stay the same. */
+class AnalysedEqualiserPlugin final : public tracktion::engine::EqualiserPlugin {
+ public:
+  using tracktion::engine::EqualiserPlugin::EqualiserPlugin;
+
+  void initialise(const tracktion::engine::PluginInitialisationInfo& info) override {
+    tracktion::engine::EqualiserPlugin::initialise(info);
+    analyser.setSampleRate(info.sampleRate);
+  }
+
+  void applyToBuffer(const tracktion::engine::PluginRenderContext& fc) override {
+    const bool tap = fc.destBuffer != nullptr && analyser.isWatched();
+    if (tap) {
+      analyser.pushPre(*fc.destBuffer, fc.bufferStartSample, fc.bufferNumSamples);
+    }
+    tracktion::engine::EqualiserPlugin::applyToBuffer(fc);
+    if (tap) {
+      analyser.pushPost(*fc.destBuffer, fc.bufferStartSample, fc.bufferNumSamples);
+    }
+  }
+
+  thestuu::native::SpectrumAnalyser analyser;
+};
+
 #if JUCE_LINUX
 constexpr bool kShouldAddPluginWindowToDesktop = false;
 #else
@@ -178,10 +554,12 @@ juce::String buildPlainLanguageHint(const tracktion::engine::AutomatableParamete
 
 class EqualiserFallbackEditor final : public tracktion::engine::Plugin::EditorComponent,
                                       private juce::AsyncUpdater,
+                                      private juce::Timer,
                                       private tracktion::engine::AutomatableParameter::Listener {
  public:
   explicit EqualiserFallbackEditor(tracktion::engine::EqualiserPlugin& pluginToControl)
     : equaliser(pluginToControl),
+      analyser(spectrumAnalyserFor(pluginToControl)),
       bands({
         Band{pluginToControl.loFreq, pluginToControl.loGain, pluginToControl.loQ, "Low", juce::Colour(0xFF5FE28A)},
         Band{pluginToControl.midFreq1, pluginToControl.midGain1, pluginToControl.midQ1, "Mid 1", juce::Colour(0xFF74C0FF)},
@@ -209,9 +587,14 @@ class EqualiserFallbackEditor final : public tracktion::engine::Plugin::EditorCo
 
     setSize(820, 560);
     updateInfoLabel();
+    if (analyser != nullptr) {
+      analyser->keepAlive();
+      startTimerHz(thestuu::native::SpectrumAnalyser::kFramesPerSecond);
+    }
   }
 
   ~EqualiserFallbackEditor() override {
+    stopTimer();
     cancelPendingUpdate();
     for (auto& band : bands) {
       if (band.freq != nullptr) band.freq->removeListener(this);
@@ -241,6 +624,7 @@ class EqualiserFallbackEditor final : public tracktion::engine::Plugin::EditorCo
     ));
     g.fillAll();
     drawGraphBackground(g, graphBounds);
+    drawSpectrum(g, graphBounds);
     drawResponseCurve(g, graphBounds);
     drawBandNodes(g, graphBounds);
   }
@@ -312,6 +696,14 @@ class EqualiserFallbackEditor final : public tracktion::engine::Plugin::EditorCo
   static constexpr float kMaxFreq = 20000.0F;
   static constexpr float kMinGain = -20.0F;
   static constexpr float kMaxGain = 20.0F;
+  /** The spectrum overlay has its own level scale, independent of the gain axis. */
+  static constexpr float kSpectrumTopDb = 0.0F;
+  static constexpr float kSpectrumBottomDb = -90.0F;
+
+  static thestuu::native::SpectrumAnalyser* spectrumAnalyserFor(tracktion::engine::EqualiserPlugin& plugin) {
+    auto* analysed = dynamic_cast<AnalysedEqualiserPlugin*>(&plugin);
+    return analysed != nullptr ? &analysed->analyser : nullptr;
+  }
 
   static juce::String formatFrequency(float hz) {
     if (hz >= 1000.0F) {
@@ -453,6 +845,48 @@ class EqualiserFallbackEditor final : public tracktion::engine::Plugin::EditorCo
     }
   }
 
+  float spectrumLevelToY(float db, const juce::Rectangle<float>& graph) const {
+    const float clamped = juce::jlimit(kSpectrumBottomDb, kSpectrumTopDb, db);
+    const float norm = (kSpectrumTopDb - clamped) / (kSpectrumTopDb - kSpectrumBottomDb);
+    return graph.getY() + (norm * graph.getHeight());
+  }
+
+  /** Input (grey) and output (green) of the EQ behind the response curve, one band per 3 px. */
+  void drawSpectrum(juce::Graphics& g, const juce::Rectangle<float>& graph) {
+    if (analyser == nullptr || graph.getWidth() <= 2.0F || graph.getHeight() <= 2.0F) return;
+    const int binCount = std::max(2, juce::roundToInt(graph.getWidth() / 3.0F));
+    analyser->getLogBins(binCount, kMinFreq, kMaxFreq, spectrumPre, spectrumPost);
+
+    const auto spectrumPath = [&](const std::vector<float>& levels) {
+      juce::Path path;
+      for (int i = 0; i < binCount; ++i) {
+        const float x = graph.getX() + ((static_cast<float>(i) + 0.5F) * graph.getWidth() / static_cast<float>(binCount));
+        const float y = spectrumLevelToY(levels[static_cast<size_t>(i)], graph);
+        if (i == 0) path.startNewSubPath(graph.getX(), y);
+        path.lineTo(x, y);
+      }
+      path.lineTo(graph.getRight(), spectrumLevelToY(levels.back(), graph));
+      return path;
+    };
+    const auto closedBelow = [&](juce::Path path) {
+      path.lineTo(graph.getRight(), graph.getBottom());
+      path.lineTo(graph.getX(), graph.getBottom());
+      path.closeSubPath();
+      return path;
+    };
+
+    juce::Graphics::ScopedSaveState saveState(g);
+    g.reduceClipRegion(graph.toNearestInt());
+    g.setColour(juce::Colour(0x16FFFFFF));
+    g.fillPath(closedBelow(spectrumPath(spectrumPre)));
+
+    const auto post = spectrumPath(spectrumPost);
+    g.setColour(juce::Colour(0x265FE28A));
+    g.fillPath(closedBelow(post));
+    g.setColour(juce::Colour(0x885FE28A));
+    g.strokePath(post, juce::PathStrokeType(1.0F));
+  }
+
   void drawResponseCurve(juce::Graphics& g, const juce::Rectangle<float>& graph) {
     if (graph.getWidth() <= 2.0F || graph.getHeight() <= 2.0F) return;
     juce::Path path;
@@ -517,11 +951,26 @@ class EqualiserFallbackEditor final : public tracktion::engine::Plugin::EditorCo
     repaint();
   }
 
+  void timerCallback() override {
+    analyser->keepAlive();
+    if (analyser->hasSignal() || !spectrumSettled) {
+      repaint(graphBounds.toNearestInt());
+    }
+    // After the audio stops, keep repainting until the released levels have left the display.
+    spectrumSettled = !analyser->hasSignal() && !spectrumPost.empty()
+      && std::all_of(spectrumPost.begin(), spectrumPost.end(), [](float db) { return db <= kSpectrumBottomDb; })
+      && std::all_of(spectrumPre.begin(), spectrumPre.end(), [](float db) { return db <= kSpectrumBottomDb; });
+  }
+
   void curveHasChanged(tracktion::engine::AutomatableParameter&) override {}
   void currentValueChanged(tracktion::engine::AutomatableParameter&) override { triggerAsyncUpdate(); }
   void parameterChanged(tracktion::engine::AutomatableParameter&, float) override { triggerAsyncUpdate(); }
 
   tracktion::engine::EqualiserPlugin& equaliser;
+  thestuu::native::SpectrumAnalyser* analyser = nullptr;
+  std::vector<float> spectrumPre;
+  std::vector<float> spectrumPost;
+  bool spectrumSettled = false;
   std::array<Band, 4> bands;
   juce::Label titleLabel;
   juce::Label subtitleLabel;
@@ -856,6 +1305,23 @@ class NativeUIBehaviour final : public tracktion::engine::UIBehaviour {
   }
 };
 
+/** Lets the node player spread independent track/bus branches over more cores than Tracktion's
+ *  default (half the CPUs); one core is left free for the message and socket threads. Also swaps in
+ *  the spectrum-tapped 4-band EQ. */
+class NativeEngineBehaviour final : public tracktion::engine::EngineBehaviour {
+ public:
+  int getNumberOfCPUsToUseForAudio() override {
+    return std::max(1, juce::SystemStats::getNumCpus() - 1);
+  }
+
+  tracktion::engine::Plugin::Ptr createCustomPlugin(tracktion::engine::PluginCreationInfo info) override {
+    if (info.state[tracktion::engine::IDs::type].toString() == tracktion::engine::EqualiserPlugin::xmlTypeName) {
+      return new AnalysedEqualiserPlugin(std::move(info));
+    }
+    return {};
+  }
+};
+
 bool parseIntStrict(const std::string& text, int32_t& value) {
   if (text.empty()) {
     return false;
@@ -908,6 +1374,10 @@ bool openPluginEditorImpl(int32_t trackId, int32_t pluginIndex, std::string& err
     error = "plugin not found on track";
     return false;
   }
+  if (dynamic_cast<SandboxedPlugin*>(plugin) != nullptr) {
+    error = "the editor of sandboxed plugins is not bridged";
+    return false;
+  }
 
   plugin->showWindowExplicitly();
   if (plugin->windowState != nullptr && plugin->windowState->isWindowShowing()) {
@@ -932,8 +1402,21 @@ bool createDefaultEdit(int32_t trackCount, std::string& error) {
     return false;
   }
 
-  nextEdit->ensureNumberOfAudioTracks(safeTrackCount);
-  const auto tracks = tracktion::engine::getAudioTracks(*nextEdit);
+  // Bulk creation: each track goes in right after the previous one, whereas ensureNumberOfAudioTracks
+  // searches the whole track list per insert (quadratic for 1000-track templates). The edit is not live
+  // yet, so nothing rebuilds in between; the undo history of the setup is dropped at the end.
+  auto tracks = tracktion::engine::getAudioTracks(*nextEdit);
+  tracks.ensureStorageAllocated(safeTrackCount);
+  tracktion::engine::Track* preceding = tracktion::engine::getAllTracks(*nextEdit).getLast();
+  while (tracks.size() < safeTrackCount) {
+    auto track = nextEdit->insertNewAudioTrack(tracktion::engine::TrackInsertPoint(nullptr, preceding), nullptr);
+    if (track == nullptr) {
+      error = "failed to create track " + std::to_string(tracks.size() + 1);
+      return false;
+    }
+    preceding = track.get();
+    tracks.add(track.get());
+  }
   const juce::String defaultOutId = nextEdit->engine.getDeviceManager().getDefaultWaveOutDeviceID();
   for (int i = 0; i < static_cast<int>(tracks.size()); ++i) {
     if (auto* track = tracks[i]) {
@@ -952,7 +1435,15 @@ bool createDefaultEdit(int32_t trackCount, std::string& error) {
     }
   }
 
+  nextEdit->getUndoManager().clearUndoHistory();
+
+  gState->trackCache.detach();
+  {
+    std::lock_guard<std::mutex> lock(gState->dormantMutex);
+    gState->dormantTracks.clear();
+  }
   gState->edit = std::move(nextEdit);
+  gState->trackCache.attach(gState->edit->state);
   // Do not call ensureContextAllocated here – it must run on the message thread (in transportPlay).
   error.clear();
   return true;
@@ -1047,7 +1538,48 @@ std::vector<PluginParameterInfo> collectAudioProcessorParameters(juce::AudioPlug
   return parameters;
 }
 
+/** Takes a prewarmed instance for \a uid out of the pool, or nullptr. */
+tracktion::engine::Plugin::Ptr takePrewarmedPlugin(const std::string& uid) {
+  std::lock_guard<std::mutex> lock(gState->poolMutex);
+  auto found = gState->prewarmedByUid.find(uid);
+  if (found == gState->prewarmedByUid.end() || found->second.empty()) {
+    return nullptr;
+  }
+  auto plugin = found->second.back();
+  found->second.pop_back();
+  return plugin;
+}
+
+/** Keeps \a plugin as a prewarmed instance if the pool for \a uid is below its target. */
+bool offerPrewarmedPlugin(const std::string& uid, const tracktion::engine::Plugin::Ptr& plugin) {
+  std::lock_guard<std::mutex> lock(gState->poolMutex);
+  auto& pooled = gState->prewarmedByUid[uid];
+  if (static_cast<int32_t>(pooled.size()) >= gState->poolConfig.perUid) {
+    return false;
+  }
+  pooled.push_back(plugin);
+  return true;
+}
+
+/** Looks at a pooled instance if there is one, so scans need no throwaway instance. */
+bool peekPrewarmedParameters(const std::string& uid, std::vector<PluginParameterInfo>& parameters) {
+  std::lock_guard<std::mutex> lock(gState->poolMutex);
+  auto found = gState->prewarmedByUid.find(uid);
+  if (found == gState->prewarmedByUid.end() || found->second.empty()) {
+    return false;
+  }
+  parameters = collectAutomatableParameters(*found->second.back());
+  return true;
+}
+
+void cacheParameters(const std::string& uid, const std::vector<PluginParameterInfo>& parameters) {
+  std::lock_guard<std::mutex> lock(gState->poolMutex);
+  gState->parameterCacheByUid[uid] = parameters;
+}
+
+/** Parameter list of a built-in plugin. The instance used to read it goes into the prewarm pool. */
 std::vector<PluginParameterInfo> collectBuiltInPluginParameters(
+  const std::string& uid,
   const juce::String& typeName,
   const juce::PluginDescription& description
 ) {
@@ -1055,26 +1587,21 @@ std::vector<PluginParameterInfo> collectBuiltInPluginParameters(
   if (!gState || !gState->engine || !gState->edit) {
     return parameters;
   }
+  if (peekPrewarmedParameters(uid, parameters)) {
+    return parameters;
+  }
 
-  if (auto plugin = gState->engine->getPluginManager().createNewPlugin(*gState->edit, typeName, description)) {
+  if (auto plugin = gState->edit->getPluginCache().createNewPlugin(typeName, description)) {
     parameters = collectAutomatableParameters(*plugin);
+    offerPrewarmedPlugin(uid, plugin);
   }
 
   return parameters;
 }
 
 std::vector<PluginParameterInfo> collectUltrasoundParameters() {
-  std::vector<PluginParameterInfo> parameters;
-  if (!gState || !gState->engine || !gState->edit) {
-    return parameters;
-  }
-
   juce::PluginDescription ignored;
-  if (auto plugin = gState->engine->getPluginManager().createNewPlugin(*gState->edit, UltrasoundPlugin::xmlTypeName, ignored)) {
-    parameters = collectAutomatableParameters(*plugin);
-  }
-
-  return parameters;
+  return collectBuiltInPluginParameters(kUltrasoundUid, UltrasoundPlugin::xmlTypeName, ignored);
 }
 
 bool findPluginDescriptionByUid(const std::string& pluginUid, juce::PluginDescription& result) {
@@ -1082,16 +1609,20 @@ bool findPluginDescriptionByUid(const std::string& pluginUid, juce::PluginDescri
     return false;
   }
 
-  const auto cached = gState->pluginByUid.find(pluginUid);
-  if (cached != gState->pluginByUid.end()) {
-    result = cached->second;
-    return true;
+  {
+    std::lock_guard<std::mutex> lock(gState->pluginByUidMutex);
+    const auto cached = gState->pluginByUid.find(pluginUid);
+    if (cached != gState->pluginByUid.end()) {
+      result = cached->second;
+      return true;
+    }
   }
 
   const auto known = gState->engine->getPluginManager().knownPluginList.getTypes();
   for (const auto& desc : known) {
     if (desc.createIdentifierString().toStdString() == pluginUid || desc.matchesIdentifierString(pluginUid)) {
       result = desc;
+      std::lock_guard<std::mutex> lock(gState->pluginByUidMutex);
       gState->pluginByUid.emplace(pluginUid, desc);
       return true;
     }
@@ -1186,23 +1717,131 @@ void appendTracktionCorePluginInfos(std::vector<PluginInfo>& plugins) {
     info.isInstrument = spec.isInstrument;
     info.isNative = true;
     const auto description = createTracktionCorePluginDescription(spec);
-    info.parameters = collectBuiltInPluginParameters(spec.xmlTypeName, description);
-    gState->parameterCacheByUid[info.uid] = info.parameters;
+    info.parameters = collectBuiltInPluginParameters(spec.uid, spec.xmlTypeName, description);
+    cacheParameters(info.uid, info.parameters);
     plugins.push_back(std::move(info));
   }
 }
 }  // namespace
 
+/** Message thread: the bus and sidechain tap lists are only changed there. */
+bool isBusTrack(const tracktion::engine::Track& track) {
+  if (!gState) {
+    return false;
+  }
+  for (const auto& bus : gState->buses) {
+    if (bus.trackItemId == track.itemID) {
+      return true;
+    }
+  }
+  for (const auto& tap : gState->sidechainTaps) {
+    if (tap.tapTrackId == track.itemID) {
+      return true;
+    }
+  }
+  return gState->sidechainSinkId.isValid() && gState->sidechainSinkId == track.itemID;
+}
+
+namespace {
+
+bool isMessageThread() {
+  auto* mm = juce::MessageManager::getInstance();
+  return mm != nullptr && mm->isThisTheMessageThread();
+}
+
+/** Message thread; caller holds trackCache.mutex. isBusTrack reads the bus and sidechain tap lists,
+ *  which only the message thread changes. */
+void rebuildTrackCacheLocked(TrackIndexCache& cache) {
+  cache.allTracks = tracktion::engine::getAudioTracks(*gState->edit);
+  cache.userTracks.clearQuick();
+  cache.trackIdByItemId.clear();
+  for (auto* track : cache.allTracks) {
+    if (track == nullptr || isBusTrack(*track)) {
+      continue;
+    }
+    cache.userTracks.add(track);
+    cache.trackIdByItemId[track->itemID.getRawID()] = cache.userTracks.size();
+  }
+  cache.valid = true;
+}
+
+/** Message thread. Locks the track cache, rebuilding it first if a track change invalidated it. */
+std::unique_lock<std::mutex> lockValidTrackCache() {
+  auto& cache = gState->trackCache;
+  std::unique_lock<std::mutex> lock(cache.mutex);
+  if (!cache.valid) {
+    rebuildTrackCacheLocked(cache);
+  }
+  return lock;
+}
+
+}  // namespace
+
+// The lookups below hop to the message thread when called from elsewhere: it owns the track list and
+// the bus bookkeeping, and cached pointers are only resolved there.
+
 tracktion::engine::AudioTrack* getAudioTrackByIndex(int32_t trackId) {
   if (!gState || !gState->edit || trackId < 1) {
     return nullptr;
   }
-  auto tracks = tracktion::engine::getAudioTracks(*gState->edit);
-  const int index = trackId - 1;
-  if (index < 0 || index >= tracks.size()) {
-    return nullptr;
+  if (!isMessageThread()) {
+    tracktion::engine::AudioTrack* track = nullptr;
+    runOnMessageThreadAndWait([&track, trackId]() { track = getAudioTrackByIndex(trackId); });
+    return track;
+  }
+  const auto lock = lockValidTrackCache();
+  const auto& cache = gState->trackCache;
+  return trackId <= cache.userTracks.size() ? cache.userTracks.getUnchecked(trackId - 1) : nullptr;
+}
+
+juce::Array<tracktion::engine::AudioTrack*> cachedAudioTracks(tracktion::engine::Edit& edit) {
+  if (!isMessageThread()) {
+    juce::Array<tracktion::engine::AudioTrack*> tracks;
+    runOnMessageThreadAndWait([&tracks, &edit]() { tracks = cachedAudioTracks(edit); });
+    return tracks;
+  }
+  if (!gState || gState->edit.get() != &edit) {
+    return tracktion::engine::getAudioTracks(edit);
+  }
+  const auto lock = lockValidTrackCache();
+  return gState->trackCache.allTracks;
+}
+
+int32_t resolveTrackUid(const std::string& trackUid) {
+  if (!gState || !gState->edit || trackUid.empty()) {
+    return 0;
+  }
+  if (!isMessageThread()) {
+    int32_t trackId = 0;
+    runOnMessageThreadAndWait([&trackId, &trackUid]() { trackId = resolveTrackUid(trackUid); });
+    return trackId;
+  }
+  const auto itemId = tracktion::engine::EditItemID::fromVar(juce::var(juce::String(trackUid)));
+  const auto lock = lockValidTrackCache();
+  const auto& byItemId = gState->trackCache.trackIdByItemId;
+  const auto it = byItemId.find(itemId.getRawID());
+  return it != byItemId.end() ? it->second : 0;
+}
+
+bool listTracks(std::vector<TrackListEntry>& tracks, std::string& error) {
+  tracks.clear();
+  if (!isInitialised(error) || !requireEdit(error)) {
+    return false;
   }
-  return tracks[index];
+  runOnMessageThreadAndWait([&tracks]() {
+    if (!gState || !gState->edit) {
+      return;
+    }
+    const auto lock = lockValidTrackCache();
+    const auto& userTracks = gState->trackCache.userTracks;
+    tracks.reserve(static_cast<size_t>(userTracks.size()));
+    for (int i = 0; i < userTracks.size(); ++i) {
+      auto* track = userTracks.getUnchecked(i);
+      tracks.push_back({i + 1, track->itemID.toString().toStdString(), track->getName().toStdString()});
+    }
+  });
+  error.clear();
+  return true;
 }
 
 bool setTrackMute(int32_t trackId, bool mute, std::string& error) {
@@ -1281,28 +1920,99 @@ bool setTrackRecordArm(int32_t trackId, bool armed, std::string& error) {
     error = "track_id out of range";
     return false;
   }
+  noteTrackEdited(*track);
+  if (armed) {
+    // Input monitoring needs the graph attached to the device again.
+    runOnMessageThreadAndWait([]() { leaveIdlePower(); });
+  }
   track->getWaveInputDevice().setEnabled(armed);
+  if (gState->lowLatencyMonitoring) {
+    refreshLowLatencyMonitoring();  // rebuilds the graph itself
+    return true;
+  }
   transportRebuildGraphOnly();
   return true;
 }
 
+/** Silent device callback next to Tracktion's: the first block on a new device thread applies the
+ *  audio scheduling role to it. That happens once per device (re)start, not per block. */
+class AudioThreadScheduler final : public juce::AudioIODeviceCallback {
+ public:
+  AudioThreadScheduler(juce::AudioDeviceManager& managerToUse, const ThreadSchedulingConfig& config)
+      : manager(managerToUse), policy(config.policy), priority(config.audioPriority), cpus(config.audioCpus) {
+    manager.addAudioCallback(this);
+  }
+
+  ~AudioThreadScheduler() override {
+    manager.removeAudioCallback(this);
+  }
+
+  void audioDeviceIOCallbackWithContext(
+    const float* const*,
+    int,
+    float* const* outputChannelData,
+    int numOutputChannels,
+    int numSamples,
+    const juce::AudioIODeviceCallbackContext&
+  ) override {
+    for (int ch = 0; ch < numOutputChannels; ++ch) {
+      if (outputChannelData[ch] != nullptr) {
+        juce::FloatVectorOperations::clear(outputChannelData[ch], numSamples);
+      }
+    }
+    const pthread_t self = pthread_self();
+    if (!hasThread || !pthread_equal(self, lastThread)) {
+      hasThread = true;
+      lastThread = self;
+      const auto state = applyCurrentThreadScheduling("audio", policy, priority, cpus);
+      if (!state.error.empty()) {
+        std::fprintf(stderr, "[thestuu-native] audio thread scheduling: %s\n", state.error.c_str());
+      }
+    }
+  }
+
+  void audioDeviceAboutToStart(juce::AudioIODevice*) override {}
+  void audioDeviceStopped() override {}
+
+ private:
+  juce::AudioDeviceManager& manager;
+  const std::string policy;
+  const int priority;
+  const std::vector<int> cpus;
+  bool hasThread = false;
+  pthread_t lastThread{};
+};
+
 bool initialiseBackend(const BackendConfig& config, BackendRuntimeInfo& info, std::string& error) {
   try {
     gState = std::make_unique<BackendState>();
     gState->sampleRate = std::isfinite(config.sampleRate) && config.sampleRate > 0.0 ? config.sampleRate : 48000.0;
     gState->bufferSize = config.bufferSize > 0 ? config.bufferSize : 256;
+    gState->scheduling = config.scheduling;
+    // initialiseBackend runs on the thread that becomes the JUCE message thread.
+    applyCurrentThreadScheduling("message", "other", 0, config.scheduling.messageCpus);
 
     gState->juce = std::make_unique<juce::ScopedJuceInitialiser_GUI>();
     gState->engine = std::make_unique<tracktion::engine::Engine>(
       "TheStuuNative",
       std::make_unique<NativeUIBehaviour>(),
-      nullptr
+      std::make_unique<NativeEngineBehaviour>()
     );
     gState->engine->getPluginManager().setUsesSeparateProcessForScanning(false);
     gState->engine->getPluginManager().createBuiltInType<UltrasoundPlugin>();
+    gState->engine->getPluginManager().createBuiltInType<SandboxedPlugin>();
+    gState->backgroundPool = std::make_unique<juce::ThreadPool>(2);
+    auto& readFormats = gState->engine->getAudioFileFormatManager().readFormatManager;
+    gState->sampleStore = std::make_shared<SampleStore>(readFormats);
+    readFormats.registerFormat(gState->sampleStore->createFormat().release(), false);
+    gState->pluginLoader = std::make_unique<juce::ThreadPool>(1);
 
     auto& deviceManager = gState->engine->getDeviceManager();
     deviceManager.initialise(2, 2);
+    gState->audioThreadScheduler =
+      std::make_unique<AudioThreadScheduler>(deviceManager.deviceManager, gState->scheduling);
+    startIdlePowerTimer();
+    startSourcePoolTimer();
 
     // Do not create an edit here: the device list is not ready yet (Rebuilding Wave Device List
     // runs later), so tracks would get output device null and be excluded from the playback graph.
@@ -1328,6 +2038,10 @@ bool initialiseBackend(const BackendConfig& config, BackendRuntimeInfo& info, st
 }
 
 void shutdownBackend() {
+  if (gState) {
+    // Loader jobs use gState; let the running one finish while it is still valid.
+    gState->pluginLoader.reset();
+  }
   gState.reset();
 }
 
@@ -1338,10 +2052,35 @@ bool resetDefaultEdit(int32_t trackCount, std::string& error) {
 
   try {
     const int32_t safeTrackCount = trackCount > 0 ? trackCount : kDefaultTrackCount;
+    gState->scrub.reset();
+    gState->silenceMonitors.clear();  // detach from the old edit's level meters
+    // Loads still queued fail once they see the new generation; wait until the loader has passed them.
+    ++gState->editGeneration;
+    drainPluginLoader();
+    waitForLoudnessRender();
+    runOnMessageThreadAndWait([]() {
+      // Pooled instances belong to the old edit's plugin cache.
+      std::lock_guard<std::mutex> lock(gState->poolMutex);
+      gState->prewarmedByUid.clear();
+    });
     if (!createDefaultEditOnMessageThread(safeTrackCount, error)) {
       return false;
     }
-    gState->parameterCacheByUid.clear();
+    {
+      std::lock_guard<std::mutex> lock(gState->poolMutex);
+      gState->parameterCacheByUid.clear();
+    }
+    gState->patternClipsByKey.clear();
+    runOnMessageThreadAndWait([]() {
+      // Bus bookkeeping and the track cache are read by message-thread lookups (isBusTrack).
+      gState->buses.clear();
+      gState->sidechainTaps.clear();
+      gState->sidechainSinkId = {};
+      gState->sidechainSources.clear();
+      gState->trackCache.invalidate();
+      gState->lowLatencyBypassed.clear();
+      gState->warpClips.clear();
+    });
     error.clear();
     return true;
   } catch (const std::exception& ex) {
@@ -1364,8 +2103,14 @@ bool scanPlugins(std::vector<PluginInfo>& plugins, std::string& error) {
       return false;
     }
 
-    gState->pluginByUid.clear();
-    gState->parameterCacheByUid.clear();
+    {
+      std::lock_guard<std::mutex> lock(gState->pluginByUidMutex);
+      gState->pluginByUid.clear();
+    }
+    {
+      std::lock_guard<std::mutex> lock(gState->poolMutex);
+      gState->parameterCacheByUid.clear();
+    }
 
     const auto known = gState->engine->getPluginManager().knownPluginList.getTypes();
     plugins.reserve(static_cast<size_t>(known.size() + kTracktionCorePluginSpecs.size() + 1));
@@ -1378,7 +2123,10 @@ bool scanPlugins(std::vector<PluginInfo>& plugins, std::string& error) {
       info.isInstrument = desc.isInstrument;
       info.kind = info.isInstrument ? "instrument" : "effect";
       info.isNative = false;
-      gState->pluginByUid.emplace(info.uid, desc);
+      {
+        std::lock_guard<std::mutex> lock(gState->pluginByUidMutex);
+        gState->pluginByUid.emplace(info.uid, desc);
+      }
 
       juce::String createError;
       if (auto instance = gState->engine->getPluginManager().createPluginInstance(
@@ -1390,14 +2138,14 @@ bool scanPlugins(std::vector<PluginInfo>& plugins, std::string& error) {
         info.parameters = collectAudioProcessorParameters(*instance);
       }
 
-      gState->parameterCacheByUid[info.uid] = info.parameters;
+      cacheParameters(info.uid, info.parameters);
       plugins.push_back(std::move(info));
     }
 
     appendTracktionCorePluginInfos(plugins);
 
     auto ultrasound = makeUltrasoundInfo();
-    gState->parameterCacheByUid[ultrasound.uid] = ultrasound.parameters;
+    cacheParameters(ultrasound.uid, ultrasound.parameters);
     plugins.push_back(std::move(ultrasound));
 
     error.clear();
@@ -1413,78 +2161,124 @@ bool scanPlugins(std::vector<PluginInfo>& plugins, std::string& error) {
   }
 }
 
-bool loadPlugin(const std::string& pluginUid, int32_t trackId, LoadPluginResult& result, std::string& error) {
-  result = {};
+namespace {
 
-  if (!isInitialised(error)) {
-    return false;
-  }
-  if (!requireEdit(error)) {
-    return false;
-  }
+struct CreatedPlugin {
+  tracktion::engine::Plugin::Ptr plugin;
+  std::string uid;
+  std::string type = "unknown";
+  bool isInstrument = false;
+  bool isNative = false;
+};
 
-  try {
-    auto* track = getAudioTrackByIndex(trackId);
-    if (track == nullptr) {
-      error = "track_id out of range";
-      return false;
-    }
+/** Instantiates a plugin by UID (Ultrasound, Tracktion core plugin or scanned external plugin) without inserting it.
+ *  With \a usePool a prewarmed instance is taken when available and the load counts towards the pool's top-N. */
+bool createPluginForUid(const std::string& pluginUid, CreatedPlugin& created, std::string& error, bool usePool = true) {
+  created = {};
+  created.uid = pluginUid;
 
-    tracktion::engine::Plugin::Ptr plugin;
-    std::string resolvedUid = pluginUid;
-    std::string resolvedType = "unknown";
-    bool resolvedIsInstrument = false;
-    bool resolvedIsNative = false;
-
-    if (pluginUid == kUltrasoundUid || juce::String::fromUTF8(pluginUid.c_str()).equalsIgnoreCase("ultrasound")) {
+  if (pluginUid == kUltrasoundUid || juce::String::fromUTF8(pluginUid.c_str()).equalsIgnoreCase("ultrasound")) {
+    created.uid = kUltrasoundUid;
+    created.plugin = usePool ? takePrewarmedPlugin(created.uid) : nullptr;
+    if (created.plugin == nullptr) {
       juce::PluginDescription ignored;
-      plugin = gState->edit->getPluginCache().createNewPlugin(UltrasoundPlugin::xmlTypeName, ignored);
-      resolvedUid = kUltrasoundUid;
-      resolvedType = tracktion::engine::PluginManager::builtInPluginFormatName;
-      resolvedIsInstrument = true;
-      resolvedIsNative = true;
-    } else if (const auto* tracktionCorePlugin = findTracktionCorePluginSpecByUid(pluginUid)) {
+      created.plugin = gState->edit->getPluginCache().createNewPlugin(UltrasoundPlugin::xmlTypeName, ignored);
+    }
+    created.type = tracktion::engine::PluginManager::builtInPluginFormatName;
+    created.isInstrument = true;
+    created.isNative = true;
+  } else if (const auto* tracktionCorePlugin = findTracktionCorePluginSpecByUid(pluginUid)) {
+    created.uid = tracktionCorePlugin->uid;
+    created.plugin = usePool ? takePrewarmedPlugin(created.uid) : nullptr;
+    if (created.plugin == nullptr) {
       const auto description = createTracktionCorePluginDescription(*tracktionCorePlugin);
-      plugin = gState->edit->getPluginCache().createNewPlugin(tracktionCorePlugin->xmlTypeName, description);
-      resolvedUid = tracktionCorePlugin->uid;
-      resolvedType = tracktion::engine::PluginManager::builtInPluginFormatName;
-      resolvedIsInstrument = tracktionCorePlugin->isInstrument;
-      resolvedIsNative = true;
-    } else {
-      juce::PluginDescription desc;
-      if (!findPluginDescriptionByUid(pluginUid, desc)) {
-        error = "VST not found: " + pluginUid;
-        return false;
-      }
+      created.plugin = gState->edit->getPluginCache().createNewPlugin(tracktionCorePlugin->xmlTypeName, description);
+    }
+    created.type = tracktion::engine::PluginManager::builtInPluginFormatName;
+    created.isInstrument = tracktionCorePlugin->isInstrument;
+    created.isNative = true;
+  } else {
+    juce::PluginDescription desc;
+    if (!findPluginDescriptionByUid(pluginUid, desc)) {
+      error = "VST not found: " + pluginUid;
+      return false;
+    }
 
-      plugin = gState->edit->getPluginCache().createNewPlugin(tracktion::engine::ExternalPlugin::xmlTypeName, desc);
-      resolvedType = desc.pluginFormatName.toStdString();
-      resolvedIsInstrument = desc.isInstrument;
-      resolvedIsNative = false;
+    created.plugin = usePool ? takePrewarmedPlugin(pluginUid) : nullptr;
+    if (created.plugin == nullptr) {
+      created.plugin = gState->edit->getPluginCache().createNewPlugin(tracktion::engine::ExternalPlugin::xmlTypeName, desc);
     }
+    created.type = desc.pluginFormatName.toStdString();
+    created.isInstrument = desc.isInstrument;
+    created.isNative = false;
+  }
 
-    if (plugin == nullptr) {
-      error = "failed to create plugin instance";
+  if (created.plugin == nullptr) {
+    error = "failed to create plugin instance";
+    return false;
+  }
+  if (usePool) {
+    std::lock_guard<std::mutex> lock(gState->poolMutex);
+    ++gState->loadCountByUid[created.uid];
+  }
+  return true;
+}
+
+/** Appends \a created to \a list and fills \a result (trackId is left to the caller). */
+bool appendCreatedPlugin(
+  tracktion::engine::PluginList& list,
+  const CreatedPlugin& created,
+  LoadPluginResult& result,
+  std::string& error
+) {
+  list.insertPlugin(created.plugin, list.size(), nullptr);
+  const int pluginIndex = list.indexOf(created.plugin.get());
+  if (pluginIndex < 0) {
+    error = "failed to insert plugin into track";
+    return false;
+  }
+
+  result.pluginIndex = pluginIndex;
+  result.name = created.plugin->getName().toStdString();
+  result.uid = created.uid;
+  result.type = created.type;
+  result.isInstrument = created.isInstrument;
+  result.kind = result.isInstrument ? "instrument" : "effect";
+  result.isNative = created.isNative;
+  result.parameters = collectAutomatableParameters(*created.plugin);
+  cacheParameters(result.uid, result.parameters);
+  return true;
+}
+
+}  // namespace
+
+bool loadPlugin(const std::string& pluginUid, int32_t trackId, LoadPluginResult& result, std::string& error) {
+  result = {};
+
+  if (!isInitialised(error)) {
+    return false;
+  }
+  if (!requireEdit(error)) {
+    return false;
+  }
+
+  try {
+    auto* track = getAudioTrackByIndex(trackId);
+    if (track == nullptr) {
+      error = "track_id out of range";
       return false;
     }
+    noteTrackEdited(*track);
 
-    track->pluginList.insertPlugin(plugin, track->pluginList.size(), nullptr);
-    const int pluginIndex = track->pluginList.indexOf(plugin.get());
-    if (pluginIndex < 0) {
-      error = "failed to insert plugin into track";
+    CreatedPlugin created;
+    if (!createPluginForUid(pluginUid, created, error)) {
+      return false;
+    }
+    if (!appendCreatedPlugin(track->pluginList, created, result, error)) {
+      result = {};
       return false;
     }
-
     result.trackId = trackId;
-    result.pluginIndex = pluginIndex;
-    result.name = plugin->getName().toStdString();
-    result.uid = resolvedUid;
-    result.type = resolvedType;
-    result.isInstrument = resolvedIsInstrument;
-    result.kind = result.isInstrument ? "instrument" : "effect";
-    result.isNative = resolvedIsNative;
-    result.parameters = collectAutomatableParameters(*plugin);
-    gState->parameterCacheByUid[result.uid] = result.parameters;
 
     error.clear();
     return true;
@@ -1499,6 +2293,101 @@ bool loadPlugin(const std::string& pluginUid, int32_t trackId, LoadPluginResult&
   }
 }
 
+bool loadPluginSandboxed(const std::string& pluginUid, int32_t trackId, LoadPluginResult& result, std::string& error) {
+  result = {};
+
+  if (!isInitialised(error)) {
+    return false;
+  }
+  if (!requireEdit(error)) {
+    return false;
+  }
+
+  try {
+    auto* track = getAudioTrackByIndex(trackId);
+    if (track == nullptr) {
+      error = "track_id out of range";
+      return false;
+    }
+    noteTrackEdited(*track);
+
+    juce::PluginDescription desc;
+    if (!findPluginDescriptionByUid(pluginUid, desc)) {
+      error = "sandbox supports scanned external plugins only: " + pluginUid;
+      return false;
+    }
+    auto xml = desc.createXml();
+    if (xml == nullptr) {
+      error = "failed to serialise plugin description";
+      return false;
+    }
+
+    CreatedPlugin created;
+    created.plugin = gState->edit->getPluginCache().createNewPlugin(SandboxedPlugin::xmlTypeName, desc);
+    if (created.plugin == nullptr) {
+      error = "failed to create sandbox proxy";
+      return false;
+    }
+    created.plugin->state.setProperty(SandboxedPlugin::descriptionId, xml->toString(), nullptr);
+    created.plugin->state.setProperty(SandboxedPlugin::nameId, desc.name, nullptr);
+    created.plugin->state.setProperty(SandboxedPlugin::instrumentId, desc.isInstrument, nullptr);
+    created.uid = pluginUid;
+    created.type = desc.pluginFormatName.toStdString();
+    created.isInstrument = desc.isInstrument;
+    created.isNative = false;
+
+    if (!appendCreatedPlugin(track->pluginList, created, result, error)) {
+      result = {};
+      return false;
+    }
+    result.trackId = trackId;
+
+    error.clear();
+    return true;
+  } catch (const std::exception& ex) {
+    error = ex.what();
+    result = {};
+    return false;
+  } catch (...) {
+    error = "unknown error during vst:load (sandbox)";
+    result = {};
+    return false;
+  }
+}
+
+void reportSandboxExit(tracktion::engine::Plugin& plugin, const char* status, int restarts) {
+  if (!gState) {
+    return;
+  }
+  SandboxEvent event;
+  event.name = plugin.getName().toStdString();
+  event.status = status;
+  event.restarts = restarts;
+  if (auto* track = dynamic_cast<tracktion::engine::AudioTrack*>(plugin.getOwnerTrack()); track != nullptr && gState->edit) {
+    event.trackId = cachedAudioTracks(*gState->edit).indexOf(track) + 1;
+    event.pluginIndex = track->pluginList.indexOf(&plugin);
+  }
+  std::lock_guard<std::mutex> lock(gState->loadEventMutex);
+  gState->sandboxEvents.push_back(std::move(event));
+}
+
+bool popSandboxEvent(SandboxEvent& out) {
+  if (!gState) {
+    return false;
+  }
+  std::lock_guard<std::mutex> lock(gState->loadEventMutex);
+  if (gState->sandboxEvents.empty()) {
+    return false;
+  }
+  out = std::move(gState->sandboxEvents.front());
+  gState->sandboxEvents.pop_front();
+  return true;
+}
+
+int runPluginHost(const std::string& shmName, const std::string& descriptionPath) {
+  return sandbox::runPluginHostProcess(shmName, descriptionPath);
+}
+
 bool openPluginEditor(int32_t trackId, int32_t pluginIndex, std::string& error) {
   error.clear();
 
@@ -1564,6 +2453,7 @@ bool setPluginParameter(
       error = "track_id out of range";
       return false;
     }
+    noteTrackEdited(*track);
 
     if (pluginIndex < 0 || pluginIndex >= track->pluginList.size()) {
       error = "plugin_index out of range";
@@ -1575,6 +2465,10 @@ bool setPluginParameter(
       error = "plugin not found on track";
       return false;
     }
+    if (dynamic_cast<SandboxedPlugin*>(plugin) != nullptr) {
+      error = "parameters of sandboxed plugins are not bridged";
+      return false;
+    }
 
     auto* parameter = findParameter(*plugin, paramId);
     if (parameter == nullptr) {
@@ -1599,48 +2493,182 @@ bool setPluginParameter(
   }
 }
 
-bool importClipFile(const ClipImportRequest& request, ClipImportResult& result, std::string& error) {
-  result = {};
+namespace {
 
-  if (!isInitialised(error)) {
+struct ParsedMidiNote {
+  int pitch = 60;
+  int velocity = 100;
+  double startBeats = 0.0;
+  double lengthBeats = 0.25;
+};
+
+struct ParsedMidiController {
+  int controller = 0;
+  int value = 0;
+  double beat = 0.0;
+};
+
+/** Note/controller data of a Standard MIDI File, in beats relative to the file start. SMPTE files
+ *  carry seconds in the beat fields (inSeconds) until applyMidiTempo() maps them on the message thread. */
+struct ParsedMidiFile {
+  std::vector<ParsedMidiNote> notes;
+  std::vector<ParsedMidiController> controllers;
+  double lengthBeats = 0.0;
+  bool inSeconds = false;
+};
+
+bool isMidiImportRequest(const ClipImportRequest& request) {
+  if (juce::String::fromUTF8(request.type.c_str()).equalsIgnoreCase("midi")) {
+    return true;
+  }
+  const auto extension = juce::File(request.sourcePath).getFileExtension().toLowerCase();
+  return extension == ".mid" || extension == ".midi";
+}
+
+/** Parses a .mid file into beat-based events. Pure file I/O, safe to run off the message thread;
+ *  it does not touch the edit. */
+bool parseMidiFile(const juce::File& sourceFile, ParsedMidiFile& parsed, std::string& error) {
+  parsed = {};
+  juce::FileInputStream fileStream(sourceFile);
+  if (!fileStream.openedOk()) {
+    error = "failed to open midi file";
     return false;
   }
-  if (!requireEdit(error)) {
+  juce::BufferedInputStream stream(fileStream, 8192);
+  juce::MidiFile midiFile;
+  if (!midiFile.readFrom(stream, true)) {
+    error = "invalid midi file";
     return false;
   }
 
-  if (request.sourcePath.empty()) {
-    error = "source_path is required";
-    return false;
+  const short timeFormat = midiFile.getTimeFormat();
+  double ticksToBeats = 1.0;
+  if (timeFormat > 0) {
+    ticksToBeats = 1.0 / static_cast<double>(timeFormat);
+  } else {
+    // SMPTE time base: timestamps become seconds; applyMidiTempo() maps them to beats.
+    midiFile.convertTimestampTicksToSeconds();
+    parsed.inSeconds = true;
   }
 
-  auto* track = getAudioTrackByIndex(request.trackId);
-  if (track == nullptr) {
-    error = "track_id out of range";
-    return false;
+  for (int t = 0; t < midiFile.getNumTracks(); ++t) {
+    const auto* sequence = midiFile.getTrack(t);
+    if (sequence == nullptr) {
+      continue;
+    }
+    for (int i = 0; i < sequence->getNumEvents(); ++i) {
+      const auto* holder = sequence->getEventPointer(i);
+      const auto& message = holder->message;
+      const double beat = std::max(0.0, message.getTimeStamp() * ticksToBeats);
+      if (message.isNoteOn()) {
+        double endBeat = beat + 0.25;
+        if (holder->noteOffObject != nullptr) {
+          endBeat = std::max(beat, holder->noteOffObject->message.getTimeStamp() * ticksToBeats);
+        }
+        ParsedMidiNote note;
+        note.pitch = message.getNoteNumber();
+        note.velocity = std::max<int>(1, message.getVelocity());
+        note.startBeats = beat;
+        note.lengthBeats = std::max(1.0 / 256.0, endBeat - beat);
+        parsed.notes.push_back(note);
+        parsed.lengthBeats = std::max(parsed.lengthBeats, endBeat);
+      } else if (message.isController()) {
+        parsed.controllers.push_back({message.getControllerNumber(), message.getControllerValue(), beat});
+        parsed.lengthBeats = std::max(parsed.lengthBeats, beat);
+      }
+    }
   }
 
-  juce::File sourceFile(request.sourcePath);
-  if (!sourceFile.existsAsFile()) {
-    error = "source file not found";
+  error.clear();
+  return true;
+}
+
+/** Maps the seconds of an SMPTE file to beats at the edit tempo. Must run on the message thread. */
+void applyMidiTempo(ParsedMidiFile& parsed) {
+  if (!parsed.inSeconds) {
+    return;
+  }
+  double bpm = 128.0;
+  if (gState && gState->edit) {
+    bpm = gState->edit->tempoSequence.getBpmAt(tracktion::core::TimePosition::fromSeconds(0.0));
+  }
+  const double secondsToBeats = std::max(1.0, bpm) / 60.0;
+  for (auto& note : parsed.notes) {
+    note.startBeats *= secondsToBeats;
+    note.lengthBeats = std::max(1.0 / 256.0, note.lengthBeats * secondsToBeats);
+  }
+  for (auto& controller : parsed.controllers) {
+    controller.beat *= secondsToBeats;
+  }
+  parsed.lengthBeats *= secondsToBeats;
+  parsed.inSeconds = false;
+}
+
+bool trackHasInstrument(tracktion::engine::AudioTrack& track) {
+  for (auto* plugin : track.pluginList) {
+    if (plugin != nullptr && plugin->isSynth()) {
+      return true;
+    }
+  }
+  return false;
+}
+
+/** Opens sourceFile and measures its leading and trailing silence (see silence_scan.hpp). */
+bool scanSilence(const juce::File& sourceFile, double thresholdDb, SilenceScan& scan, std::string& error) {
+  scan = {};
+  auto& formats = gState->engine->getAudioFileFormatManager().readFormatManager;
+  std::unique_ptr<juce::AudioFormatReader> reader(formats.createReaderFor(sourceFile));
+  if (reader == nullptr || reader->sampleRate <= 0.0 || reader->numChannels == 0) {
+    error = "unsupported audio file";
+    return false;
+  }
+  if (!thestuu::native::scanSilence(*reader, thresholdDb, scan)) {
+    error = "failed to read audio file";
     return false;
   }
+  return true;
+}
 
-  tracktion::core::TimeRange clipRange;
-  double resultStartBars = 0.0;
-  double resultLengthBars = 0.0;
+/** Resolves request.autoTrim into a plain source offset. */
+bool resolveAutoTrim(const ClipImportRequest& request, ClipImportRequest& trimmed, SilenceScan& scan, std::string& error) {
+  trimmed = request;
+  trimmed.autoTrim = false;
+  scan = {};
+  if (!request.autoTrim || isMidiImportRequest(request)) {
+    return true;
+  }
+  const juce::File sourceFile(request.sourcePath);
+  if (request.sourcePath.empty() || !sourceFile.existsAsFile()) {
+    return true;  // reported by the import itself
+  }
+  if (!scanSilence(sourceFile, request.autoTrimThresholdDb, scan, error)) {
+    return false;
+  }
+  trimmed.sourceOffsetSeconds = scan.leadingSeconds;
+  std::fprintf(stderr, "[thestuu-native] auto trim %s: leading %.3fs trailing %.3fs\n",
+               sourceFile.getFileName().toRawUTF8(), scan.leadingSeconds, scan.trailingSeconds);
+  return true;
+}
 
+/** Resolves bar/second placement of an imported clip against the edit tempo. */
+void resolveClipPlacement(
+  const ClipImportRequest& request,
+  double defaultLengthBars,
+  double& startBars,
+  double& lengthBars,
+  tracktion::core::TimeRange& clipRange
+) {
   // Prefer bars so clip position uses the edit’s tempo (avoids BPM mismatch with engine).
   const double beatsPerBar = estimateBeatsPerBar();
   double bpm = 128.0;
   if (gState && gState->edit) {
     bpm = gState->edit->tempoSequence.getBpmAt(tracktion::core::TimePosition::fromSeconds(0.0));
   }
-  double startBars = request.startBars >= 0.0 ? request.startBars : 0.0;
-  double lengthBars = request.lengthBars > 0.0 ? request.lengthBars : 1.0;
+  startBars = request.startBars >= 0.0 ? request.startBars : 0.0;
+  lengthBars = request.lengthBars > 0.0 ? request.lengthBars : defaultLengthBars;
   if (request.lengthBars <= 0.0 && request.lengthSeconds > 0.0 && bpm > 0.0 && beatsPerBar > 0.0) {
     lengthBars = (request.lengthSeconds * bpm) / (60.0 * beatsPerBar);
-    if (lengthBars <= 0.0) lengthBars = 1.0;
+    if (lengthBars <= 0.0) lengthBars = defaultLengthBars;
   }
   if (request.startBars < 0.0 && request.startSeconds >= 0.0 && bpm > 0.0 && beatsPerBar > 0.0) {
     startBars = (request.startSeconds * bpm) / (60.0 * beatsPerBar);
@@ -1648,85 +2676,427 @@ bool importClipFile(const ClipImportRequest& request, ClipImportResult& result,
   }
   const double startBeats = startBars * beatsPerBar;
   const double lengthBeats = lengthBars * beatsPerBar;
-  const auto startTime = convertBeatsToTime(startBeats);
-  const auto endTime = convertBeatsToTime(startBeats + lengthBeats);
-  clipRange = tracktion::core::TimeRange(startTime, endTime);
-  resultStartBars = startBars;
-  resultLengthBars = lengthBars;
-  const double fileOffsetSec = (request.sourceOffsetSeconds >= 0.0) ? request.sourceOffsetSeconds : 0.0;
-  std::fprintf(stderr, "[thestuu-native] clip import track %d at %.2f bars (%.3fs) length %.2f bars offset %.2fs\n",
-               static_cast<int>(request.trackId), startBars, startTime.inSeconds(), lengthBars, fileOffsetSec);
+  clipRange = tracktion::core::TimeRange(convertBeatsToTime(startBeats), convertBeatsToTime(startBeats + lengthBeats));
+}
 
-  const tracktion::engine::ClipPosition position{clipRange, tracktion::core::TimeDuration::fromSeconds(fileOffsetSec)};
+bool parseMidiFileForImport(const ClipImportRequest& request, ParsedMidiFile& parsed, std::string& error) {
+  if (request.sourcePath.empty()) {
+    error = "source_path is required";
+    return false;
+  }
+  const juce::File sourceFile(request.sourcePath);
+  if (!sourceFile.existsAsFile()) {
+    error = "source file not found";
+    return false;
+  }
+  return parseMidiFile(sourceFile, parsed, error);
+}
+
+/** Inserts a MIDI clip from pre-parsed data. Must run on the message thread. */
+bool importMidiClip(
+  const ClipImportRequest& request,
+  ParsedMidiFile parsed,
+  ClipImportResult& result,
+  std::string& error
+) {
+  result = {};
+
+  if (!isInitialised(error)) {
+    return false;
+  }
+  if (!requireEdit(error)) {
+    return false;
+  }
+
+  auto* track = getAudioTrackByIndex(request.trackId);
+  if (track == nullptr) {
+    error = "track_id out of range";
+    return false;
+  }
+  noteTrackEdited(*track);
+  applyMidiTempo(parsed);
+
+  const double beatsPerBar = estimateBeatsPerBar();
+  const double fileLengthBars = std::max(1.0, std::ceil(parsed.lengthBeats / std::max(1.0, beatsPerBar)));
+  double startBars = 0.0;
+  double lengthBars = 0.0;
+  tracktion::core::TimeRange clipRange;
+  resolveClipPlacement(request, fileLengthBars, startBars, lengthBars, clipRange);
 
-  auto clip = track->insertWaveClip(sourceFile.getFileNameWithoutExtension(), sourceFile, position, false);
+  const juce::File sourceFile(request.sourcePath);
+  auto clip = track->insertMIDIClip(sourceFile.getFileNameWithoutExtension(), clipRange, nullptr);
   if (clip == nullptr) {
-    error = "failed to insert clip";
+    error = "failed to insert midi clip";
     return false;
   }
-  // Play from source file directly for all formats (WAV, MP3, FLAC, OGG, AAC, AIFF, etc.) without
-  // proxy so behaviour is identical and playback works regardless of Tracktion’s needsCachedProxy.
-  clip->setUsesProxy(false);
 
-  if (request.fadeInSeconds > 0.0 || request.fadeOutSeconds > 0.0) {
-    if (auto* acb = dynamic_cast<tracktion::engine::AudioClipBase*>(clip.get())) {
-      if (request.fadeInSeconds > 0.0) {
-        acb->setFadeIn(tracktion::core::TimeDuration::fromSeconds(request.fadeInSeconds));
-      }
-      if (request.fadeOutSeconds > 0.0) {
-        acb->setFadeOut(tracktion::core::TimeDuration::fromSeconds(request.fadeOutSeconds));
-      }
-      const int inCurve = (request.fadeInCurve >= 1 && request.fadeInCurve <= 4) ? request.fadeInCurve : 1;
-      const int outCurve = (request.fadeOutCurve >= 1 && request.fadeOutCurve <= 4) ? request.fadeOutCurve : 1;
-      acb->setFadeInType(static_cast<tracktion::engine::AudioFadeCurve::Type>(inCurve));
-      acb->setFadeOutType(static_cast<tracktion::engine::AudioFadeCurve::Type>(outCurve));
+  // Notes live in the clip's MidiList and are rendered sample-accurately by the playback graph,
+  // so no per-note IPC is needed after import.
+  auto& sequence = clip->getSequence();
+  for (const auto& note : parsed.notes) {
+    sequence.addNote(
+      note.pitch,
+      tracktion::core::BeatPosition::fromBeats(note.startBeats),
+      tracktion::core::BeatDuration::fromBeats(note.lengthBeats),
+      note.velocity,
+      0,
+      nullptr
+    );
+  }
+  for (const auto& controller : parsed.controllers) {
+    // MidiList stores controller values with 14-bit resolution.
+    sequence.addControllerEvent(
+      tracktion::core::BeatPosition::fromBeats(controller.beat),
+      controller.controller,
+      controller.value << 7,
+      nullptr
+    );
+  }
+
+  bool hasInstrument = trackHasInstrument(*track);
+  if (!hasInstrument && !request.instrumentUid.empty()) {
+    LoadPluginResult instrument;
+    std::string instrumentError;
+    if (loadPlugin(request.instrumentUid, request.trackId, instrument, instrumentError)) {
+      hasInstrument = instrument.isInstrument;
+    } else {
+      std::fprintf(stderr, "[thestuu-native] midi import: instrument %s not loaded: %s\n",
+                   request.instrumentUid.c_str(), instrumentError.c_str());
     }
   }
 
+  std::fprintf(stderr, "[thestuu-native] midi clip import track %d at %.2f bars length %.2f bars notes %d instrument=%d\n",
+               static_cast<int>(request.trackId), startBars, lengthBars, static_cast<int>(parsed.notes.size()),
+               hasInstrument ? 1 : 0);
+
   result.trackId = request.trackId;
-  result.startBars = resultStartBars;
-  result.lengthBars = resultLengthBars;
+  result.startBars = startBars;
+  result.lengthBars = lengthBars;
   result.sourcePath = request.sourcePath;
+  result.type = "midi";
+  result.clipId = clip->itemID.getRawID();
+  result.noteCount = static_cast<int32_t>(parsed.notes.size());
+  result.hasInstrument = hasInstrument;
   error.clear();
   return true;
 }
 
-bool importClipFileOnMessageThread(const ClipImportRequest& request, ClipImportResult& result, std::string& error) {
-  result = {};
-  error.clear();
-  auto* mm = juce::MessageManager::getInstance();
-  if (mm && mm->isThisTheMessageThread()) {
-    return importClipFile(request, result, error);
-  }
-  if (!mm) {
-    error = "JUCE MessageManager not available";
-    return false;
+constexpr double kSourceEvictAfterMs = 30000.0;
+constexpr int kSourcePoolSweepMs = 5000;
+
+/** 128-bit content hash (two independent 64-bit FNV-1a lanes over the whole file, plus the size).
+ *  Not cryptographic; it only has to tell different audio files apart. */
+std::string contentHash(const juce::File& file) {
+  juce::FileInputStream stream(file);
+  if (!stream.openedOk()) {
+    return {};
   }
-  std::mutex mtx;
-  std::condition_variable cv;
-  std::atomic<bool> done{false};
-  bool ok = false;
-  mm->callAsync([&]() {
-    ok = importClipFile(request, result, error);
-    {
-      std::lock_guard<std::mutex> lock(mtx);
-      done = true;
+  uint64_t a = 14695981039346656037ull;
+  uint64_t b = 0x9e3779b97f4a7c15ull;
+  std::vector<uint8_t> chunk(1 << 16);
+  for (;;) {
+    const int read = stream.read(chunk.data(), static_cast<int>(chunk.size()));
+    if (read <= 0) {
+      break;
     }
-    cv.notify_one();
-  });
-  std::unique_lock<std::mutex> lock(mtx);
-  cv.wait_for(lock, std::chrono::seconds(10), [&]() { return done.load(); });
-  return ok;
+    for (int i = 0; i < read; ++i) {
+      a = (a ^ chunk[static_cast<size_t>(i)]) * 1099511628211ull;
+      b = (b ^ chunk[static_cast<size_t>(i)]) * 0x100000001b3ull;
+      b = (b << 7) | (b >> 57);
+    }
+  }
+  return juce::String::toHexString(static_cast<juce::int64>(a)).paddedLeft('0', 16).toStdString()
+    + juce::String::toHexString(static_cast<juce::int64>(b)).paddedLeft('0', 16).toStdString()
+    + "-" + std::to_string(file.getSize());
 }
 
-bool clearAllAudioClips(std::string& error) {
-  error.clear();
-  if (!gState || !gState->edit) {
-    error = "backend not initialised";
-    return false;
+juce::File sourcePoolDirectory() {
+  return juce::File::getSpecialLocation(juce::File::tempDirectory).getChildFile("thestuu-source-pool");
+}
+
+/** Returns the pooled file to reference for source, registering the content on first use. Short sources
+ *  are decoded into the SampleStore under its global budget; the rest stream through Tracktion's readers.
+ *  reused is set when the content was already pooled. */
+juce::File acquirePooledSource(const juce::File& source, std::string& hash, bool& reused) {
+  reused = false;
+  auto& pool = gState->sourcePool;
+  const std::string fileKey = source.getFullPathName().toStdString() + "|" + std::to_string(source.getSize()) + "|"
+    + std::to_string(source.getLastModificationTime().toMilliseconds());
+  {
+    std::lock_guard<std::mutex> lock(pool.mutex);
+    const auto known = pool.hashByFileKey.find(fileKey);
+    if (known != pool.hashByFileKey.end()) {
+      hash = known->second;
+      const auto it = pool.byHash.find(hash);
+      if (it != pool.byHash.end()) {
+        reused = true;
+        return it->second->file;
+      }
+    }
   }
-  try {
-    const auto tracks = tracktion::engine::getAudioTracks(*gState->edit);
+  if (hash.empty()) {
+    hash = contentHash(source);
+    if (hash.empty()) {
+      return source;
+    }
+  }
+  {
+    std::lock_guard<std::mutex> lock(pool.mutex);
+    pool.hashByFileKey[fileKey] = hash;
+    const auto it = pool.byHash.find(hash);
+    if (it != pool.byHash.end()) {
+      reused = true;
+      return it->second->file;
+    }
+  }
+
+  auto entry = std::make_unique<PooledSource>();
+  entry->file = source;
+  if (gState->sampleStore != nullptr) {
+    const auto stub = gState->sampleStore->admit(hash, source, sourcePoolDirectory());
+    if (stub != juce::File()) {
+      entry->file = stub;
+      entry->inSampleStore = true;
+    }
+  }
+
+  std::lock_guard<std::mutex> lock(pool.mutex);
+  auto& slot = pool.byHash[hash];
+  if (slot == nullptr) {
+    slot = std::move(entry);
+  } else {
+    reused = true;
+  }
+  return slot->file;
+}
+
+void attachClipToSource(uint64_t clipId, const std::string& hash, bool deduplicated) {
+  auto& pool = gState->sourcePool;
+  std::lock_guard<std::mutex> lock(pool.mutex);
+  pool.hashByClip[clipId] = hash;
+  if (const auto it = pool.byHash.find(hash); it != pool.byHash.end()) {
+    ++it->second->refCount;
+  }
+  pool.deduplicatedClips += deduplicated ? 1 : 0;
+}
+
+/** Recounts references from the clips still in the edit. Entries unreferenced for kSourceEvictAfterMs are
+ *  dropped; the grace period covers the clear-and-reimport cycle of an arrangement sync. */
+void recountSourcePool() {
+  auto& pool = gState->sourcePool;
+  std::unordered_set<uint64_t> liveClips;
+  if (gState->edit) {
+    for (auto* track : cachedAudioTracks(*gState->edit)) {
+      for (auto* clip : track->getClips()) {
+        liveClips.insert(clip->itemID.getRawID());
+      }
+    }
+  }
+  const double nowMs = juce::Time::getMillisecondCounterHiRes();
+  std::lock_guard<std::mutex> lock(pool.mutex);
+  for (auto& [hash, source] : pool.byHash) {
+    source->refCount = 0;
+  }
+  for (auto it = pool.hashByClip.begin(); it != pool.hashByClip.end();) {
+    if (liveClips.count(it->first) == 0) {
+      it = pool.hashByClip.erase(it);
+      continue;
+    }
+    if (const auto source = pool.byHash.find(it->second); source != pool.byHash.end()) {
+      ++source->second->refCount;
+    }
+    ++it;
+  }
+  for (auto it = pool.byHash.begin(); it != pool.byHash.end();) {
+    auto& source = *it->second;
+    if (source.refCount > 0) {
+      source.unreferencedSinceMs = 0.0;
+    } else if (source.unreferencedSinceMs <= 0.0) {
+      source.unreferencedSinceMs = nowMs;
+    } else if (nowMs - source.unreferencedSinceMs >= kSourceEvictAfterMs) {
+      if (source.inSampleStore) {
+        gState->sampleStore->release(it->first);
+        source.file.deleteFile();
+      }
+      it = pool.byHash.erase(it);
+      continue;
+    }
+    ++it;
+  }
+}
+
+class SourcePoolTimer final : public juce::Timer {
+ public:
+  void timerCallback() override {
+    recountSourcePool();
+  }
+};
+
+}  // namespace
+
+void startSourcePoolTimer() {
+  gState->sourcePoolTimer = std::make_unique<SourcePoolTimer>();
+  gState->sourcePoolTimer->startTimer(kSourcePoolSweepMs);
+}
+
+bool importClipFile(const ClipImportRequest& request, ClipImportResult& result, std::string& error) {
+  result = {};
+
+  if (!isInitialised(error)) {
+    return false;
+  }
+  if (!requireEdit(error)) {
+    return false;
+  }
+
+  if (isMidiImportRequest(request)) {
+    ParsedMidiFile parsed;
+    if (!parseMidiFileForImport(request, parsed, error)) {
+      return false;
+    }
+    return importMidiClip(request, std::move(parsed), result, error);
+  }
+
+  if (request.sourcePath.empty()) {
+    error = "source_path is required";
+    return false;
+  }
+
+  auto* track = getAudioTrackByIndex(request.trackId);
+  if (track == nullptr) {
+    error = "track_id out of range";
+    return false;
+  }
+  noteTrackEdited(*track);
+
+  juce::File sourceFile(request.sourcePath);
+  if (!sourceFile.existsAsFile()) {
+    error = "source file not found";
+    return false;
+  }
+
+  ClipImportRequest trimmedRequest;
+  SilenceScan silence;
+  if (!resolveAutoTrim(request, trimmedRequest, silence, error)) {
+    return false;
+  }
+
+  tracktion::core::TimeRange clipRange;
+  double startBars = 0.0;
+  double lengthBars = 0.0;
+  resolveClipPlacement(request, 1.0, startBars, lengthBars, clipRange);
+  const double fileOffsetSec = (trimmedRequest.sourceOffsetSeconds >= 0.0) ? trimmedRequest.sourceOffsetSeconds : 0.0;
+  std::fprintf(stderr, "[thestuu-native] clip import track %d at %.2f bars (%.3fs) length %.2f bars offset %.2fs\n",
+               static_cast<int>(request.trackId), startBars, clipRange.getStart().inSeconds(), lengthBars, fileOffsetSec);
+
+  const tracktion::engine::ClipPosition position{clipRange, tracktion::core::TimeDuration::fromSeconds(fileOffsetSec)};
+
+  // Clips with the same content share one pooled file (and with it one reader and cache in Tracktion).
+  std::string sourceHash;
+  bool reusedSource = false;
+  const juce::File pooledFile = acquirePooledSource(sourceFile, sourceHash, reusedSource);
+
+  auto clip = track->insertWaveClip(sourceFile.getFileNameWithoutExtension(), pooledFile, position, false);
+  if (clip == nullptr) {
+    error = "failed to insert clip";
+    return false;
+  }
+  if (!sourceHash.empty()) {
+    attachClipToSource(clip->itemID.getRawID(), sourceHash, reusedSource);
+  }
+  // Play from source file directly for all formats (WAV, MP3, FLAC, OGG, AAC, AIFF, etc.) without
+  // proxy so behaviour is identical and playback works regardless of Tracktion’s needsCachedProxy.
+  clip->setUsesProxy(false);
+
+  if (request.fadeInSeconds > 0.0 || request.fadeOutSeconds > 0.0) {
+    if (auto* acb = dynamic_cast<tracktion::engine::AudioClipBase*>(clip.get())) {
+      if (request.fadeInSeconds > 0.0) {
+        acb->setFadeIn(tracktion::core::TimeDuration::fromSeconds(request.fadeInSeconds));
+      }
+      if (request.fadeOutSeconds > 0.0) {
+        acb->setFadeOut(tracktion::core::TimeDuration::fromSeconds(request.fadeOutSeconds));
+      }
+      const int inCurve = (request.fadeInCurve >= 1 && request.fadeInCurve <= 4) ? request.fadeInCurve : 1;
+      const int outCurve = (request.fadeOutCurve >= 1 && request.fadeOutCurve <= 4) ? request.fadeOutCurve : 1;
+      acb->setFadeInType(static_cast<tracktion::engine::AudioFadeCurve::Type>(inCurve));
+      acb->setFadeOutType(static_cast<tracktion::engine::AudioFadeCurve::Type>(outCurve));
+    }
+  }
+
+  result.trackId = request.trackId;
+  result.startBars = startBars;
+  result.lengthBars = lengthBars;
+  result.sourcePath = request.sourcePath;
+  result.type = "audio";
+  result.clipId = clip->itemID.getRawID();
+  result.sourceHash = sourceHash;
+  result.leadingSilenceSeconds = silence.leadingSeconds;
+  result.trailingSilenceSeconds = silence.trailingSeconds;
+  error.clear();
+  return true;
+}
+
+bool importClipFileOnMessageThread(const ClipImportRequest& request, ClipImportResult& result, std::string& error) {
+  result = {};
+  error.clear();
+
+  // MIDI files are parsed and auto-trim scans run here on the calling (socket) thread; only clip
+  // insertion hops to the message thread.
+  const bool isMidi = isMidiImportRequest(request);
+  ParsedMidiFile parsedMidi;
+  if (isMidi && !parseMidiFileForImport(request, parsedMidi, error)) {
+    return false;
+  }
+  if (!isInitialised(error)) {
+    return false;
+  }
+  ClipImportRequest trimmedRequest;
+  SilenceScan silence;
+  if (!resolveAutoTrim(request, trimmedRequest, silence, error)) {
+    return false;
+  }
+  const auto importTrimmed = [&]() {
+    if (!importClipFile(trimmedRequest, result, error)) {
+      return false;
+    }
+    result.leadingSilenceSeconds = silence.leadingSeconds;
+    result.trailingSilenceSeconds = silence.trailingSeconds;
+    return true;
+  };
+
+  auto* mm = juce::MessageManager::getInstance();
+  if (mm && mm->isThisTheMessageThread()) {
+    return isMidi ? importMidiClip(request, parsedMidi, result, error) : importTrimmed();
+  }
+  if (!mm) {
+    error = "JUCE MessageManager not available";
+    return false;
+  }
+  std::mutex mtx;
+  std::condition_variable cv;
+  std::atomic<bool> done{false};
+  bool ok = false;
+  mm->callAsync([&]() {
+    ok = isMidi ? importMidiClip(request, parsedMidi, result, error) : importTrimmed();
+    {
+      std::lock_guard<std::mutex> lock(mtx);
+      done = true;
+    }
+    cv.notify_one();
+  });
+  std::unique_lock<std::mutex> lock(mtx);
+  cv.wait_for(lock, std::chrono::seconds(10), [&]() { return done.load(); });
+  return ok;
+}
+
+bool clearAllAudioClips(std::string& error) {
+  error.clear();
+  if (!gState || !gState->edit) {
+    error = "backend not initialised";
+    return false;
+  }
+  try {
+    const auto tracks = cachedAudioTracks(*gState->edit);
     for (auto* track : tracks) {
       if (track == nullptr) {
         continue;
@@ -1739,6 +3109,7 @@ bool clearAllAudioClips(std::string& error) {
         }
       }
     }
+    recountSourcePool();
     return true;
   } catch (const std::exception& ex) {
     error = ex.what();
@@ -1814,6 +3185,12 @@ bool getTransportSnapshot(TransportSnapshot& out) {
   out.bpm = bpm;
   out.positionBars = positionBars;
   out.positionBeats = positionBeats;
+  out.looping = transport.looping.get();
+  if (out.looping) {
+    const auto loopRange = transport.getLoopRange();
+    out.loopStartBeats = timePositionToBeats(loopRange.getStart());
+    out.loopEndBeats = timePositionToBeats(loopRange.getEnd());
+  }
   out.bar = bar;
   out.beat = beat;
   out.step = step;
@@ -1824,6 +3201,41 @@ bool getTransportSnapshot(TransportSnapshot& out) {
   return true;
 }
 
+/** Tracktion spawns its graph worker threads while the playback context is allocated, and they run none
+ *  of our code before processing audio. So the worker role (policy, priority, audio CPU mask) is applied
+ *  to them from outside, by thread id. The graph pool starts plain std::threads, which keep the name of
+ *  the thread that created them; juce::Thread helpers started during the allocation (file buffering,
+ *  timers) name themselves. So only new threads named like the calling (message) thread count as
+ *  workers, and threads already recorded under another role are skipped. */
+static void applyWorkerScheduling(const std::vector<int>& threadsBefore) {
+  const auto& config = gState->scheduling;
+  std::vector<int> recorded;
+  for (const auto& state : getThreadSchedulingReport()) {
+    recorded.push_back(state.threadId);
+  }
+  const std::string creatorName = readThreadName(0);
+  for (const int threadId : listProcessThreadIds()) {
+    if (std::binary_search(threadsBefore.begin(), threadsBefore.end(), threadId)
+        || std::find(recorded.begin(), recorded.end(), threadId) != recorded.end()
+        || readThreadName(threadId) != creatorName) {
+      continue;
+    }
+    const auto state = applyThreadScheduling(threadId, "worker", config.policy, config.workerPriority, config.audioCpus);
+    if (!state.error.empty()) {
+      std::fprintf(stderr, "[thestuu-native] worker thread %d scheduling: %s\n", threadId, state.error.c_str());
+    }
+  }
+}
+
+/** Allocates the playback context and gives the graph threads it spawns the worker role. Empty tracks
+ *  are idled first. */
+static void allocatePlaybackContext(tracktion::engine::TransportControl& transport) {
+  refreshDormantTracks();
+  const auto threadsBefore = listProcessThreadIds();
+  transport.ensureContextAllocated(true);
+  applyWorkerScheduling(threadsBefore);
+}
+
 static void transportPlayImpl() {
   if (!gState || !gState->edit) {
     return;
@@ -1836,7 +3248,7 @@ static void transportPlayImpl() {
   }
   // Debug: log first 4 audio tracks so we can see why track 2 might not play
   {
-    const auto tracks = tracktion::engine::getAudioTracks(*gState->edit);
+    const auto tracks = cachedAudioTracks(*gState->edit);
     const int n = std::min(4, static_cast<int>(tracks.size()));
     for (int i = 0; i < n; ++i) {
       if (auto* t = tracks[i]) {
@@ -1849,9 +3261,13 @@ static void transportPlayImpl() {
       }
     }
   }
+  leaveIdlePower();
+  gState->lastActivityMs = juce::Time::getMillisecondCounterHiRes();
+  // Suspended chains play again from the start; the monitor re-suspends idle ones once silent.
+  resumeSuspendedTracks();
   // Force full rebuild at play time so the graph is guaranteed to include all current tracks/clips.
   transport.freePlaybackContext();
-  transport.ensureContextAllocated(true);
+  allocatePlaybackContext(transport);
   transport.play(false);
 }
 
@@ -1867,7 +3283,7 @@ static void transportRebuildGraphOnlyImpl() {
   /* Free context so playingFlag is cleared; then rebuild. When we play(), performPlay()
    * will run (playingFlag was cleared) and start the new graph's playhead. */
   transport.freePlaybackContext();
-  transport.ensureContextAllocated(true);
+  allocatePlaybackContext(transport);
   if (wasPlaying) {
     transport.setPosition(savedPosition);
     transport.play(false);
@@ -1881,7 +3297,7 @@ static void transportEnsureContextImpl() {
   }
   auto& transport = gState->edit->getTransport();
   transport.freePlaybackContext();
-  transport.ensureContextAllocated(true);
+  allocatePlaybackContext(transport);
 }
 
 static void runOnMessageThreadAndWait(std::function<void()> fn) {
@@ -1905,114 +3321,2844 @@ static void runOnMessageThreadAndWait(std::function<void()> fn) {
   cv.wait_for(lock, std::chrono::seconds(5), [&]() { return done.load(); });
 }
 
-/** Rebuild graph without stopping playback. Use after mute/solo/volume/pan/record-arm. */
-void transportRebuildGraphOnly() {
-  if (!gState || !gState->edit) return;
-  runOnMessageThreadAndWait(transportRebuildGraphOnlyImpl);
-}
+namespace {
 
-void transportEnsureContext() {
-  if (!gState || !gState->edit) return;
-  runOnMessageThreadAndWait(transportEnsureContextImpl);
+/** 2.5 ms frames: fine enough for vocal doubles, parabolic peak refinement does the rest. */
+constexpr double kAlignEnvelopeRate = 400.0;
+
+struct WaveClipSnapshot {
+  uint64_t clipId = 0;
+  juce::File file;
+  double startSeconds = 0.0;
+  double endSeconds = 0.0;
+  double offsetSeconds = 0.0;
+  std::string error;
+};
+
+/** Message thread only. */
+WaveClipSnapshot snapshotWaveClip(uint64_t clipId) {
+  WaveClipSnapshot snapshot;
+  snapshot.clipId = clipId;
+  auto* clip = tracktion::engine::findClipForID(*gState->edit, tracktion::engine::EditItemID::fromRawID(clipId));
+  auto* wave = dynamic_cast<tracktion::engine::WaveAudioClip*>(clip);
+  if (wave == nullptr) {
+    snapshot.error = "clip not found or not an audio clip";
+    return snapshot;
+  }
+  if (std::abs(wave->getSpeedRatio() - 1.0) > 1.0e-6) {
+    snapshot.error = "time-stretched clips are not supported";
+    return snapshot;
+  }
+  const auto position = wave->getPosition();
+  snapshot.file = wave->getAudioFile().getFile();
+  snapshot.startSeconds = position.getStart().inSeconds();
+  snapshot.endSeconds = position.getEnd().inSeconds();
+  snapshot.offsetSeconds = position.getOffset().inSeconds();
+  return snapshot;
 }
 
-void transportPlay() {
-  if (!gState || !gState->edit) {
-    return;
+/** Envelope of a clip as placed on the timeline over [fromSeconds, toSeconds); silent outside the clip. */
+bool computeClipEnvelope(
+  const WaveClipSnapshot& clip,
+  double fromSeconds,
+  double toSeconds,
+  OnsetEnvelope& envelope,
+  std::string& error
+) {
+  auto& formats = gState->engine->getAudioFileFormatManager().readFormatManager;
+  std::unique_ptr<juce::AudioFormatReader> reader(formats.createReaderFor(clip.file));
+  if (reader == nullptr) {
+    error = "unsupported audio file";
+    return false;
   }
-  std::mutex mtx;
-  std::condition_variable cv;
-  std::atomic<bool> done{false};
-  if (auto* mm = juce::MessageManager::getInstance()) {
-    mm->callAsync([&]() {
-      transportPlayImpl();
-      {
-        std::lock_guard<std::mutex> lock(mtx);
-        done = true;
-      }
-      cv.notify_one();
-    });
-    std::unique_lock<std::mutex> lock(mtx);
-    cv.wait_for(lock, std::chrono::seconds(5), [&]() { return done.load(); });
-  } else {
-    transportPlayImpl();
+  const double sourceStart = clip.offsetSeconds + (fromSeconds - clip.startSeconds);
+  if (!computeOnsetEnvelope(*reader, sourceStart, toSeconds - fromSeconds, kAlignEnvelopeRate, envelope)) {
+    error = "failed to read audio file";
+    return false;
+  }
+  const auto firstInside = static_cast<int64_t>(std::ceil((clip.startSeconds - fromSeconds) * kAlignEnvelopeRate));
+  const auto lastInside = static_cast<int64_t>(std::floor((clip.endSeconds - fromSeconds) * kAlignEnvelopeRate));
+  for (int64_t frame = 0; frame < static_cast<int64_t>(envelope.values.size()); ++frame) {
+    if (frame < firstInside || frame >= lastInside) {
+      envelope.values[static_cast<size_t>(frame)] = 0.0F;
+    }
   }
+  return true;
 }
 
-void transportPause() {
-  if (!gState || !gState->edit) {
-    return;
+/** Runs task(0..count-1) on one worker per core, the calling thread included; returns when all are done. */
+void forEachInParallel(size_t count, const std::function<void(size_t)>& task) {
+  const size_t workerCount = std::min<size_t>(count, std::max(1U, std::thread::hardware_concurrency()));
+  std::atomic<size_t> next{0};
+  const auto worker = [&]() {
+    for (size_t index = next++; index < count; index = next++) {
+      task(index);
+    }
+  };
+  std::vector<std::thread> workers;
+  for (size_t i = 1; i < workerCount; ++i) {
+    workers.emplace_back(worker);
+  }
+  worker();
+  for (auto& thread : workers) {
+    thread.join();
   }
-  gState->edit->getTransport().stop(true, false, true);
 }
 
-void transportStop() {
-  if (!gState || !gState->edit) {
-    return;
+}  // namespace
+
+bool alignClips(const SyncAlignRequest& request, SyncAlignResult& result, std::string& error) {
+  result = {};
+  result.guideClipId = request.guideClipId;
+  if (!isInitialised(error)) {
+    return false;
   }
-  gState->edit->getTransport().stop(true, false, true);
-  gState->edit->getTransport().setPosition(tracktion::core::TimePosition::fromSeconds(0.0));
-}
+  if (request.targetClipIds.empty()) {
+    error = "target_clip_ids is required";
+    return false;
+  }
+  const double startedMs = juce::Time::getMillisecondCounterHiRes();
 
-void transportSeek(double positionBeats) {
-  if (!gState || !gState->edit) {
-    return;
+  AlignmentOptions options;
+  options.maxShiftSeconds = std::clamp(request.maxShiftMs, 1.0, 1000.0) / 1000.0;
+  options.windowSeconds = std::clamp(request.windowMs, 100.0, 30000.0) / 1000.0;
+  options.hopSeconds = std::clamp(request.hopMs, 10.0, 30000.0) / 1000.0;
+  options.minConfidence = std::clamp(request.minConfidence, 0.0, 1.0);
+
+  WaveClipSnapshot guide;
+  std::vector<WaveClipSnapshot> targets;
+  bool hasEdit = true;
+  runOnMessageThreadAndWait([&]() {
+    if (!gState->edit) {
+      hasEdit = false;
+      return;
+    }
+    guide = snapshotWaveClip(request.guideClipId);
+    for (const auto clipId : request.targetClipIds) {
+      targets.push_back(snapshotWaveClip(clipId));
+    }
+  });
+  if (!hasEdit) {
+    error = "no edit loaded";
+    return false;
+  }
+  if (!guide.error.empty()) {
+    error = "guide clip: " + guide.error;
+    return false;
   }
-  const auto timePos = convertBeatsToTime(std::max(0.0, positionBeats));
-  gState->edit->getTransport().setPosition(timePos);
-}
 
-void transportSetBpm(double bpm) {
-  if (!gState || !gState->edit) {
-    return;
+  // One guide envelope covering every target (plus the search padding); targets slice into it.
+  const int pad = alignmentPadFrames(options, kAlignEnvelopeRate);
+  const double padSeconds = pad / kAlignEnvelopeRate;
+  double guideFrom = std::numeric_limits<double>::max();
+  double guideTo = std::numeric_limits<double>::lowest();
+  for (const auto& target : targets) {
+    if (target.error.empty()) {
+      guideFrom = std::min(guideFrom, target.startSeconds - padSeconds);
+      guideTo = std::max(guideTo, target.endSeconds + padSeconds);
+    }
+  }
+  OnsetEnvelope guideEnvelope;
+  if (guideFrom < guideTo && !computeClipEnvelope(guide, guideFrom, guideTo + 1.0 / kAlignEnvelopeRate, guideEnvelope, error)) {
+    error = "guide clip: " + error;
+    return false;
   }
-  const double requested = std::isfinite(bpm) ? bpm : 128.0;
-  const double clampedBpm = juce::jlimit(20.0, 300.0, requested);
 
-  auto setTempoOnMessageThread = [clampedBpm]() {
-    if (!gState || !gState->edit) {
+  result.targets.resize(targets.size());
+  const auto analyseTarget = [&](size_t index) {
+    const auto& target = targets[index];
+    auto& out = result.targets[index];
+    out.clipId = target.clipId;
+    if (!target.error.empty()) {
+      out.error = target.error;
       return;
     }
-    auto& tempoSequence = gState->edit->tempoSequence;
-    if (auto* firstTempo = tempoSequence.getTempo(0)) {
-      firstTempo->setBpm(clampedBpm);
-    } else if (auto insertedTempo = tempoSequence.insertTempo(tracktion::core::BeatPosition::fromBeats(0.0), clampedBpm, 1.0f)) {
-      insertedTempo->setBpm(clampedBpm);
+    if (target.clipId == guide.clipId) {
+      out.error = "target is the guide clip";
+      return;
     }
-    const double resultingBpm = getBpmFromEdit();
-    const bool playing = gState->edit->getTransport().isPlaying();
-    std::fprintf(
-      stderr,
-      "[thestuu-native] transportSetBpm applied=%.3f resultingEditBpm=%.3f playing=%d\n",
-      clampedBpm,
-      resultingBpm,
-      playing ? 1 : 0
+    OnsetEnvelope targetEnvelope;
+    std::string targetError;
+    if (!computeClipEnvelope(target, target.startSeconds, target.endSeconds, targetEnvelope, targetError)) {
+      out.error = targetError;
+      return;
+    }
+    // Guide slice starting pad frames before the target. Rounding to whole guide frames shifts the
+    // slice by up to half a frame; skew puts that back into the measured offsets.
+    const double sliceExact = (target.startSeconds - guideFrom) * kAlignEnvelopeRate - pad;
+    const auto sliceStart = static_cast<size_t>(std::max<int64_t>(0, std::llround(sliceExact)));
+    const size_t sliceLength = targetEnvelope.values.size() + static_cast<size_t>(2 * pad);
+    if (sliceStart + sliceLength > guideEnvelope.values.size()) {
+      out.error = "guide does not cover target";
+      return;
+    }
+    OnsetEnvelope guideSlice;
+    guideSlice.frameRate = kAlignEnvelopeRate;
+    guideSlice.values.assign(
+      guideEnvelope.values.begin() + static_cast<std::ptrdiff_t>(sliceStart),
+      guideEnvelope.values.begin() + static_cast<std::ptrdiff_t>(sliceStart + sliceLength)
     );
+    const double skewSeconds = (sliceExact - static_cast<double>(sliceStart)) / kAlignEnvelopeRate;
+
+    const auto alignment = alignOnsetEnvelopes(guideSlice, targetEnvelope, options);
+    if (alignment.confidence <= 0.0) {
+      out.error = "no common onsets with the guide";
+      return;
+    }
+    out.ok = true;
+    out.offsetMs = std::clamp(alignment.offsetSeconds + skewSeconds, -options.maxShiftSeconds, options.maxShiftSeconds) * 1000.0;
+    out.confidence = alignment.confidence;
+    out.markers.reserve(alignment.markers.size());
+    for (const auto& marker : alignment.markers) {
+      const double offsetSeconds = std::clamp(marker.offsetSeconds + skewSeconds, -options.maxShiftSeconds, options.maxShiftSeconds);
+      SyncWarpMarker warp;
+      warp.sourceSeconds = target.offsetSeconds + marker.timeSeconds;
+      warp.timelineSeconds = target.startSeconds + marker.timeSeconds - offsetSeconds;
+      warp.offsetMs = offsetSeconds * 1000.0;
+      warp.confidence = marker.confidence;
+      out.markers.push_back(warp);
+    }
   };
 
-  if (auto* mm = juce::MessageManager::getInstance()) {
-    if (mm->isThisTheMessageThread()) {
-      setTempoOnMessageThread();
-      return;
+  forEachInParallel(targets.size(), analyseTarget);
+
+  if (request.apply) {
+    runOnMessageThreadAndWait([&]() {
+      if (!gState->edit) {
+        return;
+      }
+      for (auto& target : result.targets) {
+        if (!target.ok || target.offsetMs == 0.0) {
+          continue;
+        }
+        auto* clip = tracktion::engine::findClipForID(*gState->edit, tracktion::engine::EditItemID::fromRawID(target.clipId));
+        if (clip == nullptr) {
+          continue;
+        }
+        const auto position = clip->getPosition();
+        const double newStart = position.getStart().inSeconds() - target.offsetMs / 1000.0;
+        clip->setStart(tracktion::core::TimePosition::fromSeconds(std::max(0.0, newStart)), false, true);
+        if (newStart < 0.0) {
+          // Cannot move before the edit start: skip into the source instead.
+          clip->setOffset(position.getOffset() + tracktion::core::TimeDuration::fromSeconds(-newStart));
+        }
+        if (auto* track = dynamic_cast<tracktion::engine::AudioTrack*>(clip->getTrack())) {
+          noteTrackEdited(*track);
+        }
+        target.applied = true;
+      }
+    });
+  }
+
+  result.elapsedMs = juce::Time::getMillisecondCounterHiRes() - startedMs;
+  std::fprintf(stderr, "[thestuu-native] sync:align %zu target(s) against clip %llu in %.1f ms\n",
+               targets.size(), static_cast<unsigned long long>(request.guideClipId), result.elapsedMs);
+  error.clear();
+  return true;
+}
+
+/** Offline render of the whole edit for audio:loudness. The graph is built on the message thread and its
+ *  blocks are rendered on the background pool; the socket thread only waits for done. Shared, so a render
+ *  the socket thread gave up on can still finish and clean up after itself. */
+struct LoudnessRender {
+  juce::File file;
+  std::string error;
+  std::unique_ptr<tracktion::engine::Edit::ScopedRenderStatus> renderStatus;
+  std::unique_ptr<tracktion::engine::Renderer::RenderTask> task;
+  /** Set by the socket thread when it stopped waiting; the render then deletes its own file. */
+  std::atomic<bool> abandoned{false};
+  juce::WaitableEvent done{true};
+};
+
+namespace {
+
+/** The socket thread waits this long for an offline render (far beyond the 5 s of message-thread calls). */
+constexpr int kLoudnessRenderWaitMs = 30 * 60 * 1000;
+
+struct LoudnessSource {
+  juce::File file;
+  double startSeconds = 0.0;
+  double lengthSeconds = 0.0;
+  bool temporary = false;
+};
+
+/** Message thread. Releases the graph and the render status (which reallocates playback) here. */
+void finishLoudnessRender(const std::shared_ptr<LoudnessRender>& render) {
+  render->task.reset();
+  render->renderStatus.reset();
+  if (render->abandoned) {
+    render->file.deleteFile();
+  }
+  render->done.signal();
+}
+
+/** Message thread. Stops playback, builds the render graph and hands the blocks to the background pool. */
+void startLoudnessRender(const std::shared_ptr<LoudnessRender>& render) {
+  if (!gState || !gState->edit) {
+    render->error = "no edit loaded";
+    render->done.signal();
+    return;
+  }
+  auto& edit = *gState->edit;
+  if (edit.getLength().inSeconds() <= 0.0) {
+    render->error = "edit is empty";
+    render->done.signal();
+    return;
+  }
+  tracktion::engine::TransportControl::stopAllTransports(edit.engine, false, true);
+  render->renderStatus = std::make_unique<tracktion::engine::Edit::ScopedRenderStatus>(edit, true);
+  tracktion::engine::Renderer::Parameters params(edit);
+  params.destFile = render->file;
+  params.audioFormat = edit.engine.getAudioFileFormatManager().getWavFormat();
+  params.bitDepth = 32;
+  params.time = tracktion::core::TimeRange(tracktion::core::TimePosition(), edit.getLength());
+  params.tracksToDo = tracktion::engine::toBitSet(tracktion::engine::getAllTracks(edit));
+  params.usePlugins = true;
+  params.useMasterPlugins = true;
+  render->task = std::make_unique<tracktion::engine::Renderer::RenderTask>("audio:loudness", params, nullptr, nullptr);
+  gState->backgroundPool->addJob([render]() {
+    while (render->task->runJob() == juce::ThreadPoolJob::jobNeedsRunningAgain) {
+    }
+    if (render->task->errorMessage.isNotEmpty()) {
+      render->error = "offline render failed: " + render->task->errorMessage.toStdString();
+    }
+    juce::MessageManager::callAsync([render]() { finishLoudnessRender(render); });
+  });
+}
+
+}  // namespace
+
+void waitForLoudnessRender() {
+  if (!gState || gState->loudnessRender == nullptr) {
+    return;
+  }
+  if (!gState->loudnessRender->done.wait(kLoudnessRenderWaitMs)) {
+    std::fprintf(stderr, "[thestuu-native] audio:loudness: offline render still running\n");
+  }
+  gState->loudnessRender.reset();
+}
+
+bool analyseLoudness(const LoudnessRequest& request, std::vector<LoudnessReport>& reports, std::string& error) {
+  reports.clear();
+  if (!isInitialised(error)) {
+    return false;
+  }
+  if (request.paths.empty() && request.clipIds.empty() && !request.renderEdit) {
+    error = "paths, clip_ids or render is required";
+    return false;
+  }
+  const double startedMs = juce::Time::getMillisecondCounterHiRes();
+  std::vector<LoudnessSource> sources;
+
+  for (const auto& path : request.paths) {
+    LoudnessReport report;
+    report.kind = "file";
+    report.path = path;
+    LoudnessSource source;
+    if (juce::File::isAbsolutePath(path)) {
+      source.file = juce::File(path);
+    }
+    if (!source.file.existsAsFile()) {
+      report.error = "source file not found";
+    }
+    reports.push_back(report);
+    sources.push_back(source);
+  }
+
+  if (!request.clipIds.empty()) {
+    runOnMessageThreadAndWait([&]() {
+      for (const auto clipId : request.clipIds) {
+        LoudnessReport report;
+        report.kind = "clip";
+        report.clipId = clipId;
+        LoudnessSource source;
+        if (!gState->edit) {
+          report.error = "no edit loaded";
+        } else if (const auto clip = snapshotWaveClip(clipId); !clip.error.empty()) {
+          report.error = clip.error;
+        } else {
+          report.path = clip.file.getFullPathName().toStdString();
+          source.file = clip.file;
+          source.startSeconds = clip.offsetSeconds;
+          source.lengthSeconds = clip.endSeconds - clip.startSeconds;
+        }
+        reports.push_back(report);
+        sources.push_back(source);
+      }
+    });
+  }
+
+  if (request.renderEdit) {
+    waitForLoudnessRender();
+    auto render = std::make_shared<LoudnessRender>();
+    render->file = juce::File::getSpecialLocation(juce::File::tempDirectory)
+      .getNonexistentChildFile("thestuu-loudness", ".wav");
+    gState->loudnessRender = render;
+    runOnMessageThreadAndWait([render]() { startLoudnessRender(render); });
+    LoudnessReport report;
+    report.kind = "render";
+    LoudnessSource source;
+    source.file = render->file;
+    if (!render->done.wait(kLoudnessRenderWaitMs)) {
+      render->abandoned = true;
+      if (render->done.wait(0)) {
+        render->file.deleteFile();
+      }
+      report.error = "timeout during offline render";
+    } else {
+      gState->loudnessRender.reset();
+      report.error = render->error;
+      source.temporary = true;
+    }
+    reports.push_back(report);
+    sources.push_back(source);
+  }
+
+  auto& formats = gState->engine->getAudioFileFormatManager().readFormatManager;
+  forEachInParallel(sources.size(), [&](size_t index) {
+    auto& report = reports[index];
+    if (!report.error.empty()) {
+      return;
+    }
+    const auto& source = sources[index];
+    std::unique_ptr<juce::AudioFormatReader> reader(formats.createReaderFor(source.file));
+    if (reader == nullptr) {
+      report.error = "unsupported audio file";
+      return;
+    }
+    LoudnessStats stats;
+    if (!measureLoudness(*reader, source.startSeconds, source.lengthSeconds, stats)) {
+      report.error = "failed to read audio file";
+      return;
+    }
+    report.ok = true;
+    report.integratedLufs = stats.integratedLufs;
+    report.momentaryMaxLufs = stats.momentaryMaxLufs;
+    report.shortTermMaxLufs = stats.shortTermMaxLufs;
+    report.loudnessRangeLu = stats.loudnessRangeLu;
+    report.truePeakDbtp = stats.truePeakDbtp;
+    report.samplePeakDbfs = stats.samplePeakDbfs;
+    report.durationSeconds = stats.durationSeconds;
+  });
+
+  for (const auto& source : sources) {
+    if (source.temporary) {
+      source.file.deleteFile();
+    }
+  }
+  std::fprintf(stderr, "[thestuu-native] audio:loudness %zu source(s) in %.1f ms\n",
+               sources.size(), juce::Time::getMillisecondCounterHiRes() - startedMs);
+  error.clear();
+  return true;
+}
+
+bool detectClipTransients(
+  uint64_t clipId,
+  double sensitivity,
+  double minGapMs,
+  std::vector<ClipTransient>& transients,
+  std::string& error
+) {
+  transients.clear();
+  if (!isInitialised(error) || !requireEdit(error)) {
+    return false;
+  }
+  WaveClipSnapshot clip;
+  clip.error = "no edit loaded";
+  runOnMessageThreadAndWait([&]() {
+    if (gState->edit) {
+      clip = snapshotWaveClip(clipId);
+    }
+  });
+  if (!clip.error.empty()) {
+    error = clip.error;
+    return false;
+  }
+  auto& formats = gState->engine->getAudioFileFormatManager().readFormatManager;
+  std::unique_ptr<juce::AudioFormatReader> reader(formats.createReaderFor(clip.file));
+  if (reader == nullptr) {
+    error = "unsupported audio file";
+    return false;
+  }
+  TransientDetectionOptions options;
+  options.sensitivity = std::isfinite(sensitivity) ? sensitivity : options.sensitivity;
+  options.minGapSeconds = std::isfinite(minGapMs) && minGapMs >= 0.0 ? minGapMs / 1000.0 : options.minGapSeconds;
+  std::vector<Transient> detected;
+  if (!detectTransients(*reader, clip.offsetSeconds, clip.endSeconds - clip.startSeconds, options, detected)) {
+    error = "failed to read audio file";
+    return false;
+  }
+  transients.reserve(detected.size());
+  for (const auto& transient : detected) {
+    transients.push_back({
+      clip.startSeconds + transient.timeSeconds,
+      clip.offsetSeconds + transient.timeSeconds,
+      transient.strength,
+    });
+  }
+  error.clear();
+  return true;
+}
+
+bool sliceClipAt(uint64_t clipId, const std::vector<double>& timelineSeconds, std::vector<uint64_t>& clipIds, std::string& error) {
+  clipIds.clear();
+  if (!isInitialised(error) || !requireEdit(error)) {
+    return false;
+  }
+  std::vector<double> times(timelineSeconds);
+  std::sort(times.begin(), times.end());
+  times.erase(std::unique(times.begin(), times.end()), times.end());
+
+  bool ok = false;
+  runOnMessageThreadAndWait([&]() {
+    if (!gState->edit) {
+      error = "no edit loaded";
+      return;
+    }
+    auto* clip = tracktion::engine::findClipForID(*gState->edit, tracktion::engine::EditItemID::fromRawID(clipId));
+    auto* track = clip != nullptr ? dynamic_cast<tracktion::engine::AudioTrack*>(clip->getTrack()) : nullptr;
+    if (track == nullptr) {
+      error = "clip not found";
+      return;
+    }
+    noteTrackEdited(*track);
+    std::string sourceHash;
+    {
+      auto& pool = gState->sourcePool;
+      std::lock_guard<std::mutex> lock(pool.mutex);
+      if (const auto it = pool.hashByClip.find(clipId); it != pool.hashByClip.end()) {
+        sourceHash = it->second;
+      }
+    }
+    // Each split keeps the left part in place and returns the right part, which the next time splits.
+    constexpr double kMinSliceSeconds = 0.001;
+    clipIds.push_back(clipId);
+    auto* current = clip;
+    for (const double time : times) {
+      const auto range = current->getEditTimeRange();
+      if (time < range.getStart().inSeconds() + kMinSliceSeconds || time > range.getEnd().inSeconds() - kMinSliceSeconds) {
+        continue;
+      }
+      auto* right = track->splitClip(*current, tracktion::core::TimePosition::fromSeconds(time));
+      if (right == nullptr) {
+        continue;
+      }
+      const uint64_t rightId = right->itemID.getRawID();
+      if (!sourceHash.empty()) {
+        attachClipToSource(rightId, sourceHash, false);
+      }
+      clipIds.push_back(rightId);
+      current = right;
+    }
+    ok = true;
+  });
+  if (ok) {
+    std::fprintf(stderr, "[thestuu-native] clip %llu sliced into %zu\n", static_cast<unsigned long long>(clipId), clipIds.size());
+    error.clear();
+  } else if (error.empty()) {
+    error = "failed to slice clip";
+  }
+  return ok;
+}
+
+namespace {
+
+/** Markers unchanged this long: the clip is considered settled and rendered ahead. */
+constexpr double kWarpRenderAfterMs = 3000.0;
+/** A clip this close ahead of a running playhead keeps stretching live: its proxy would be silent
+ *  until the render finishes. */
+constexpr double kWarpRenderLookaheadSeconds = 10.0;
+
+/** Message thread only. */
+void warpRenderTick() {
+  if (!gState || !gState->edit) {
+    return;
+  }
+  auto& edit = *gState->edit;
+  auto& transport = edit.getTransport();
+  const auto position = transport.getPosition();
+  const tracktion::core::TimeRange ahead(
+    position,
+    position + tracktion::core::TimeDuration::fromSeconds(kWarpRenderLookaheadSeconds)
+  );
+  const double nowMs = juce::Time::getMillisecondCounterHiRes();
+  bool pending = false;
+  for (auto it = gState->warpClips.begin(); it != gState->warpClips.end();) {
+    auto& state = it->second;
+    auto* wave = dynamic_cast<tracktion::engine::WaveAudioClip*>(
+      tracktion::engine::findClipForID(edit, tracktion::engine::EditItemID::fromRawID(it->first))
+    );
+    if (wave == nullptr) {
+      it = gState->warpClips.erase(it);
+      continue;
+    }
+    if (!state.rendered) {
+      if (nowMs - state.lastChangeMs < kWarpRenderAfterMs
+          || (transport.isPlaying() && wave->getEditTimeRange().overlaps(ahead))) {
+        pending = true;
+      } else {
+        // Tracktion renders the warped proxy on its background job thread and swaps it in when done.
+        wave->setUsesProxy(true);
+        state.rendered = true;
+        std::fprintf(stderr, "[thestuu-native] warp: rendering clip %llu ahead\n",
+                     static_cast<unsigned long long>(it->first));
+      }
+    }
+    ++it;
+  }
+  if (!pending && gState->warpRenderTimer != nullptr) {
+    gState->warpRenderTimer->stopTimer();
+  }
+}
+
+class WarpRenderTimer final : public juce::Timer {
+ public:
+  void timerCallback() override {
+    warpRenderTick();
+  }
+};
+
+}  // namespace
+
+bool setClipWarpMarkers(uint64_t clipId, const std::vector<ClipWarpMarker>& markers, ClipWarpStatus& status, std::string& error) {
+  status = {};
+  status.clipId = clipId;
+  if (!isInitialised(error) || !requireEdit(error)) {
+    return false;
+  }
+  bool ok = false;
+  runOnMessageThreadAndWait([&]() {
+    if (!gState->edit) {
+      error = "no edit loaded";
+      return;
+    }
+    auto* wave = dynamic_cast<tracktion::engine::WaveAudioClip*>(
+      tracktion::engine::findClipForID(*gState->edit, tracktion::engine::EditItemID::fromRawID(clipId))
+    );
+    if (wave == nullptr) {
+      error = "clip not found or not an audio clip";
+      return;
+    }
+    const auto position = wave->getPosition();
+    const double sourceLength = wave->getSourceLength().inSeconds();
+    std::vector<std::pair<double, double>> points;
+    points.reserve(markers.size());
+    for (const auto& marker : markers) {
+      const double warpSeconds = marker.warpSeconds >= 0.0
+        ? marker.warpSeconds
+        : marker.timelineSeconds - position.getStart().inSeconds() + position.getOffset().inSeconds();
+      if (marker.sourceSeconds < 0.0 || marker.sourceSeconds > sourceLength || warpSeconds < 0.0) {
+        error = "warp marker out of range";
+        return;
+      }
+      if (!points.empty() && (marker.sourceSeconds <= points.back().first || warpSeconds <= points.back().second)) {
+        error = "warp markers must increase in source and warp time";
+        return;
+      }
+      points.emplace_back(marker.sourceSeconds, warpSeconds);
+    }
+
+    auto& warpTime = wave->getWarpTimeManager();
+    warpTime.removeAllMarkers();
+    if (!points.empty()) {
+      // Edge markers carry the first/last shift to the ends of the source, so nothing outside the
+      // marked range is stretched.
+      constexpr double kEdgeEpsilon = 1.0e-4;
+      if (points.front().first > kEdgeEpsilon) {
+        const double shift = points.front().second - points.front().first;
+        points.insert(points.begin(), {0.0, std::max(0.0, shift)});
+      }
+      if (points.back().first < sourceLength - kEdgeEpsilon) {
+        const double shift = points.back().second - points.back().first;
+        points.emplace_back(sourceLength, sourceLength + shift);
+      }
+      for (const auto& [source, warp] : points) {
+        warpTime.insertMarker(tracktion::engine::WarpMarker(
+          tracktion::core::TimePosition::fromSeconds(source),
+          tracktion::core::TimePosition::fromSeconds(warp)
+        ));
+      }
+      wave->setTimeStretchMode(tracktion::engine::TimeStretcher::defaultMode);
+    }
+    wave->setWarpTime(!points.empty());
+    // Live stretching while the markers change; warpRenderTick moves the clip to a proxy once settled.
+    wave->setUsesProxy(false);
+    if (points.empty()) {
+      gState->warpClips.erase(clipId);
+    } else {
+      gState->warpClips[clipId] = {juce::Time::getMillisecondCounterHiRes(), false};
+      if (gState->warpRenderTimer == nullptr) {
+        gState->warpRenderTimer = std::make_unique<WarpRenderTimer>();
+      }
+      if (!gState->warpRenderTimer->isTimerRunning()) {
+        gState->warpRenderTimer->startTimer(500);
+      }
+    }
+    if (auto* track = dynamic_cast<tracktion::engine::AudioTrack*>(wave->getTrack())) {
+      noteTrackEdited(*track);
+    }
+    status.markerCount = static_cast<int32_t>(points.size());
+    ok = true;
+  });
+  if (ok) {
+    error.clear();
+  } else if (error.empty()) {
+    error = "failed to set warp markers";
+  }
+  return ok;
+}
+
+bool getSourcePoolStats(SourcePoolStats& stats, std::string& error) {
+  stats = {};
+  if (!isInitialised(error)) {
+    return false;
+  }
+  runOnMessageThreadAndWait([&]() { recountSourcePool(); });
+  auto& pool = gState->sourcePool;
+  std::lock_guard<std::mutex> lock(pool.mutex);
+  for (const auto& [hash, source] : pool.byHash) {
+    ++stats.sources;
+    stats.clips += source->refCount;
+    if (source->inSampleStore) {
+      ++stats.storedSources;
+    } else {
+      ++stats.mappedSources;
+    }
+  }
+  stats.deduplicatedClips = pool.deduplicatedClips;
+  error.clear();
+  return true;
+}
+
+bool configureSampleStore(int64_t maxFileBytes, int64_t budgetBytes, std::string& error) {
+  if (!isInitialised(error)) {
+    return false;
+  }
+  auto config = gState->sampleStore->getConfig();
+  if (maxFileBytes >= 0) {
+    config.maxFileBytes = maxFileBytes;
+  }
+  if (budgetBytes >= 0) {
+    config.budgetBytes = budgetBytes;
+  }
+  gState->sampleStore->configure(config);
+  error.clear();
+  return true;
+}
+
+bool getSampleCacheStats(SampleCacheStats& stats, std::string& error) {
+  stats = {};
+  if (!isInitialised(error)) {
+    return false;
+  }
+  const auto store = gState->sampleStore->getStats();
+  stats.entries = store.entries;
+  stats.residentEntries = store.residentEntries;
+  stats.residentBytes = store.residentBytes;
+  stats.budgetBytes = store.budgetBytes;
+  stats.maxFileBytes = store.maxFileBytes;
+  stats.hits = store.hits;
+  stats.misses = store.misses;
+  stats.evictions = store.evictions;
+  error.clear();
+  return true;
+}
+
+/** Rebuild graph without stopping playback. Use after mute/solo/volume/pan/record-arm. */
+bool syncTrackMixer(const std::vector<TrackMixUpdate>& updates, TrackMixSyncResult& result, std::string& error) {
+  result = {};
+  if (!isInitialised(error) || !requireEdit(error)) {
+    return false;
+  }
+  runOnMessageThreadAndWait([&]() {
+    if (!gState || !gState->edit) {
+      return;
+    }
+    // Fields that already match are skipped, so a full arrangement sync with nothing new costs no rebuild.
+    bool changed = false;
+    bool armChanged = false;
+    for (const auto& update : updates) {
+      auto* track = getAudioTrackByIndex(update.trackId);
+      if (track == nullptr) {
+        result.missingTrackIds.push_back(update.trackId);
+        continue;
+      }
+      if (update.mute && track->isMuted(false) != *update.mute) {
+        track->setMute(*update.mute);
+        changed = true;
+      }
+      if (update.solo && track->isSolo(false) != *update.solo) {
+        track->setSolo(*update.solo);
+        changed = true;
+      }
+      if (auto* volPan = track->getVolumePlugin()) {
+        if (update.volume) {
+          const float pos = static_cast<float>(std::max(0.0, std::min(1.0, *update.volume)));
+          if (volPan->getSliderPos() != pos) {
+            volPan->setSliderPos(pos);
+            changed = true;
+          }
+        }
+        if (update.pan) {
+          const float pan = static_cast<float>(std::max(-1.0, std::min(1.0, *update.pan)));
+          if (volPan->getPan() != pan) {
+            volPan->setPan(pan);
+            changed = true;
+          }
+        }
+      }
+      if (update.recordArmed && track->getWaveInputDevice().isEnabled() != *update.recordArmed) {
+        noteTrackEdited(*track);
+        track->getWaveInputDevice().setEnabled(*update.recordArmed);
+        armChanged = true;
+      }
+      ++result.applied;
+    }
+    // At most one graph rebuild for the whole batch instead of one per field and track.
+    if (armChanged && gState->lowLatencyMonitoring) {
+      refreshLowLatencyMonitoring();
+    } else if (changed || armChanged) {
+      transportRebuildGraphOnlyImpl();
+    }
+  });
+  error.clear();
+  return true;
+}
+
+void transportRebuildGraphOnly() {
+  if (!gState || !gState->edit) return;
+  runOnMessageThreadAndWait(transportRebuildGraphOnlyImpl);
+}
+
+void transportEnsureContext() {
+  if (!gState || !gState->edit) return;
+  runOnMessageThreadAndWait(transportEnsureContextImpl);
+}
+
+void transportPlay() {
+  if (!gState || !gState->edit) {
+    return;
+  }
+  std::mutex mtx;
+  std::condition_variable cv;
+  std::atomic<bool> done{false};
+  if (auto* mm = juce::MessageManager::getInstance()) {
+    mm->callAsync([&]() {
+      transportPlayImpl();
+      {
+        std::lock_guard<std::mutex> lock(mtx);
+        done = true;
+      }
+      cv.notify_one();
+    });
+    std::unique_lock<std::mutex> lock(mtx);
+    cv.wait_for(lock, std::chrono::seconds(5), [&]() { return done.load(); });
+  } else {
+    transportPlayImpl();
+  }
+}
+
+void transportPause() {
+  if (!gState || !gState->edit) {
+    return;
+  }
+  gState->edit->getTransport().stop(true, false, true);
+}
+
+void transportStop() {
+  if (!gState || !gState->edit) {
+    return;
+  }
+  gState->edit->getTransport().stop(true, false, true);
+  gState->edit->getTransport().setPosition(tracktion::core::TimePosition::fromSeconds(0.0));
+}
+
+void transportSeek(double positionBeats) {
+  if (!gState || !gState->edit) {
+    return;
+  }
+  const auto timePos = convertBeatsToTime(std::max(0.0, positionBeats));
+  gState->edit->getTransport().setPosition(timePos);
+  if (gState->suspensionEnabled) {
+    juce::MessageManager::callAsync([]() { resumeSuspendedTracks(); });
+  }
+}
+
+void transportSetBpm(double bpm) {
+  if (!gState || !gState->edit) {
+    return;
+  }
+  const double requested = std::isfinite(bpm) ? bpm : 128.0;
+  const double clampedBpm = juce::jlimit(20.0, 300.0, requested);
+
+  auto setTempoOnMessageThread = [clampedBpm]() {
+    if (!gState || !gState->edit) {
+      return;
+    }
+    auto& tempoSequence = gState->edit->tempoSequence;
+    if (auto* firstTempo = tempoSequence.getTempo(0)) {
+      firstTempo->setBpm(clampedBpm);
+    } else if (auto insertedTempo = tempoSequence.insertTempo(tracktion::core::BeatPosition::fromBeats(0.0), clampedBpm, 1.0f)) {
+      insertedTempo->setBpm(clampedBpm);
+    }
+    const double resultingBpm = getBpmFromEdit();
+    const bool playing = gState->edit->getTransport().isPlaying();
+    std::fprintf(
+      stderr,
+      "[thestuu-native] transportSetBpm applied=%.3f resultingEditBpm=%.3f playing=%d\n",
+      clampedBpm,
+      resultingBpm,
+      playing ? 1 : 0
+    );
+  };
+
+  if (auto* mm = juce::MessageManager::getInstance()) {
+    if (mm->isThisTheMessageThread()) {
+      setTempoOnMessageThread();
+      return;
+    }
+
+    std::mutex mtx;
+    std::condition_variable cv;
+    std::atomic<bool> done{false};
+    mm->callAsync([&]() {
+      setTempoOnMessageThread();
+      {
+        std::lock_guard<std::mutex> lock(mtx);
+        done = true;
+      }
+      cv.notify_one();
+    });
+    std::unique_lock<std::mutex> lock(mtx);
+    cv.wait_for(lock, std::chrono::seconds(5), [&]() { return done.load(); });
+    return;
+  }
+
+  setTempoOnMessageThread();
+}
+
+namespace {
+
+constexpr double kLoopPrefetchSeconds = 2.0;
+
+struct LoopPrefetchItem {
+  tracktion::engine::AudioFile file;
+  double sourceStartSeconds = 0.0;
+  double lengthSeconds = 0.0;
+};
+
+/** Collects the source regions every wave clip plays right after the loop start. Message thread only. */
+std::vector<LoopPrefetchItem> collectLoopPrefetchItems(tracktion::core::TimeRange loopRange) {
+  std::vector<LoopPrefetchItem> items;
+  const auto windowLength = std::min(loopRange.getLength().inSeconds(), kLoopPrefetchSeconds);
+  const tracktion::core::TimeRange window(
+    loopRange.getStart(),
+    loopRange.getStart() + tracktion::core::TimeDuration::fromSeconds(windowLength)
+  );
+  for (auto* track : cachedAudioTracks(*gState->edit)) {
+    if (track == nullptr) {
+      continue;
+    }
+    for (auto* clip : track->getClips()) {
+      auto* wave = dynamic_cast<tracktion::engine::WaveAudioClip*>(clip);
+      if (wave == nullptr) {
+        continue;
+      }
+      const auto position = wave->getPosition();
+      const auto overlap = position.time.getIntersectionWith(window);
+      if (overlap.isEmpty()) {
+        continue;
+      }
+      LoopPrefetchItem item;
+      item.file = wave->getAudioFile();
+      item.sourceStartSeconds = (overlap.getStart() - position.getStart()).inSeconds() + position.getOffset().inSeconds();
+      item.lengthSeconds = overlap.getLength().inSeconds();
+      items.push_back(std::move(item));
+    }
+  }
+  return items;
+}
+
+/** Reads the loop-start regions through Tracktion's AudioFileCache so the blocks the wave nodes need
+ *  at the wrap are resident before the playhead gets there. Runs on the background pool. */
+void prefetchLoopStartRegions(const std::vector<LoopPrefetchItem>& items) {
+  if (!gState || !gState->engine) {
+    return;
+  }
+  auto& cache = gState->engine->getAudioFileManager().cache;
+  constexpr int kChunkSamples = 8192;
+  juce::AudioBuffer<float> scratch;
+  for (const auto& item : items) {
+    const double sampleRate = item.file.getSampleRate();
+    const int numChannels = item.file.getNumChannels();
+    if (sampleRate <= 0.0 || numChannels <= 0) {
+      continue;
+    }
+    auto reader = cache.createReader(item.file);
+    if (reader == nullptr) {
+      continue;
+    }
+    const auto channels = juce::AudioChannelSet::canonicalChannelSet(numChannels);
+    scratch.setSize(numChannels, kChunkSamples, false, false, true);
+    reader->setReadPosition(static_cast<tracktion::engine::SampleCount>(item.sourceStartSeconds * sampleRate));
+    auto remaining = static_cast<int64_t>(item.lengthSeconds * sampleRate);
+    while (remaining > 0) {
+      const int numSamples = static_cast<int>(std::min<int64_t>(remaining, kChunkSamples));
+      if (!reader->readSamples(numSamples, scratch, channels, 0, channels, 250)) {
+        break;
+      }
+      remaining -= numSamples;
+    }
+  }
+}
+
+}  // namespace
+
+bool transportSetLoop(bool enabled, double startBeats, double endBeats, std::string& error) {
+  if (!isInitialised(error)) {
+    return false;
+  }
+  if (!requireEdit(error)) {
+    return false;
+  }
+  if (enabled && endBeats <= startBeats) {
+    error = "end must be after start";
+    return false;
+  }
+
+  runOnMessageThreadAndWait([enabled, startBeats, endBeats]() {
+    if (!gState || !gState->edit) {
+      return;
+    }
+    auto& transport = gState->edit->getTransport();
+    if (!enabled) {
+      transport.looping = false;
+      return;
+    }
+    const tracktion::core::TimeRange loopRange(
+      convertBeatsToTime(std::max(0.0, startBeats)),
+      convertBeatsToTime(endBeats)
+    );
+    // The graph's play head wraps at the loop end within the block, so no client-side seek
+    // (and no context reset) is involved.
+    transport.setLoopRange(loopRange);
+    transport.looping = true;
+    auto items = collectLoopPrefetchItems(loopRange);
+    if (!items.empty() && gState->backgroundPool != nullptr) {
+      gState->backgroundPool->addJob([items = std::move(items)]() { prefetchLoopStartRegions(items); });
+    }
+  });
+  error.clear();
+  return true;
+}
+
+/** Renders audio under a moving scrub position at variable speed. Targets arrive through a lock-free
+ *  FIFO; the device callback plays Hann-windowed, 50 % overlapped grains read from per-clip buffering
+ *  readers, so direction and speed changes crossfade instead of clicking. Mixed into the device output
+ *  next to Tracktion's own callback. */
+class ScrubEngine final : public juce::AudioIODeviceCallback {
+ public:
+  static constexpr int kGrainSamples = 256;
+  static constexpr int kHopSamples = kGrainSamples / 2;
+  static constexpr int kMaxChannels = 2;
+  static constexpr double kMaxRate = 4.0;
+  /** Below this rate a gliding playhead counts as stopped. */
+  static constexpr double kMinRate = 0.01;
+
+  explicit ScrubEngine(tracktion::engine::Engine& engineToUse) : engine(engineToUse), readThread("stuu scrub reader") {
+    for (int n = 0; n < kGrainSamples; ++n) {
+      const double phase = juce::MathConstants<double>::pi * static_cast<double>(n) / kGrainSamples;
+      window[static_cast<size_t>(n)] = static_cast<float>(std::sin(phase) * std::sin(phase));
+    }
+  }
+
+  ~ScrubEngine() override {
+    stop();
+  }
+
+  /** Collects clip sources on the message thread and starts the device callback. */
+  void start(tracktion::engine::Edit& edit, double startSeconds) {
+    stop();
+    auto& formats = engine.getAudioFileFormatManager().readFormatManager;
+    bool anySolo = false;
+    const auto tracks = cachedAudioTracks(edit);
+    for (auto* track : tracks) {
+      anySolo = anySolo || (track != nullptr && track->isSolo(false));
+    }
+    for (auto* track : tracks) {
+      if (track == nullptr || track->isMuted(false) || (anySolo && !track->isSolo(false))) {
+        continue;
+      }
+      float gain = 1.0F;
+      if (auto* volPan = track->getVolumePlugin()) {
+        gain = juce::Decibels::decibelsToGain(volPan->getVolumeDb());
+      }
+      for (auto* clip : track->getClips()) {
+        auto* wave = dynamic_cast<tracktion::engine::WaveAudioClip*>(clip);
+        if (wave == nullptr) {
+          continue;
+        }
+        auto* reader = formats.createReaderFor(wave->getAudioFile().getFile());
+        if (reader == nullptr) {
+          continue;
+        }
+        auto source = std::make_unique<Source>();
+        const auto position = wave->getPosition();
+        source->startSeconds = position.getStart().inSeconds();
+        source->endSeconds = position.getEnd().inSeconds();
+        source->offsetSeconds = position.getOffset().inSeconds();
+        source->sampleRate = reader->sampleRate;
+        source->numChannels = static_cast<int>(std::min<unsigned int>(reader->numChannels, kMaxChannels));
+        source->gain = gain * wave->getGainLinear();
+        source->reader = std::make_unique<juce::BufferingAudioReader>(reader, readThread, 1 << 17);
+        source->reader->setReadTimeout(0);
+        sources.push_back(std::move(source));
+      }
+    }
+    readThread.startThread();
+    playSeconds = startSeconds;
+    lastTargetSeconds = startSeconds;
+    targetSeconds.store(startSeconds);
+    rate = 0.0;
+    outReadPos = kHopSamples;
+    fifo.reset();
+    for (auto& channel : overlap) {
+      std::fill(channel.begin(), channel.end(), 0.0F);
+    }
+    engine.getDeviceManager().deviceManager.addAudioCallback(this);
+    running = true;
+  }
+
+  void stop() {
+    if (running) {
+      engine.getDeviceManager().deviceManager.removeAudioCallback(this);
+      running = false;
+    }
+    readThread.stopThread(1000);
+    sources.clear();
+  }
+
+  bool isRunning() const noexcept {
+    return running;
+  }
+
+  /** Producer side (socket thread). Drops the update if the FIFO is full; the next one supersedes it. */
+  void pushTarget(double positionSeconds, double velocity) {
+    const auto scope = fifo.write(1);
+    if (scope.blockSize1 > 0) {
+      updates[static_cast<size_t>(scope.startIndex1)] = {positionSeconds, velocity};
+    } else if (scope.blockSize2 > 0) {
+      updates[static_cast<size_t>(scope.startIndex2)] = {positionSeconds, velocity};
+    }
+    targetSeconds.store(positionSeconds);
+  }
+
+  /** Position the audition has reached (edit seconds). */
+  double getTargetSeconds() const noexcept {
+    return targetSeconds.load();
+  }
+
+  void audioDeviceAboutToStart(juce::AudioIODevice* device) override {
+    deviceSampleRate = device != nullptr && device->getCurrentSampleRate() > 0.0 ? device->getCurrentSampleRate() : 48000.0;
+    const int maxSpan = static_cast<int>(std::ceil(kMaxRate * kGrainSamples * 8.0)) + 4;
+    for (auto& source : sources) {
+      source->scratch.setSize(kMaxChannels, maxSpan, false, true, false);
+    }
+  }
+
+  void audioDeviceStopped() override {}
+
+  void audioDeviceIOCallbackWithContext(
+    const float* const*,
+    int,
+    float* const* outputChannelData,
+    int numOutputChannels,
+    int numSamples,
+    const juce::AudioIODeviceCallbackContext&
+  ) override {
+    drainUpdates(numSamples);
+    int written = 0;
+    while (written < numSamples) {
+      if (outReadPos >= kHopSamples) {
+        renderHop();
+        outReadPos = 0;
+      }
+      const int count = std::min(kHopSamples - outReadPos, numSamples - written);
+      for (int ch = 0; ch < numOutputChannels; ++ch) {
+        if (outputChannelData[ch] == nullptr) {
+          continue;
+        }
+        const auto& source = hopOutput[static_cast<size_t>(std::min(ch, kMaxChannels - 1))];
+        juce::FloatVectorOperations::copy(outputChannelData[ch] + written, source.data() + outReadPos, count);
+      }
+      outReadPos += count;
+      written += count;
+    }
+  }
+
+ private:
+  struct Source {
+    std::unique_ptr<juce::BufferingAudioReader> reader;
+    juce::AudioBuffer<float> scratch;
+    double startSeconds = 0.0;
+    double endSeconds = 0.0;
+    double offsetSeconds = 0.0;
+    double sampleRate = 44100.0;
+    int numChannels = 2;
+    float gain = 1.0F;
+  };
+
+  struct Update {
+    double positionSeconds = 0.0;
+    double velocity = 0.0;
+  };
+
+  /** Takes the newest target and derives the playback rate: explicit velocity wins, otherwise the
+   *  playhead chases the target so it arrives within one block. */
+  void drainUpdates(int numSamples) {
+    const double blockSeconds = static_cast<double>(std::max(1, numSamples)) / deviceSampleRate;
+    const int ready = fifo.getNumReady();
+    if (ready == 0) {
+      // Glide to a stop when updates pause, without running past the last target.
+      const double remaining = lastTargetSeconds - playSeconds;
+      rate *= 0.9;
+      if (std::abs(rate) < kMinRate || remaining * rate <= 0.0) {
+        rate = 0.0;
+      } else if (std::abs(rate) * blockSeconds > std::abs(remaining)) {
+        rate = remaining / blockSeconds;
+      }
+      return;
+    }
+    Update latest;
+    const auto scope = fifo.read(ready);
+    if (scope.blockSize2 > 0) {
+      latest = updates[static_cast<size_t>(scope.startIndex2 + scope.blockSize2 - 1)];
+    } else {
+      latest = updates[static_cast<size_t>(scope.startIndex1 + scope.blockSize1 - 1)];
+    }
+    lastTargetSeconds = latest.positionSeconds;
+    const double chase = (latest.positionSeconds - playSeconds) / blockSeconds;
+    const double nextRate = latest.velocity != 0.0 ? latest.velocity : chase;
+    rate = juce::jlimit(-kMaxRate, kMaxRate, nextRate);
+    if (std::abs(latest.positionSeconds - playSeconds) > kMaxRate * blockSeconds * 4.0) {
+      playSeconds = latest.positionSeconds;  // large jump: restart the grain stream at the target
+    }
+  }
+
+  void renderHop() {
+    std::array<std::array<float, kGrainSamples>, kMaxChannels> grain{};
+    const double grainSeconds = static_cast<double>(kGrainSamples) / deviceSampleRate;
+    const double centreSeconds = playSeconds + rate * grainSeconds * 0.5;
+    if (std::abs(rate) > 1.0e-3) {
+      for (auto& source : sources) {
+        if (centreSeconds < source->startSeconds || centreSeconds >= source->endSeconds) {
+          continue;
+        }
+        mixSourceIntoGrain(*source, grain);
+      }
+    }
+    for (int ch = 0; ch < kMaxChannels; ++ch) {
+      auto& out = hopOutput[static_cast<size_t>(ch)];
+      auto& tail = overlap[static_cast<size_t>(ch)];
+      const auto& g = grain[static_cast<size_t>(ch)];
+      for (int n = 0; n < kHopSamples; ++n) {
+        out[static_cast<size_t>(n)] = tail[static_cast<size_t>(n)] + g[static_cast<size_t>(n)] * window[static_cast<size_t>(n)];
+        tail[static_cast<size_t>(n)] = g[static_cast<size_t>(n + kHopSamples)] * window[static_cast<size_t>(n + kHopSamples)];
+      }
+    }
+    playSeconds = std::max(0.0, playSeconds + rate * static_cast<double>(kHopSamples) / deviceSampleRate);
+  }
+
+  void mixSourceIntoGrain(Source& source, std::array<std::array<float, kGrainSamples>, kMaxChannels>& grain) {
+    const double step = rate * source.sampleRate / deviceSampleRate;
+    const double firstPos = (playSeconds - source.startSeconds + source.offsetSeconds) * source.sampleRate;
+    const double lastPos = firstPos + step * (kGrainSamples - 1);
+    const auto readStart = static_cast<juce::int64>(std::floor(std::min(firstPos, lastPos))) - 1;
+    const int span = static_cast<int>(std::ceil(std::abs(lastPos - firstPos))) + 4;
+    if (span > source.scratch.getNumSamples() || readStart + span < 0) {
+      return;
+    }
+    source.scratch.clear(0, span);
+    source.reader->read(source.scratch.getArrayOfWritePointers(), source.numChannels, readStart, span);
+    for (int ch = 0; ch < kMaxChannels; ++ch) {
+      const float* data = source.scratch.getReadPointer(std::min(ch, source.numChannels - 1));
+      auto& dest = grain[static_cast<size_t>(ch)];
+      for (int n = 0; n < kGrainSamples; ++n) {
+        const double pos = firstPos + step * n - static_cast<double>(readStart);
+        const int i = juce::jlimit(0, span - 2, static_cast<int>(pos));
+        const float frac = static_cast<float>(pos - i);
+        dest[static_cast<size_t>(n)] += source.gain * (data[i] + frac * (data[i + 1] - data[i]));
+      }
+    }
+  }
+
+  tracktion::engine::Engine& engine;
+  juce::TimeSliceThread readThread;
+  std::vector<std::unique_ptr<Source>> sources;
+  juce::AbstractFifo fifo{64};
+  std::array<Update, 64> updates{};
+  std::atomic<double> targetSeconds{0.0};
+  std::array<float, kGrainSamples> window{};
+  std::array<std::array<float, kHopSamples>, kMaxChannels> overlap{};
+  std::array<std::array<float, kHopSamples>, kMaxChannels> hopOutput{};
+  double deviceSampleRate = 48000.0;
+  double playSeconds = 0.0;
+  double lastTargetSeconds = 0.0;
+  double rate = 0.0;
+  int outReadPos = kHopSamples;
+  bool running = false;
+};
+
+bool transportScrub(ScrubAction action, double positionBeats, double velocityBeatsPerSecond, std::string& error) {
+  if (!isInitialised(error)) {
+    return false;
+  }
+  if (!requireEdit(error)) {
+    return false;
+  }
+
+  const double positionSeconds = convertBeatsToTime(std::max(0.0, positionBeats)).inSeconds();
+  const double bpm = getBpmFromEdit();
+  const double velocity = bpm > 0.0 ? velocityBeatsPerSecond * 60.0 / bpm : 0.0;
+
+  if (action == ScrubAction::update && gState->scrub != nullptr && gState->scrub->isRunning()) {
+    // Hot path: no message-thread hop, just a FIFO push consumed by the device callback.
+    gState->scrub->pushTarget(positionSeconds, velocity);
+    error.clear();
+    return true;
+  }
+
+  runOnMessageThreadAndWait([action, positionSeconds, velocity]() {
+    if (!gState || !gState->edit) {
+      return;
+    }
+    auto& transport = gState->edit->getTransport();
+    if (action == ScrubAction::end) {
+      if (gState->scrub != nullptr && gState->scrub->isRunning()) {
+        const double finalSeconds = gState->scrub->getTargetSeconds();
+        gState->scrub->stop();
+        transport.setPosition(tracktion::core::TimePosition::fromSeconds(finalSeconds));
+      }
+      return;
+    }
+    if (gState->scrub == nullptr) {
+      gState->scrub = std::make_shared<ScrubEngine>(*gState->engine);
+    }
+    if (!gState->scrub->isRunning()) {
+      transport.stop(false, false, true);
+      gState->scrub->start(*gState->edit, positionSeconds);
+    }
+    gState->scrub->pushTarget(positionSeconds, velocity);
+  });
+  error.clear();
+  return true;
+}
+
+bool setMetronome(const MetronomeSettings& settings, MetronomeSettings& applied, std::string& error) {
+  applied = {};
+  if (!isInitialised(error)) {
+    return false;
+  }
+  if (!requireEdit(error)) {
+    return false;
+  }
+
+  applied.level = juce::jlimit(0.0, 1.0, std::isfinite(settings.level) ? settings.level : 0.6);
+  // Tracktion keeps a floor on the click volume, so level 0 would still click: it turns the click off.
+  applied.enabled = settings.enabled && applied.level > 0.0;
+  applied.accentBars = settings.accentBars;
+  applied.countInBars = juce::jlimit<int32_t>(0, 2, settings.countInBars);
+
+  runOnMessageThreadAndWait([&applied]() {
+    if (!gState || !gState->edit) {
+      return;
+    }
+    auto& edit = *gState->edit;
+    // Tracktion's ClickNode loads its click samples when the graph is built and derives click
+    // positions from tempoSequence, so the click stays phase-locked to playback.
+    edit.clickTrackEnabled = applied.enabled;
+    edit.clickTrackGain = static_cast<float>(applied.level);
+    edit.clickTrackEmphasiseBars = applied.accentBars;
+    edit.clickTrackRecordingOnly = false;
+    using CountIn = tracktion::engine::Edit::CountIn;
+    edit.setCountInMode(applied.countInBars == 2 ? CountIn::twoBar : applied.countInBars == 1 ? CountIn::oneBar : CountIn::none);
+    std::fprintf(stderr, "[thestuu-native] metronome enabled=%d level=%.2f accent=%d countIn=%d\n",
+                 applied.enabled ? 1 : 0, applied.level, applied.accentBars ? 1 : 0, static_cast<int>(applied.countInBars));
+  });
+  transportRebuildGraphOnly();
+  error.clear();
+  return true;
+}
+
+namespace {
+
+constexpr int kMaxAuxBuses = 32;
+
+BusEntry* findBus(int32_t busId) {
+  if (!gState || busId < 1 || busId > static_cast<int32_t>(gState->buses.size())) {
+    return nullptr;
+  }
+  return &gState->buses[static_cast<size_t>(busId - 1)];
+}
+
+tracktion::engine::AudioTrack* findBusTrack(const BusEntry& bus) {
+  if (!gState || !gState->edit) {
+    return nullptr;
+  }
+  return dynamic_cast<tracktion::engine::AudioTrack*>(tracktion::engine::findTrackForID(*gState->edit, bus.trackItemId));
+}
+
+void routeToDefaultOutput(tracktion::engine::AudioTrack& track) {
+  const juce::String defaultOutId = track.edit.engine.getDeviceManager().getDefaultWaveOutDeviceID();
+  if (defaultOutId.isNotEmpty()) {
+    track.getOutput().setOutputToDeviceID(defaultOutId);
+  } else {
+    track.getOutput().setOutputToDefaultDevice(false);
+  }
+}
+
+tracktion::engine::AuxSendPlugin* findAuxSend(tracktion::engine::AudioTrack& track, int auxBusNumber) {
+  for (auto* plugin : track.pluginList) {
+    if (auto* send = dynamic_cast<tracktion::engine::AuxSendPlugin*>(plugin)) {
+      if (send->busNumber.get() == auxBusNumber) {
+        return send;
+      }
+    }
+  }
+  return nullptr;
+}
+
+/** Aux bus numbers are shared by the user's aux buses and the hidden sidechain taps. */
+int nextAuxBusNumber() {
+  int next = 0;
+  for (const auto& bus : gState->buses) {
+    next = std::max(next, bus.auxBusNumber + 1);
+  }
+  for (const auto& tap : gState->sidechainTaps) {
+    next = std::max(next, tap.auxBusNumber + 1);
+  }
+  return next;
+}
+
+/** Bus and tap tracks go behind every other track, so existing 1-based track ids stay valid. */
+tracktion::engine::AudioTrack::Ptr appendTrackBehindAll(const juce::String& name) {
+  auto& edit = *gState->edit;
+  auto allTracks = tracktion::engine::getAllTracks(edit);
+  auto track = edit.insertNewAudioTrack(tracktion::engine::TrackInsertPoint(nullptr, allTracks.getLast()), nullptr);
+  if (track != nullptr) {
+    track->setName(name);
+  }
+  return track;
+}
+
+/** The track every sidechain tap outputs into. Its fader is closed: the taps stay in the graph (a
+ *  track that outputs nowhere is not processed) without being heard. */
+tracktion::engine::AudioTrack* ensureSidechainSink(std::string& error) {
+  if (gState->sidechainSinkId.isValid()) {
+    if (auto* sink = dynamic_cast<tracktion::engine::AudioTrack*>(
+          tracktion::engine::findTrackForID(*gState->edit, gState->sidechainSinkId))) {
+      return sink;
+    }
+  }
+  auto sink = appendTrackBehindAll("Sidechain Sink");
+  auto* volPan = sink != nullptr ? sink->getVolumePlugin() : nullptr;
+  if (volPan == nullptr) {
+    if (sink != nullptr) {
+      gState->edit->deleteTrack(sink.get());
+    }
+    error = "failed to create sidechain sink";
+    return nullptr;
+  }
+  volPan->setSliderPos(0.0F);
+  routeToDefaultOutput(*sink);
+  gState->sidechainSinkId = sink->itemID;
+  gState->trackCache.invalidate();
+  return sink.get();
+}
+
+/** Hidden aux bus carrying \a source's signal from in front of its fader. The pre-fader send is
+ *  inserted before the source's volume plugin, so plugin indices behind it move up by one. */
+tracktion::engine::AudioTrack* ensureSidechainTap(tracktion::engine::AudioTrack& source, std::string& error) {
+  for (const auto& tap : gState->sidechainTaps) {
+    if (tap.sourceTrackId == source.itemID) {
+      if (auto* tapTrack = dynamic_cast<tracktion::engine::AudioTrack*>(
+            tracktion::engine::findTrackForID(*gState->edit, tap.tapTrackId))) {
+        return tapTrack;
+      }
+    }
+  }
+  const int auxBusNumber = nextAuxBusNumber();
+  if (auxBusNumber >= kMaxAuxBuses) {
+    error = "aux bus limit reached (32)";
+    return nullptr;
+  }
+  auto* sink = ensureSidechainSink(error);
+  if (sink == nullptr) {
+    return nullptr;
+  }
+  auto& edit = *gState->edit;
+  auto tapTrack = appendTrackBehindAll("Sidechain Tap " + source.getName());
+  juce::PluginDescription ignored;
+  auto returnPlugin = edit.getPluginCache().createNewPlugin(tracktion::engine::AuxReturnPlugin::xmlTypeName, ignored);
+  auto sendPlugin = edit.getPluginCache().createNewPlugin(tracktion::engine::AuxSendPlugin::xmlTypeName, ignored);
+  auto* auxReturn = dynamic_cast<tracktion::engine::AuxReturnPlugin*>(returnPlugin.get());
+  auto* auxSend = dynamic_cast<tracktion::engine::AuxSendPlugin*>(sendPlugin.get());
+  if (tapTrack == nullptr || auxReturn == nullptr || auxSend == nullptr) {
+    if (tapTrack != nullptr) {
+      edit.deleteTrack(tapTrack.get());
+    }
+    error = "failed to create pre-fader sidechain tap";
+    return nullptr;
+  }
+  auxReturn->busNumber = auxBusNumber;
+  tapTrack->pluginList.insertPlugin(returnPlugin, 0, nullptr);
+  tapTrack->getOutput().setOutputToTrack(sink);
+  auxSend->busNumber = auxBusNumber;
+  const int faderIndex = source.pluginList.indexOf(source.getVolumePlugin());
+  source.pluginList.insertPlugin(sendPlugin, faderIndex >= 0 ? faderIndex : 0, nullptr);
+
+  gState->sidechainTaps.push_back({source.itemID, tapTrack->itemID, auxBusNumber});
+  gState->trackCache.invalidate();
+  return tapTrack.get();
+}
+
+/** Removes taps no plugin reads from any more (and the sink with the last one). */
+void removeUnusedSidechainTaps() {
+  auto& edit = *gState->edit;
+  auto& taps = gState->sidechainTaps;
+  for (auto it = taps.begin(); it != taps.end();) {
+    bool used = false;
+    for (auto* track : tracktion::engine::getAudioTracks(edit)) {
+      for (auto* plugin : track->pluginList) {
+        used = used || plugin->getSidechainSourceID() == it->tapTrackId;
+      }
+    }
+    if (used) {
+      ++it;
+      continue;
+    }
+    if (auto* source = dynamic_cast<tracktion::engine::AudioTrack*>(tracktion::engine::findTrackForID(edit, it->sourceTrackId))) {
+      if (auto* send = findAuxSend(*source, it->auxBusNumber)) {
+        send->deleteFromParent();
+      }
+    }
+    if (auto* tapTrack = tracktion::engine::findTrackForID(edit, it->tapTrackId)) {
+      edit.deleteTrack(tapTrack);
+    }
+    it = taps.erase(it);
+    gState->trackCache.invalidate();
+  }
+  if (taps.empty() && gState->sidechainSinkId.isValid()) {
+    if (auto* sink = tracktion::engine::findTrackForID(edit, gState->sidechainSinkId)) {
+      edit.deleteTrack(sink);
+    }
+    gState->sidechainSinkId = {};
+    gState->trackCache.invalidate();
+  }
+}
+
+/** Message thread. Recomputes gState->sidechainSources; call after any sidechain routing change. */
+void refreshSidechainSources() {
+  auto& sources = gState->sidechainSources;
+  sources.clear();
+  for (auto* track : cachedAudioTracks(*gState->edit)) {
+    for (auto* plugin : track->pluginList) {
+      const auto sourceId = plugin->getSidechainSourceID();
+      if (!sourceId.isValid()) {
+        continue;
+      }
+      sources.insert(sourceId.getRawID());
+      for (const auto& tap : gState->sidechainTaps) {
+        if (tap.tapTrackId == sourceId) {
+          sources.insert(tap.sourceTrackId.getRawID());
+        }
+      }
+    }
+  }
+}
+
+bool createBusImpl(const std::string& kind, const std::string& name, BusInfo& result, std::string& error) {
+  auto& edit = *gState->edit;
+  int auxBusNumber = -1;
+  if (kind == "aux") {
+    auxBusNumber = nextAuxBusNumber();
+    if (auxBusNumber >= kMaxAuxBuses) {
+      error = "aux bus limit reached (32)";
+      return false;
+    }
+  } else if (kind != "submix") {
+    error = "bus kind must be aux or submix";
+    return false;
+  }
+
+  const juce::String busName = name.empty()
+    ? juce::String(kind == "aux" ? "Aux " : "Submix ") + juce::String(static_cast<int>(gState->buses.size()) + 1)
+    : juce::String::fromUTF8(name.c_str());
+  auto track = appendTrackBehindAll(busName);
+  if (track == nullptr) {
+    error = "failed to create bus track";
+    return false;
+  }
+  routeToDefaultOutput(*track);
+
+  if (auxBusNumber >= 0) {
+    juce::PluginDescription ignored;
+    auto plugin = edit.getPluginCache().createNewPlugin(tracktion::engine::AuxReturnPlugin::xmlTypeName, ignored);
+    auto* auxReturn = dynamic_cast<tracktion::engine::AuxReturnPlugin*>(plugin.get());
+    if (auxReturn == nullptr) {
+      // Don't leave a bus track behind that no BusEntry refers to.
+      edit.deleteTrack(track.get());
+      error = "failed to create aux return";
+      return false;
+    }
+    auxReturn->busNumber = auxBusNumber;
+    // Return first, so effects loaded onto the bus process the summed sends once.
+    track->pluginList.insertPlugin(plugin, 0, nullptr);
+    edit.setAuxBusName(auxBusNumber, busName);
+  }
+
+  gState->buses.push_back({track->itemID, kind, busName.toStdString(), auxBusNumber});
+  gState->trackCache.invalidate();
+  result.busId = static_cast<int32_t>(gState->buses.size());
+  result.kind = kind;
+  result.name = busName.toStdString();
+  result.auxBusNumber = auxBusNumber;
+  return true;
+}
+
+bool setTrackSendImpl(const TrackSendRequest& request, TrackSendResult& result, std::string& error) {
+  auto* track = getAudioTrackByIndex(request.trackId);
+  if (track == nullptr) {
+    error = "track_id out of range";
+    return false;
+  }
+  noteTrackEdited(*track);
+  const auto* bus = findBus(request.busId);
+  if (bus == nullptr || bus->auxBusNumber < 0) {
+    error = "bus_id is not an aux bus";
+    return false;
+  }
+
+  tracktion::engine::Plugin::Ptr send = findAuxSend(*track, bus->auxBusNumber);
+  if (request.remove) {
+    if (send != nullptr) {
+      send->deleteFromParent();
+    }
+    result = {request.trackId, request.busId, -1, 0.0, request.preFader};
+    return true;
+  }
+
+  const int faderIndex = track->pluginList.indexOf(track->getVolumePlugin());
+  const int wantedIndex = request.preFader && faderIndex >= 0 ? faderIndex : track->pluginList.size();
+  if (send == nullptr) {
+    juce::PluginDescription ignored;
+    send = gState->edit->getPluginCache().createNewPlugin(tracktion::engine::AuxSendPlugin::xmlTypeName, ignored);
+    auto* auxSend = dynamic_cast<tracktion::engine::AuxSendPlugin*>(send.get());
+    if (auxSend == nullptr) {
+      error = "failed to create aux send";
+      return false;
+    }
+    auxSend->busNumber = bus->auxBusNumber;
+    track->pluginList.insertPlugin(send, wantedIndex, nullptr);
+  } else {
+    const int currentIndex = track->pluginList.indexOf(send.get());
+    const bool isPreFader = faderIndex >= 0 && currentIndex < faderIndex;
+    if (isPreFader != request.preFader) {
+      send->removeFromParent();
+      const int faderAfterRemove = track->pluginList.indexOf(track->getVolumePlugin());
+      const int insertIndex = request.preFader && faderAfterRemove >= 0 ? faderAfterRemove : track->pluginList.size();
+      track->pluginList.insertPlugin(send, insertIndex, nullptr);
+    }
+  }
+
+  auto* auxSend = dynamic_cast<tracktion::engine::AuxSendPlugin*>(send.get());
+  const float levelDb = juce::jlimit(-100.0F, 6.0F, static_cast<float>(request.levelDb));
+  auxSend->setGainDb(levelDb);
+
+  result.trackId = request.trackId;
+  result.busId = request.busId;
+  result.pluginIndex = track->pluginList.indexOf(send.get());
+  result.levelDb = levelDb;
+  result.preFader = request.preFader;
+  return true;
+}
+
+bool setTrackOutputBusImpl(int32_t trackId, int32_t busId, std::string& error) {
+  auto* track = getAudioTrackByIndex(trackId);
+  if (track == nullptr) {
+    error = "track_id out of range";
+    return false;
+  }
+  if (busId == 0) {
+    routeToDefaultOutput(*track);
+    return true;
+  }
+  const auto* bus = findBus(busId);
+  auto* busTrack = bus != nullptr ? findBusTrack(*bus) : nullptr;
+  if (busTrack == nullptr) {
+    error = "bus_id out of range";
+    return false;
+  }
+  track->getOutput().setOutputToTrack(busTrack);
+  return true;
+}
+
+}  // namespace
+
+bool createBus(const std::string& kind, const std::string& name, BusInfo& result, std::string& error) {
+  result = {};
+  if (!isInitialised(error) || !requireEdit(error)) {
+    return false;
+  }
+  bool ok = false;
+  runOnMessageThreadAndWait([&]() {
+    try {
+      ok = createBusImpl(kind, name, result, error);
+      if (ok) {
+        transportRebuildGraphOnlyImpl();
+      }
+    } catch (const std::exception& ex) {
+      error = ex.what();
+    } catch (...) {
+      error = "unknown error during bus:create";
+    }
+  });
+  if (ok) {
+    error.clear();
+  } else if (error.empty()) {
+    error = "timeout during bus:create (message thread)";
+  }
+  return ok;
+}
+
+bool setTrackSend(const TrackSendRequest& request, TrackSendResult& result, std::string& error) {
+  result = {};
+  if (!isInitialised(error) || !requireEdit(error)) {
+    return false;
+  }
+  bool ok = false;
+  runOnMessageThreadAndWait([&]() {
+    try {
+      ok = setTrackSendImpl(request, result, error);
+      if (ok) {
+        transportRebuildGraphOnlyImpl();
+      }
+    } catch (const std::exception& ex) {
+      error = ex.what();
+    } catch (...) {
+      error = "unknown error during bus:send";
+    }
+  });
+  if (ok) {
+    error.clear();
+  } else if (error.empty()) {
+    error = "timeout during bus:send (message thread)";
+  }
+  return ok;
+}
+
+bool setTrackOutputBus(int32_t trackId, int32_t busId, std::string& error) {
+  if (!isInitialised(error) || !requireEdit(error)) {
+    return false;
+  }
+  bool ok = false;
+  runOnMessageThreadAndWait([&]() {
+    try {
+      ok = setTrackOutputBusImpl(trackId, busId, error);
+      if (ok) {
+        transportRebuildGraphOnlyImpl();
+      }
+    } catch (const std::exception& ex) {
+      error = ex.what();
+    } catch (...) {
+      error = "unknown error during bus:route";
+    }
+  });
+  if (ok) {
+    error.clear();
+  } else if (error.empty()) {
+    error = "timeout during bus:route (message thread)";
+  }
+  return ok;
+}
+
+bool loadBusPlugin(const std::string& pluginUid, int32_t busId, LoadPluginResult& result, std::string& error) {
+  result = {};
+  if (!isInitialised(error) || !requireEdit(error)) {
+    return false;
+  }
+
+  bool ok = false;
+  runOnMessageThreadAndWait([&]() {
+    try {
+      tracktion::engine::PluginList* list = nullptr;
+      if (!gState->edit) {
+        error = "no edit loaded";
+        return;
+      }
+      if (busId == 0) {
+        list = &gState->edit->getMasterPluginList();
+      } else if (const auto* bus = findBus(busId)) {
+        if (auto* busTrack = findBusTrack(*bus)) {
+          list = &busTrack->pluginList;
+        }
+      }
+      if (list == nullptr) {
+        error = "bus_id out of range";
+        return;
+      }
+
+      CreatedPlugin created;
+      if (!createPluginForUid(pluginUid, created, error)) {
+        return;
+      }
+      if (!appendCreatedPlugin(*list, created, result, error)) {
+        return;
+      }
+      result.trackId = 0;
+      ok = true;
+    } catch (const std::exception& ex) {
+      error = ex.what();
+    } catch (...) {
+      error = "unknown error during bus:plugin:load";
+    }
+  });
+  if (ok) {
+    error.clear();
+  } else {
+    result = {};
+    if (error.empty()) {
+      error = "timeout during bus:plugin:load (message thread)";
+    }
+  }
+  return ok;
+}
+
+namespace {
+
+/** Volume/pan and level meter belong to the track itself, not to the user FX chain. */
+bool isTrackCorePlugin(const tracktion::engine::Plugin& plugin) {
+  return dynamic_cast<const tracktion::engine::VolumeAndPanPlugin*>(&plugin) != nullptr
+    || dynamic_cast<const tracktion::engine::LevelMeterPlugin*>(&plugin) != nullptr;
+}
+
+/** An empty track cannot produce or feed anything: no clips, nothing armed, only volume/pan and meter. */
+bool isEmptyTrack(tracktion::engine::AudioTrack& track) {
+  if (!track.getClips().isEmpty() || track.getWaveInputDevice().isEnabled()) {
+    return false;
+  }
+  for (auto* plugin : track.pluginList) {
+    if (plugin != nullptr && !isTrackCorePlugin(*plugin)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/** Dormancy only flips the runtime processing flag of volume/pan and meter, so the track's nodes skip
+ *  their blocks; like silence suspension, nothing of it ends up in the saved edit. */
+void setCoreProcessing(tracktion::engine::AudioTrack& track, bool shouldProcess) {
+  for (auto* plugin : track.pluginList) {
+    if (plugin != nullptr && isTrackCorePlugin(*plugin)) {
+      plugin->setProcessingEnabled(shouldProcess);
+    }
+  }
+}
+
+bool isDormant(const tracktion::engine::AudioTrack& track) {
+  std::lock_guard<std::mutex> lock(gState->dormantMutex);
+  return gState->dormantTracks.count(track.itemID.getRawID()) > 0;
+}
+
+/** Message thread. */
+void wakeDormantTrack(tracktion::engine::EditItemID trackId) {
+  if (!gState || !gState->edit) {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(gState->dormantMutex);
+    if (gState->dormantTracks.erase(trackId.getRawID()) == 0) {
+      return;
+    }
+  }
+  if (auto* track = dynamic_cast<tracktion::engine::AudioTrack*>(tracktion::engine::findTrackForID(*gState->edit, trackId))) {
+    setCoreProcessing(*track, true);
+  }
+}
+
+tracktion::engine::Plugin* findChainPlugin(
+  int32_t trackId,
+  int32_t pluginIndex,
+  tracktion::engine::AudioTrack*& track,
+  std::string& error
+) {
+  track = getAudioTrackByIndex(trackId);
+  if (track == nullptr) {
+    error = "track_id out of range";
+    return nullptr;
+  }
+  noteTrackEdited(*track);
+  if (pluginIndex < 0 || pluginIndex >= track->pluginList.size()) {
+    error = "plugin_index out of range";
+    return nullptr;
+  }
+  auto* plugin = track->pluginList[pluginIndex];
+  if (plugin == nullptr) {
+    error = "plugin not found on track";
+    return nullptr;
+  }
+  if (isTrackCorePlugin(*plugin)) {
+    error = "plugin_index refers to the track's volume/meter plugin";
+    return nullptr;
+  }
+  return plugin;
+}
+
+/** Runs \a fn on the message thread with the usual try/catch; \a fn sets error on failure. */
+bool runChainOperation(const char* commandName, const std::function<bool(std::string&)>& fn, std::string& error) {
+  bool ok = false;
+  runOnMessageThreadAndWait([&]() {
+    try {
+      ok = fn(error);
+    } catch (const std::exception& ex) {
+      error = ex.what();
+    } catch (...) {
+      error = std::string("unknown error during ") + commandName;
+    }
+  });
+  if (ok) {
+    error.clear();
+  } else if (error.empty()) {
+    error = std::string("timeout during ") + commandName + " (message thread)";
+  }
+  return ok;
+}
+
+}  // namespace
+
+bool removePlugin(int32_t trackId, int32_t pluginIndex, std::string& error) {
+  if (!isInitialised(error) || !requireEdit(error)) {
+    return false;
+  }
+  return runChainOperation("vst:remove", [&](std::string& err) {
+    tracktion::engine::AudioTrack* track = nullptr;
+    auto* plugin = findChainPlugin(trackId, pluginIndex, track, err);
+    if (plugin == nullptr) {
+      return false;
+    }
+    const bool readsSidechain = plugin->getSidechainSourceID().isValid();
+    plugin->deleteFromParent();
+    if (readsSidechain) {
+      refreshSidechainSources();
+    }
+    return true;
+  }, error);
+}
+
+bool movePlugin(int32_t trackId, int32_t fromIndex, int32_t toIndex, std::string& error) {
+  if (!isInitialised(error) || !requireEdit(error)) {
+    return false;
+  }
+  return runChainOperation("vst:move", [&](std::string& err) {
+    tracktion::engine::AudioTrack* track = nullptr;
+    auto* plugin = findChainPlugin(trackId, fromIndex, track, err);
+    if (plugin == nullptr) {
+      return false;
+    }
+    if (toIndex < 0 || toIndex >= track->pluginList.size()) {
+      err = "to_index out of range";
+      return false;
+    }
+    if (toIndex == fromIndex) {
+      return true;
+    }
+    // One ValueTree move: the PluginList reorders in place (instances and their state are kept)
+    // and the edit restarts playback once, instead of a remove + insert pair.
+    auto parent = plugin->state.getParent();
+    const int fromChild = parent.indexOf(plugin->state);
+    const int toChild = parent.indexOf(track->pluginList[toIndex]->state);
+    if (fromChild < 0 || toChild < 0) {
+      err = "plugin state not found on track";
+      return false;
+    }
+    parent.moveChild(fromChild, toChild, nullptr);
+    return true;
+  }, error);
+}
+
+bool setPluginBypass(int32_t trackId, int32_t pluginIndex, bool bypass, std::string& error) {
+  if (!isInitialised(error) || !requireEdit(error)) {
+    return false;
+  }
+  return runChainOperation("vst:bypass", [&](std::string& err) {
+    tracktion::engine::AudioTrack* track = nullptr;
+    auto* plugin = findChainPlugin(trackId, pluginIndex, track, err);
+    if (plugin == nullptr) {
+      return false;
+    }
+    // The plugin node checks isEnabled() per block, so this takes effect without a graph rebuild.
+    plugin->setEnabled(!bypass);
+    // The user owns this plugin's state now; low-latency monitoring must not restore it later.
+    auto& bypassed = gState->lowLatencyBypassed;
+    bypassed.erase(
+      std::remove_if(bypassed.begin(), bypassed.end(), [&](const auto& entry) { return entry.pluginId == plugin->itemID; }),
+      bypassed.end()
+    );
+    return true;
+  }, error);
+}
+
+bool getEqualiserSpectrum(const EqualiserSpectrumRequest& request, EqualiserSpectrum& spectrum, std::string& error) {
+  spectrum = {};
+  if (!isInitialised(error) || !requireEdit(error)) {
+    return false;
+  }
+  if (request.binCount < 2 || request.binCount > 1024) {
+    error = "bins must be between 2 and 1024";
+    return false;
+  }
+  if (!(request.minHz > 0.0) || !(request.maxHz > request.minHz)) {
+    error = "min_hz must be positive and below max_hz";
+    return false;
+  }
+  return runChainOperation("eq:spectrum", [&](std::string& err) {
+    tracktion::engine::AudioTrack* track = nullptr;
+    auto* plugin = findChainPlugin(request.trackId, request.pluginIndex, track, err);
+    if (plugin == nullptr) {
+      return false;
+    }
+    auto* equaliser = dynamic_cast<AnalysedEqualiserPlugin*>(plugin);
+    if (equaliser == nullptr) {
+      err = "plugin_index does not refer to a 4-band EQ";
+      return false;
+    }
+    equaliser->analyser.keepAlive();
+    spectrum.sampleRate = equaliser->analyser.getSampleRate();
+    spectrum.live = equaliser->analyser.hasSignal();
+    equaliser->analyser.getLogBins(request.binCount, request.minHz, request.maxHz, spectrum.preDb, spectrum.postDb);
+    return true;
+  }, error);
+}
+
+bool setPluginSidechain(const SidechainRequest& request, std::string& error) {
+  if (!isInitialised(error) || !requireEdit(error)) {
+    return false;
+  }
+  bool ok = false;
+  runOnMessageThreadAndWait([&]() {
+    try {
+      auto* track = getAudioTrackByIndex(request.trackId);
+      if (track == nullptr) {
+        error = "track_id out of range";
+        return;
+      }
+      noteTrackEdited(*track);
+      if (request.pluginIndex < 0 || request.pluginIndex >= track->pluginList.size()) {
+        error = "plugin_index out of range";
+        return;
+      }
+      auto* plugin = track->pluginList[request.pluginIndex];
+      if (plugin == nullptr || !plugin->canSidechain()) {
+        error = "plugin has no sidechain input";
+        return;
+      }
+
+      if (request.sourceTrackId == 0) {
+        plugin->setSidechainSourceID({});
+      } else {
+        auto* source = getAudioTrackByIndex(request.sourceTrackId);
+        if (source == nullptr || source == track) {
+          error = "source_track_id out of range";
+          return;
+        }
+        // Tracktion reads a sidechain at the source track's output, i.e. after its fader. Post-fader
+        // sources are read directly; pre-fader ones go through a hidden tap bus fed in front of the fader.
+        tracktion::engine::AudioTrack* sidechainTrack = source;
+        if (request.preFader) {
+          noteTrackEdited(*source);
+          sidechainTrack = ensureSidechainTap(*source, error);
+          if (sidechainTrack == nullptr) {
+            return;
+          }
+        }
+        plugin->setSidechainSourceID(sidechainTrack->itemID);
+        plugin->guessSidechainRouting();
+      }
+      removeUnusedSidechainTaps();
+      refreshSidechainSources();
+      transportRebuildGraphOnlyImpl();
+      ok = true;
+    } catch (const std::exception& ex) {
+      error = ex.what();
+    } catch (...) {
+      error = "unknown error during vst:set-sidechain";
+    }
+  });
+  if (ok) {
+    error.clear();
+  } else if (error.empty()) {
+    error = "timeout during vst:set-sidechain (message thread)";
+  }
+  return ok;
+}
+
+namespace {
+
+void pushLoadEvent(PluginLoadEvent event) {
+  std::lock_guard<std::mutex> lock(gState->loadEventMutex);
+  gState->loadEvents.push_back(std::move(event));
+}
+
+/** UIDs the pool should hold: configured ones, then the most loaded ones up to topN. */
+std::vector<std::string> collectPoolTargets() {
+  std::lock_guard<std::mutex> lock(gState->poolMutex);
+  std::vector<std::string> targets = gState->poolConfig.uids;
+  std::vector<std::pair<std::string, int32_t>> ranked(gState->loadCountByUid.begin(), gState->loadCountByUid.end());
+  std::sort(ranked.begin(), ranked.end(), [](const auto& a, const auto& b) { return a.second > b.second; });
+  for (int32_t i = 0; i < gState->poolConfig.topN && i < static_cast<int32_t>(ranked.size()); ++i) {
+    if (std::find(targets.begin(), targets.end(), ranked[static_cast<size_t>(i)].first) == targets.end()) {
+      targets.push_back(ranked[static_cast<size_t>(i)].first);
+    }
+  }
+  return targets;
+}
+
+/** Instances pooled for \a uid, and how many the pool should hold. */
+std::pair<int32_t, int32_t> pooledCount(const std::string& uid) {
+  std::lock_guard<std::mutex> lock(gState->poolMutex);
+  auto found = gState->prewarmedByUid.find(uid);
+  const int32_t count = found == gState->prewarmedByUid.end() ? 0 : static_cast<int32_t>(found->second.size());
+  return {count, gState->poolConfig.perUid};
+}
+
+/** Tracktion plugins belong to the message thread; worker threads hand their last reference over. */
+void releaseOnMessageThread(std::vector<tracktion::engine::Plugin::Ptr> plugins) {
+  if (plugins.empty()) {
+    return;
+  }
+  juce::MessageManager::callAsync([plugins = std::move(plugins)]() mutable { plugins.clear(); });
+}
+
+void schedulePluginPoolRefill();
+
+/** Loader thread. Builds at most one instance per job, so a refill never delays a queued load by more
+ *  than one plugin construction. */
+void refillPluginPoolStep() {
+  if (!gState || !gState->edit) {
+    if (gState) {
+      gState->poolRefillPending = false;
+    }
+    return;
+  }
+  for (const auto& uid : collectPoolTargets()) {
+    const auto [pooled, target] = pooledCount(uid);
+    if (pooled >= target) {
+      continue;
+    }
+    std::string ignoredError;
+    CreatedPlugin created;
+    bool ok = false;
+    try {
+      ok = createPluginForUid(uid, created, ignoredError, false);
+      if (ok) {
+        created.plugin->initialiseFully();
+      }
+    } catch (const std::exception& ex) {
+      ok = false;
+      ignoredError = ex.what();
+    }
+    if (ok) {
+      if (!offerPrewarmedPlugin(created.uid, created.plugin)) {
+        releaseOnMessageThread({std::move(created.plugin)});
+      }
+      gState->pluginLoader->addJob(refillPluginPoolStep);
+      return;
+    }
+    releaseOnMessageThread({std::move(created.plugin)});
+    std::fprintf(stderr, "[thestuu-native] plugin pool: cannot prewarm %s: %s\n", uid.c_str(), ignoredError.c_str());
+    std::lock_guard<std::mutex> lock(gState->poolMutex);
+    auto& targets = gState->poolConfig.uids;
+    targets.erase(std::remove(targets.begin(), targets.end(), uid), targets.end());
+    gState->loadCountByUid.erase(uid);
+  }
+  gState->poolRefillPending = false;
+}
+
+void schedulePluginPoolRefill() {
+  if (gState->poolRefillPending.exchange(true)) {
+    return;
+  }
+  gState->pluginLoader->addJob(refillPluginPoolStep);
+}
+
+/** One vst:load async, shared by the loader job and the hand-over on the message thread. */
+struct PluginLoadJob {
+  int64_t loadId = 0;
+  int64_t editGeneration = 0;
+  std::string pluginUid;
+  int32_t trackId = 0;
+  CreatedPlugin created;
+  std::string error;
+};
+
+bool isStaleLoad(const PluginLoadJob& job) {
+  return !gState || !gState->edit || job.editGeneration != gState->editGeneration.load();
+}
+
+/** Message thread. Inserting into the track is the only step of a load that needs it. */
+void finishPluginLoad(const std::shared_ptr<PluginLoadJob>& job) {
+  PluginLoadEvent done{job->loadId, "done", 1.0, {}, {}};
+  auto plugin = std::move(job->created.plugin);
+  auto* track = isStaleLoad(*job) ? nullptr : getAudioTrackByIndex(job->trackId);
+  if (plugin == nullptr) {
+    done.error = job->error.empty() ? "failed to create plugin instance" : job->error;
+  } else if (isStaleLoad(*job)) {
+    done.error = "edit was reset during the load";
+  } else if (track == nullptr) {
+    done.error = "track_id out of range";
+  } else {
+    try {
+      noteTrackEdited(*track);
+      job->created.plugin = plugin;
+      if (appendCreatedPlugin(track->pluginList, job->created, done.plugin, done.error)) {
+        done.plugin.trackId = job->trackId;
+      }
+    } catch (const std::exception& ex) {
+      done.error = ex.what();
+    }
+    job->created.plugin = nullptr;
+  }
+  if (!done.error.empty()) {
+    done.stage = "failed";
+    done.plugin = {};
+  }
+  pushLoadEvent(std::move(done));
+  schedulePluginPoolRefill();
+}
+
+/** Loader thread: description lookup and plugin construction, then the hand-over. */
+void runPluginLoad(const std::shared_ptr<PluginLoadJob>& job) {
+  if (isStaleLoad(*job)) {
+    job->error = "edit was reset during the load";
+  } else {
+    pushLoadEvent({job->loadId, "instantiating", 0.25, {}, {}});
+    try {
+      if (createPluginForUid(job->pluginUid, job->created, job->error)) {
+        job->created.plugin->initialiseFully();
+      }
+    } catch (const std::exception& ex) {
+      job->error = ex.what();
+    } catch (...) {
+      job->error = "unknown error during vst:load";
+    }
+  }
+  juce::MessageManager::callAsync([job]() {
+    if (gState) {
+      finishPluginLoad(job);
+    }
+  });
+}
+
+}  // namespace
+
+void drainPluginLoader() {
+  if (!gState || gState->pluginLoader == nullptr) {
+    return;
+  }
+  auto drained = std::make_shared<juce::WaitableEvent>();
+  gState->pluginLoader->addJob([drained]() { drained->signal(); });
+  drained->wait(10000);
+}
+
+int64_t loadPluginAsync(const std::string& pluginUid, int32_t trackId, std::string& error) {
+  if (!isInitialised(error) || !requireEdit(error)) {
+    return 0;
+  }
+  if (getAudioTrackByIndex(trackId) == nullptr) {
+    error = "track_id out of range";
+    return 0;
+  }
+
+  auto job = std::make_shared<PluginLoadJob>();
+  job->loadId = gState->nextLoadId.fetch_add(1);
+  job->editGeneration = gState->editGeneration.load();
+  job->pluginUid = pluginUid;
+  job->trackId = trackId;
+  pushLoadEvent({job->loadId, "queued", 0.0, {}, {}});
+  gState->pluginLoader->addJob([job]() { runPluginLoad(job); });
+  error.clear();
+  return job->loadId;
+}
+
+bool popPluginLoadEvent(PluginLoadEvent& out) {
+  if (!gState) {
+    return false;
+  }
+  std::lock_guard<std::mutex> lock(gState->loadEventMutex);
+  if (gState->loadEvents.empty()) {
+    return false;
+  }
+  out = std::move(gState->loadEvents.front());
+  gState->loadEvents.pop_front();
+  return true;
+}
+
+bool configurePluginPool(const PluginPoolConfig& config, PluginPoolStats& stats, std::string& error) {
+  stats = {};
+  if (!isInitialised(error) || !requireEdit(error)) {
+    return false;
+  }
+  std::vector<tracktion::engine::Plugin::Ptr> surplus;
+  {
+    std::lock_guard<std::mutex> lock(gState->poolMutex);
+    gState->poolConfig.uids = config.uids;
+    gState->poolConfig.perUid = juce::jlimit(0, 8, config.perUid);
+    gState->poolConfig.topN = juce::jlimit(0, 32, config.topN);
+    // Drop surplus instances when the target shrinks.
+    for (auto& entry : gState->prewarmedByUid) {
+      auto& pooled = entry.second;
+      while (static_cast<int32_t>(pooled.size()) > gState->poolConfig.perUid) {
+        surplus.push_back(std::move(pooled.back()));
+        pooled.pop_back();
+      }
+    }
+    stats.perUid = gState->poolConfig.perUid;
+    stats.topN = gState->poolConfig.topN;
+    for (const auto& entry : gState->prewarmedByUid) {
+      stats.pooledInstances += static_cast<int32_t>(entry.second.size());
+    }
+  }
+  releaseOnMessageThread(std::move(surplus));
+  schedulePluginPoolRefill();
+  error.clear();
+  return true;
+}
+
+namespace {
+
+double pluginListLatency(tracktion::engine::PluginList& list, std::vector<PluginLatencyInfo>* plugins) {
+  double total = 0.0;
+  for (int i = 0; i < list.size(); ++i) {
+    auto* plugin = list[i];
+    if (plugin == nullptr) {
+      continue;
+    }
+    const double latency = plugin->isEnabled() ? plugin->getLatencySeconds() : 0.0;
+    total += latency;
+    if (plugins != nullptr) {
+      PluginLatencyInfo info;
+      info.pluginIndex = i;
+      info.name = plugin->getName().toStdString();
+      info.latencySeconds = plugin->getLatencySeconds();
+      info.enabled = plugin->isEnabled();
+      info.lowLatencyBypassed = std::any_of(
+        gState->lowLatencyBypassed.begin(), gState->lowLatencyBypassed.end(),
+        [&](const auto& entry) { return entry.pluginId == plugin->itemID; }
+      );
+      plugins->push_back(std::move(info));
+    }
+  }
+  return total;
+}
+
+tracktion::engine::AudioTrack* findAuxReturnTrack(tracktion::engine::Edit& edit, int auxBusNumber) {
+  for (auto* track : cachedAudioTracks(edit)) {
+    for (auto* plugin : track->pluginList) {
+      if (auto* auxReturn = dynamic_cast<tracktion::engine::AuxReturnPlugin*>(plugin)) {
+        if (auxReturn->busNumber.get() == auxBusNumber) {
+          return track;
+        }
+      }
+    }
+  }
+  return nullptr;
+}
+
+/** Plugin latency from a track's input to the master. Every route counts: the track output into a
+ *  bus or folder, and each aux send (from its position in the chain) into the bus behind it. Delay
+ *  compensation aligns to the longest route, so that is the path latency. */
+double trackPathLatency(tracktion::engine::AudioTrack& track, int depth = 0) {
+  if (depth >= 8) {
+    return 0.0;
+  }
+  double chain = 0.0;
+  double longest = 0.0;
+  for (auto* plugin : track.pluginList) {
+    if (plugin == nullptr || !plugin->isEnabled()) {
+      continue;
+    }
+    if (auto* send = dynamic_cast<tracktion::engine::AuxSendPlugin*>(plugin)) {
+      if (auto* bus = findAuxReturnTrack(track.edit, send->busNumber.get()); bus != nullptr && bus != &track) {
+        longest = std::max(longest, chain + trackPathLatency(*bus, depth + 1));
+      }
+    }
+    chain += plugin->getLatencySeconds();
+  }
+  double output = chain;
+  if (auto* destination = track.getOutput().getDestinationTrack()) {
+    output += trackPathLatency(*destination, depth + 1);
+  }
+  return std::max(longest, output);
+}
+
+tracktion::engine::Plugin* findEditPluginById(tracktion::engine::EditItemID pluginId) {
+  for (auto* track : cachedAudioTracks(*gState->edit)) {
+    for (auto* plugin : track->pluginList) {
+      if (plugin->itemID == pluginId) {
+        return plugin;
+      }
+    }
+  }
+  return nullptr;
+}
+
+void refreshLowLatencyMonitoringImpl() {
+  if (!gState || !gState->edit) {
+    return;
+  }
+  for (const auto& entry : gState->lowLatencyBypassed) {
+    // Still disabled means still ours; setPluginBypass drops entries the user has taken over.
+    if (auto* plugin = findEditPluginById(entry.pluginId); plugin != nullptr && !plugin->isEnabled()) {
+      plugin->setEnabled(entry.wasEnabled);
+    }
+  }
+  gState->lowLatencyBypassed.clear();
+
+  if (gState->lowLatencyMonitoring) {
+    for (auto* track : cachedAudioTracks(*gState->edit)) {
+      if (track == nullptr || isBusTrack(*track) || !track->getWaveInputDevice().isEnabled()) {
+        continue;
+      }
+      for (auto* plugin : track->pluginList) {
+        if (plugin->isEnabled() && plugin->getLatencySeconds() > gState->lowLatencyThresholdSeconds) {
+          gState->lowLatencyBypassed.push_back({plugin->itemID, plugin->isEnabled()});
+          plugin->setEnabled(false);
+        }
+      }
+    }
+  }
+  // Latency is fixed per graph; rebuilding drops the bypassed plugins from the compensation path.
+  transportRebuildGraphOnlyImpl();
+}
+
+bool getLatencyReportImpl(LatencyReport& report, std::string& error) {
+  auto& edit = *gState->edit;
+  auto& dm = gState->engine->getDeviceManager();
+  report.sampleRate = dm.getSampleRate();
+  report.outputLatencySeconds = dm.getOutputLatencySeconds();
+  report.lowLatencyMonitoring = gState->lowLatencyMonitoring;
+  report.lowLatencyThresholdSeconds = gState->lowLatencyThresholdSeconds;
+
+  report.masterLatencySeconds = pluginListLatency(edit.getMasterPluginList(), &report.masterPlugins);
+
+  int32_t trackId = 0;
+  for (auto* track : cachedAudioTracks(edit)) {
+    if (track == nullptr || isBusTrack(*track)) {
+      continue;
+    }
+    TrackLatencyInfo info;
+    info.trackId = ++trackId;
+    info.armed = track->getWaveInputDevice().isEnabled();
+    info.pluginLatencySeconds = pluginListLatency(track->pluginList, &info.plugins);
+    info.pathLatencySeconds = trackPathLatency(*track) + report.masterLatencySeconds;
+    report.graphLatencySeconds = std::max(report.graphLatencySeconds, info.pathLatencySeconds);
+    report.tracks.push_back(std::move(info));
+  }
+  report.totalLatencySeconds = report.graphLatencySeconds + report.outputLatencySeconds;
+  error.clear();
+  return true;
+}
+
+}  // namespace
+
+void refreshLowLatencyMonitoring() {
+  runOnMessageThreadAndWait(refreshLowLatencyMonitoringImpl);
+}
+
+bool getLatencyReport(LatencyReport& report, std::string& error) {
+  report = {};
+  if (!isInitialised(error) || !requireEdit(error)) {
+    return false;
+  }
+  bool ok = false;
+  runOnMessageThreadAndWait([&]() {
+    try {
+      ok = getLatencyReportImpl(report, error);
+    } catch (const std::exception& ex) {
+      error = ex.what();
+    } catch (...) {
+      error = "unknown error during latency:report";
     }
+  });
+  if (!ok && error.empty()) {
+    error = "timeout during latency:report (message thread)";
+  }
+  return ok;
+}
 
-    std::mutex mtx;
-    std::condition_variable cv;
-    std::atomic<bool> done{false};
-    mm->callAsync([&]() {
-      setTempoOnMessageThread();
-      {
-        std::lock_guard<std::mutex> lock(mtx);
-        done = true;
+bool setLowLatencyMonitoring(bool enabled, double thresholdSeconds, std::string& error) {
+  if (!isInitialised(error) || !requireEdit(error)) {
+    return false;
+  }
+  gState->lowLatencyMonitoring = enabled;
+  if (std::isfinite(thresholdSeconds) && thresholdSeconds >= 0.0) {
+    gState->lowLatencyThresholdSeconds = thresholdSeconds;
+  }
+  refreshLowLatencyMonitoring();
+  error.clear();
+  return true;
+}
+
+void noteTrackEdited(tracktion::engine::AudioTrack& track) {
+  if (!gState) {
+    return;
+  }
+  bool dormant = false;
+  {
+    std::lock_guard<std::mutex> lock(gState->dormantMutex);
+    dormant = gState->dormantTracks.count(track.itemID.getRawID()) > 0;
+  }
+  if (dormant) {
+    // Content is about to arrive; the track has to process again before the edit that adds it.
+    const auto trackId = track.itemID;
+    runOnMessageThreadAndWait([trackId]() { wakeDormantTrack(trackId); });
+  }
+}
+
+namespace {
+
+constexpr float kSuspendThresholdDb = -80.0F;
+constexpr int kSuspensionTickMs = 100;
+/** Ticks below the threshold before a track counts as decayed. */
+constexpr int kSilentTicksToSuspend = 5;
+/** The wake check runs on the tick, so a clip must be seen at least two ticks ahead to resume in time. */
+constexpr double kMinSuspensionLookaheadSeconds = 2.0 * kSuspensionTickMs / 1000.0;
+constexpr double kMaxSuspensionLookaheadSeconds = 10.0;
+
+bool hasClipInRange(tracktion::engine::AudioTrack& track, tracktion::core::TimeRange range) {
+  for (auto* clip : track.getClips()) {
+    if (clip != nullptr && clip->getEditTimeRange().overlaps(range)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool hasAuxReturn(tracktion::engine::AudioTrack& track) {
+  for (auto* plugin : track.pluginList) {
+    if (dynamic_cast<tracktion::engine::AuxReturnPlugin*>(plugin) != nullptr) {
+      return true;
+    }
+  }
+  return false;
+}
+
+TrackSilenceMonitor* ensureSilenceMonitor(tracktion::engine::AudioTrack& track) {
+  for (auto& monitor : gState->silenceMonitors) {
+    if (monitor->trackId == track.itemID) {
+      return monitor.get();
+    }
+  }
+  auto* meter = track.getLevelMeterPlugin();
+  if (meter == nullptr) {
+    return nullptr;
+  }
+  auto monitor = std::make_unique<TrackSilenceMonitor>();
+  monitor->trackId = track.itemID;
+  monitor->measurer = &meter->measurer;
+  monitor->measurer->addClient(monitor->client);
+  gState->silenceMonitors.push_back(std::move(monitor));
+  return gState->silenceMonitors.back().get();
+}
+
+/** Suspension flips each user plugin's runtime processing flag, which the plugin node checks every
+ *  block: a suspended chain is skipped without rebuilding the graph, and nothing is saved with the edit.
+ *  Volume/pan and the level meter keep running; they are cheap and the meter feeds the monitor. */
+void setChainProcessing(tracktion::engine::AudioTrack& track, bool shouldProcess) {
+  for (auto* plugin : track.pluginList) {
+    if (plugin != nullptr && !isTrackCorePlugin(*plugin)) {
+      plugin->setProcessingEnabled(shouldProcess);
+    }
+  }
+}
+
+/** The level meter reduces every block to a peak (FloatVectorOperations min/max, SIMD), so the
+ *  monitor only reads and clears that per tick instead of scanning audio itself. */
+void suspensionTick() {
+  if (!gState || !gState->edit || !gState->suspensionEnabled) {
+    return;
+  }
+  auto& edit = *gState->edit;
+  const auto position = edit.getTransport().getPosition();
+  const tracktion::core::TimeRange ahead(
+    position,
+    position + tracktion::core::TimeDuration::fromSeconds(gState->suspensionLookaheadSeconds)
+  );
+
+  for (auto* track : cachedAudioTracks(edit)) {
+    if (track == nullptr || isBusTrack(*track)) {
+      continue;
+    }
+    if (isDormant(*track)) {
+      continue;
+    }
+    auto* monitor = ensureSilenceMonitor(*track);
+    if (monitor == nullptr) {
+      continue;
+    }
+    float peak = monitor->client.getAndClearMidiLevel().dB;
+    for (int channel = 0; channel < 2; ++channel) {
+      peak = std::max(peak, monitor->client.getAndClearAudioLevel(channel).dB);
+    }
+    monitor->peakDb = peak;
+
+    const bool mustRun = track->getWaveInputDevice().isEnabled() || hasClipInRange(*track, ahead)
+      || hasAuxReturn(*track) || gState->sidechainSources.count(track->itemID.getRawID()) > 0;
+    if (monitor->suspended) {
+      if (mustRun) {
+        setChainProcessing(*track, true);
+        monitor->suspended = false;
+        monitor->silentTicks = 0;
       }
-      cv.notify_one();
-    });
-    std::unique_lock<std::mutex> lock(mtx);
-    cv.wait_for(lock, std::chrono::seconds(5), [&]() { return done.load(); });
+      continue;
+    }
+    monitor->silentTicks = peak < kSuspendThresholdDb ? monitor->silentTicks + 1 : 0;
+    if (!mustRun && monitor->silentTicks >= kSilentTicksToSuspend) {
+      setChainProcessing(*track, false);
+      monitor->suspended = true;
+    }
+  }
+}
+
+class SuspensionTimer final : public juce::Timer {
+ public:
+  void timerCallback() override {
+    suspensionTick();
+  }
+};
+
+void collectPerfStats(PerfStats& stats) {
+  stats.suspensionEnabled = gState->suspensionEnabled;
+  stats.cpuUsage = gState->engine->getDeviceManager().getCpuUsage();
+  int32_t trackId = 0;
+  for (auto* track : cachedAudioTracks(*gState->edit)) {
+    if (track == nullptr || isBusTrack(*track)) {
+      continue;
+    }
+    TrackPerfInfo info;
+    info.trackId = ++trackId;
+    for (const auto& monitor : gState->silenceMonitors) {
+      if (monitor->trackId == track->itemID) {
+        info.suspended = monitor->suspended;
+        info.peakDb = monitor->peakDb;
+      }
+    }
+    stats.suspendedCount += info.suspended ? 1 : 0;
+    stats.tracks.push_back(info);
+  }
+}
+
+}  // namespace
+
+/** Message thread. Brings every suspended track back (play start, seek, mode off). */
+void resumeSuspendedTracks() {
+  if (!gState || !gState->edit) {
     return;
   }
+  for (auto& monitor : gState->silenceMonitors) {
+    if (!monitor->suspended) {
+      continue;
+    }
+    if (auto* track = dynamic_cast<tracktion::engine::AudioTrack*>(tracktion::engine::findTrackForID(*gState->edit, monitor->trackId))) {
+      setChainProcessing(*track, true);
+    }
+    monitor->suspended = false;
+    monitor->silentTicks = 0;
+  }
+}
 
-  setTempoOnMessageThread();
+void refreshDormantTracks() {
+  if (!gState || !gState->edit) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(gState->dormantMutex);
+  for (auto* track : cachedAudioTracks(*gState->edit)) {
+    if (track == nullptr || isBusTrack(*track)) {
+      continue;
+    }
+    const uint64_t id = track->itemID.getRawID();
+    const bool wasDormant = gState->dormantTracks.count(id) > 0;
+    if (isEmptyTrack(*track)) {
+      if (!wasDormant) {
+        setCoreProcessing(*track, false);
+        gState->dormantTracks.insert(id);
+      }
+    } else if (wasDormant) {
+      setCoreProcessing(*track, true);
+      gState->dormantTracks.erase(id);
+    }
+  }
+}
+
+bool setTrackSuspension(bool enabled, double lookaheadSeconds, PerfStats& stats, std::string& error) {
+  stats = {};
+  if (!isInitialised(error) || !requireEdit(error)) {
+    return false;
+  }
+  runOnMessageThreadAndWait([&]() {
+    if (!gState || !gState->edit) {
+      return;
+    }
+    gState->suspensionEnabled = enabled;
+    if (std::isfinite(lookaheadSeconds) && lookaheadSeconds > 0.0) {
+      gState->suspensionLookaheadSeconds =
+        std::clamp(lookaheadSeconds, kMinSuspensionLookaheadSeconds, kMaxSuspensionLookaheadSeconds);
+    }
+    if (gState->suspensionTimer == nullptr) {
+      gState->suspensionTimer = std::make_unique<SuspensionTimer>();
+    }
+    if (enabled) {
+      gState->suspensionTimer->startTimer(kSuspensionTickMs);
+    } else {
+      gState->suspensionTimer->stopTimer();
+      resumeSuspendedTracks();
+      gState->silenceMonitors.clear();
+    }
+    collectPerfStats(stats);
+  });
+  error.clear();
+  return true;
+}
+
+bool getPerfStats(PerfStats& stats, std::string& error) {
+  stats = {};
+  if (!isInitialised(error) || !requireEdit(error)) {
+    return false;
+  }
+  runOnMessageThreadAndWait([&]() {
+    if (gState && gState->edit) {
+      collectPerfStats(stats);
+    }
+  });
+  error.clear();
+  return true;
+}
+
+namespace {
+
+bool anyTrackArmed(tracktion::engine::Edit& edit) {
+  for (auto* track : cachedAudioTracks(edit)) {
+    if (track != nullptr && track->getWaveInputDevice().isEnabled()) {
+      return true;
+    }
+  }
+  return false;
+}
+
+/** Takes the current playback context out of the device callback. It stays allocated and prepared,
+ *  so leaving idle is one addContext instead of a device reopen and graph rebuild. Removing is
+ *  idempotent, which lets the tick repeat it for contexts rebuilt while idle. */
+void detachPlaybackContext() {
+  if (auto* context = gState->edit->getTransport().getCurrentPlaybackContext()) {
+    gState->engine->getDeviceManager().removeContext(context);
+  }
+}
+
+/** Enters idle once the transport has been stopped, unarmed and without state-changing requests for
+ *  the timeout: the graph stops being processed, while the audio device stays open and its callback
+ *  only writes silence. */
+void idlePowerTick() {
+  if (!gState || !gState->edit) {
+    return;
+  }
+  auto& transport = gState->edit->getTransport();
+  const double nowMs = juce::Time::getMillisecondCounterHiRes();
+  const bool scrubbing = gState->scrub != nullptr && gState->scrub->isRunning();
+  const bool busy = transport.isPlaying() || transport.isRecording() || scrubbing || anyTrackArmed(*gState->edit);
+  if (gState->idlePower) {
+    if (busy) {
+      leaveIdlePower();  // started by a path that does not leave idle itself
+    } else {
+      detachPlaybackContext();  // graph rebuilds while idle attach their new context
+    }
+    return;
+  }
+  if (!gState->idlePowerEnabled) {
+    return;
+  }
+  if (busy) {
+    gState->lastActivityMs = nowMs;
+    return;
+  }
+  if (nowMs - gState->lastActivityMs.load() < gState->idleTimeoutSeconds * 1000.0) {
+    return;
+  }
+  detachPlaybackContext();
+  gState->idlePower = true;
+  std::fprintf(stderr, "[thestuu-native] idle: playback graph detached from the audio device\n");
+}
+
+class IdlePowerTimer final : public juce::Timer {
+ public:
+  void timerCallback() override {
+    idlePowerTick();
+  }
+};
+
+}  // namespace
+
+void startIdlePowerTimer() {
+  gState->lastActivityMs = juce::Time::getMillisecondCounterHiRes();
+  gState->idleTimer = std::make_unique<IdlePowerTimer>();
+  gState->idleTimer->startTimer(1000);
+}
+
+void leaveIdlePower() {
+  if (!gState || !gState->idlePower) {
+    return;
+  }
+  gState->idlePower = false;
+  gState->lastActivityMs = juce::Time::getMillisecondCounterHiRes();
+  if (gState->edit != nullptr) {
+    if (auto* context = gState->edit->getTransport().getCurrentPlaybackContext()) {
+      // Remove first: a context rebuilt since the last tick is attached already.
+      auto& deviceManager = gState->engine->getDeviceManager();
+      deviceManager.removeContext(context);
+      deviceManager.addContext(context);
+    }
+  }
+  std::fprintf(stderr, "[thestuu-native] idle: playback graph attached again\n");
+}
+
+void notePowerActivity() {
+  if (gState) {
+    gState->lastActivityMs = juce::Time::getMillisecondCounterHiRes();
+  }
+}
+
+bool isIdlePowerMode() {
+  return gState != nullptr && gState->idlePower.load();
+}
+
+bool setIdlePower(bool enabled, double timeoutSeconds, IdlePowerStatus& status, std::string& error) {
+  status = {};
+  if (!isInitialised(error)) {
+    return false;
+  }
+  runOnMessageThreadAndWait([&]() {
+    gState->idlePowerEnabled = enabled;
+    if (!enabled) {
+      leaveIdlePower();
+    }
+    if (std::isfinite(timeoutSeconds) && timeoutSeconds > 0.0) {
+      gState->idleTimeoutSeconds = timeoutSeconds;
+    }
+    status.enabled = gState->idlePowerEnabled;
+    status.timeoutSeconds = gState->idleTimeoutSeconds;
+    status.idle = gState->idlePower.load();
+  });
+  error.clear();
+  return true;
 }
 
 void pumpMessageLoop() {
@@ -2027,6 +6173,135 @@ void runMessageLoopFor(int millisecondsMs) {
   }
 }
 
+namespace {
+
+void removeClipsById(tracktion::engine::AudioTrack& track, const std::vector<tracktion::engine::EditItemID>& clipIds) {
+  auto& clips = track.getClips();
+  for (int i = clips.size(); --i >= 0;) {
+    auto* clip = clips.getUnchecked(i);
+    if (clip != nullptr && std::find(clipIds.begin(), clipIds.end(), clip->itemID) != clipIds.end()) {
+      clip->removeFromParent();
+    }
+  }
+}
+
+bool setStepPatternImpl(const StepPatternRequest& request, StepPatternResult& result, std::string& error) {
+  auto* track = getAudioTrackByIndex(request.trackId);
+  if (track == nullptr) {
+    error = "track_id out of range";
+    return false;
+  }
+  noteTrackEdited(*track);
+
+  const int32_t lengthSteps = std::max<int32_t>(1, request.lengthSteps);
+  const double stepBeats = request.stepBeats > 0.0 ? request.stepBeats : 0.25;
+  const double swing = juce::jlimit(0.0, 0.95, request.swing);
+  const double gate = juce::jlimit(0.05, 1.0, request.gate);
+  const double patternBeats = lengthSteps * stepBeats;
+  const double beatsPerBar = estimateBeatsPerBar();
+
+  const std::string key = std::to_string(track->itemID.getRawID()) + ":" + request.patternId;
+  auto& clipIds = gState->patternClipsByKey[key];
+  removeClipsById(*track, clipIds);
+  clipIds.clear();
+
+  std::vector<StepPatternRange> ranges = request.ranges;
+  if (ranges.empty()) {
+    const double editBeats = timePositionToBeats(tracktion::core::TimePosition() + gState->edit->getLength());
+    ranges.push_back({0.0, std::max(patternBeats, editBeats) / beatsPerBar});
+  }
+
+  int32_t noteCount = 0;
+  for (const auto& range : ranges) {
+    if (range.lengthBars <= 0.0) {
+      continue;
+    }
+    const double startBeats = std::max(0.0, range.startBars) * beatsPerBar;
+    const double endBeats = startBeats + range.lengthBars * beatsPerBar;
+    const tracktion::core::TimeRange clipRange(convertBeatsToTime(startBeats), convertBeatsToTime(endBeats));
+    auto clip = track->insertMIDIClip(juce::String::fromUTF8(request.patternId.c_str()), clipRange, nullptr);
+    if (clip == nullptr) {
+      error = "failed to insert pattern clip";
+      return false;
+    }
+    clipIds.push_back(clip->itemID);
+
+    auto& sequence = clip->getSequence();
+    for (const auto& step : request.steps) {
+      if (step.stepIndex < 0 || step.stepIndex >= lengthSteps || step.velocity <= 0.0) {
+        continue;
+      }
+      const double swingDelay = (step.stepIndex % 2 == 1) ? swing * stepBeats * 0.5 : 0.0;
+      const int velocity = juce::jlimit(1, 127, static_cast<int>(std::lround(step.velocity * 127.0)));
+      sequence.addNote(
+        juce::jlimit(0, 127, static_cast<int>(step.note)),
+        tracktion::core::BeatPosition::fromBeats(step.stepIndex * stepBeats + swingDelay),
+        tracktion::core::BeatDuration::fromBeats(stepBeats * gate),
+        velocity,
+        0,
+        nullptr
+      );
+      ++noteCount;
+    }
+    // The clip loops its single pattern pass, so steps repeat on the audio clock for the whole range.
+    clip->setLoopRangeBeats(tracktion::core::BeatRange(
+      tracktion::core::BeatPosition::fromBeats(0.0),
+      tracktion::core::BeatDuration::fromBeats(patternBeats)
+    ));
+  }
+
+  bool hasInstrument = trackHasInstrument(*track);
+  if (!hasInstrument && !request.instrumentUid.empty()) {
+    LoadPluginResult instrument;
+    std::string instrumentError;
+    if (loadPlugin(request.instrumentUid, request.trackId, instrument, instrumentError)) {
+      hasInstrument = instrument.isInstrument;
+    } else {
+      std::fprintf(stderr, "[thestuu-native] pattern:set: instrument %s not loaded: %s\n",
+                   request.instrumentUid.c_str(), instrumentError.c_str());
+    }
+  }
+
+  result.trackId = request.trackId;
+  result.patternId = request.patternId;
+  result.clipCount = static_cast<int32_t>(clipIds.size());
+  result.noteCount = noteCount;
+  result.hasInstrument = hasInstrument;
+  error.clear();
+  return true;
+}
+
+}  // namespace
+
+bool setStepPattern(const StepPatternRequest& request, StepPatternResult& result, std::string& error) {
+  result = {};
+  if (!isInitialised(error)) {
+    return false;
+  }
+  if (!requireEdit(error)) {
+    return false;
+  }
+  if (request.patternId.empty()) {
+    error = "pattern id is required";
+    return false;
+  }
+
+  bool ok = false;
+  std::string implError = "timeout during pattern:set (message thread)";
+  runOnMessageThreadAndWait([&]() {
+    try {
+      ok = setStepPatternImpl(request, result, implError);
+    } catch (const std::exception& ex) {
+      implError = ex.what();
+    }
+  });
+  if (!ok) {
+    error = implError;
+    result = {};
+  }
+  return ok;
+}
+
 bool getAudioOutputDevices(std::vector<AudioDeviceInfo>& out, std::string& error) {
   out.clear();
   if (!gState || !gState->engine) {
@@ -0,0 +1,156 @@
+#include "transient_detection.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <numeric>
+
+#include <juce_dsp/juce_dsp.h>
+
+namespace thestuu::native {
+
+namespace {
+
+constexpr int kFftOrder = 10;
+constexpr int kFftSize = 1 << kFftOrder;
+constexpr int kHopSize = kFftSize / 4;
+/** Band edges in Hz: lows (kick), low mids, mids (snare body), presence, air (hats, consonants). */
+constexpr std::array<double, 6> kBandEdgesHz{0.0, 150.0, 500.0, 2000.0, 6000.0, 22050.0};
+constexpr int kBandCount = static_cast<int>(kBandEdgesHz.size()) - 1;
+/** Log compression of magnitudes so quiet and loud passages give comparable flux. */
+constexpr float kCompression = 100.0F;
+/** Peak picking: local maximum within +-kPeakRadius frames, above the mean of +-kMeanRadius frames. */
+constexpr int kPeakRadius = 3;
+constexpr int kMeanRadius = 16;
+/** Per-band flux is divided by a slowly decaying band peak, so every band contributes on its own scale. */
+constexpr float kBandPeakDecay = 0.999F;
+
+}  // namespace
+
+bool detectTransients(
+  juce::AudioFormatReader& reader,
+  double startSeconds,
+  double lengthSeconds,
+  const TransientDetectionOptions& options,
+  std::vector<Transient>& transients
+) {
+  transients.clear();
+  if (reader.sampleRate <= 0.0 || lengthSeconds <= 0.0) {
+    return false;
+  }
+  const double sampleRate = reader.sampleRate;
+  const auto firstSample = static_cast<juce::int64>(std::llround(startSeconds * sampleRate));
+  const auto totalSamples = static_cast<juce::int64>(std::llround(lengthSeconds * sampleRate));
+
+  juce::dsp::FFT fft(kFftOrder);
+  juce::dsp::WindowingFunction<float> window(kFftSize, juce::dsp::WindowingFunction<float>::hann, false);
+  const int bins = kFftSize / 2 + 1;
+  std::array<int, kBandCount + 1> bandStart{};
+  for (int band = 0; band <= kBandCount; ++band) {
+    const double bin = kBandEdgesHz[static_cast<size_t>(band)] * kFftSize / sampleRate;
+    bandStart[static_cast<size_t>(band)] = std::clamp(static_cast<int>(std::lround(bin)), 0, bins);
+  }
+  bandStart[kBandCount] = bins;
+
+  const bool stereo = reader.numChannels > 1;
+  juce::AudioBuffer<float> hop(stereo ? 2 : 1, kHopSize);
+  std::vector<float> frame(static_cast<size_t>(kFftSize), 0.0F);  // sliding analysis window (mono)
+  std::vector<float> spectrum(static_cast<size_t>(kFftSize) * 2, 0.0F);
+  std::vector<float> previous(static_cast<size_t>(bins), 0.0F);
+  std::vector<float> rise(static_cast<size_t>(bins), 0.0F);
+  std::array<float, kBandCount> bandPeak{};
+  bandPeak.fill(1.0e-3F);
+  std::vector<float> onset;
+  onset.reserve(static_cast<size_t>(totalSamples / kHopSize + 1));
+
+  for (juce::int64 position = 0; position < totalSamples; position += kHopSize) {
+    // Out-of-file ranges read as silence.
+    if (!reader.read(&hop, 0, kHopSize, firstSample + position, true, stereo)) {
+      return false;
+    }
+    if (stereo) {
+      hop.addFrom(0, 0, hop, 1, 0, kHopSize);
+      juce::FloatVectorOperations::multiply(hop.getWritePointer(0), 0.5F, kHopSize);
+    }
+    std::copy(frame.begin() + kHopSize, frame.end(), frame.begin());
+    std::copy(hop.getReadPointer(0), hop.getReadPointer(0) + kHopSize, frame.end() - kHopSize);
+
+    std::copy(frame.begin(), frame.end(), spectrum.begin());
+    std::fill(spectrum.begin() + kFftSize, spectrum.end(), 0.0F);
+    window.multiplyWithWindowingTable(spectrum.data(), static_cast<size_t>(kFftSize));
+    fft.performFrequencyOnlyForwardTransform(spectrum.data(), true);
+    for (int bin = 0; bin < bins; ++bin) {
+      spectrum[static_cast<size_t>(bin)] = std::log1p(kCompression * spectrum[static_cast<size_t>(bin)]);
+    }
+
+    // Half-wave rectified rise per bin, vectorised.
+    juce::FloatVectorOperations::subtract(rise.data(), spectrum.data(), previous.data(), bins);
+    juce::FloatVectorOperations::max(rise.data(), rise.data(), 0.0F, bins);
+    juce::FloatVectorOperations::copy(previous.data(), spectrum.data(), bins);
+
+    float flux = 0.0F;
+    for (int band = 0; band < kBandCount; ++band) {
+      const int from = bandStart[static_cast<size_t>(band)];
+      const int to = bandStart[static_cast<size_t>(band) + 1];
+      if (to <= from) {
+        continue;
+      }
+      const float bandFlux = std::accumulate(rise.begin() + from, rise.begin() + to, 0.0F) / static_cast<float>(to - from);
+      auto& peak = bandPeak[static_cast<size_t>(band)];
+      peak = std::max(bandFlux, peak * kBandPeakDecay);
+      flux += bandFlux / peak;
+    }
+    onset.push_back(onset.empty() ? 0.0F : flux / kBandCount);  // the first frame rises from nothing
+  }
+
+  if (onset.empty()) {
+    return true;
+  }
+  const float strongest = *std::max_element(onset.begin(), onset.end());
+  if (!(strongest > 0.0F)) {
+    return true;
+  }
+  // Sensitivity 1 accepts anything above the local mean, 0 needs the mean plus half the strongest peak.
+  const float margin = static_cast<float>((1.0 - std::clamp(options.sensitivity, 0.0, 1.0)) * 0.5) * strongest;
+  const int count = static_cast<int>(onset.size());
+  std::vector<Transient> candidates;
+  for (int i = 1; i < count; ++i) {
+    const float value = onset[static_cast<size_t>(i)];
+    const int peakFrom = std::max(0, i - kPeakRadius);
+    const int peakTo = std::min(count - 1, i + kPeakRadius);
+    if (value <= 0.0F || value < *std::max_element(onset.begin() + peakFrom, onset.begin() + peakTo + 1)) {
+      continue;
+    }
+    const int meanFrom = std::max(0, i - kMeanRadius);
+    const int meanTo = std::min(count - 1, i + kMeanRadius);
+    const float mean = std::accumulate(onset.begin() + meanFrom, onset.begin() + meanTo + 1, 0.0F)
+      / static_cast<float>(meanTo - meanFrom + 1);
+    if (value < mean + margin) {
+      continue;
+    }
+    // Frame i ends with hop i. With log-compressed magnitudes the flux peaks as soon as the attack enters
+    // the window, i.e. within hop i; report the start of that hop so a slice here keeps the whole attack.
+    const double sample = static_cast<double>(i) * kHopSize;
+    candidates.push_back({std::min(sample / sampleRate, lengthSeconds), value / strongest});
+  }
+
+  // Enforce the minimum gap, stronger transients first.
+  std::vector<size_t> order(candidates.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::sort(order.begin(), order.end(), [&](size_t a, size_t b) { return candidates[a].strength > candidates[b].strength; });
+  for (const size_t index : order) {
+    const auto& candidate = candidates[index];
+    const bool tooClose = std::any_of(transients.begin(), transients.end(), [&](const Transient& kept) {
+      return std::abs(kept.timeSeconds - candidate.timeSeconds) < options.minGapSeconds;
+    });
+    if (!tooClose) {
+      transients.push_back(candidate);
+    }
+  }
+  std::sort(transients.begin(), transients.end(), [](const Transient& a, const Transient& b) {
+    return a.timeSeconds < b.timeSeconds;
+  });
+  return true;
+}
+
+}  // namespace thestuu::native
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <vector>
+
+#include <juce_audio_formats/juce_audio_formats.h>
+
+namespace thestuu::native {
+
+struct TransientDetectionOptions {
+  /** 0..1; higher finds softer transients. */
+  double sensitivity = 0.5;
+  /** Transients closer than this to a stronger one are dropped. */
+  double minGapSeconds = 0.05;
+};
+
+struct Transient {
+  /** Seconds from startSeconds of the scanned range. */
+  double timeSeconds = 0.0;
+  /** Onset strength relative to the strongest transient in the range (0..1]. */
+  double strength = 0.0;
+};
+
+/** Multi-band spectral-flux onset detection over [startSeconds, startSeconds + lengthSeconds) of reader.
+ *  The audio is streamed hop by hop (mono mixdown), so memory does not grow with the file; only the
+ *  onset curve is kept for peak picking. Returns false if the reader fails. Thread-safe per reader. */
+bool detectTransients(
+  juce::AudioFormatReader& reader,
+  double startSeconds,
+  double lengthSeconds,
+  const TransientDetectionOptions& options,
+  std::vector<Transient>& transients
+);
+
+}  // namespace thestuu::native
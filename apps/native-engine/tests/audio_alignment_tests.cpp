@@ -0,0 +1,81 @@
+#include "audio_alignment.hpp"
+#include "test_audio.hpp"
+
+#include <random>
+
+namespace thestuu::native {
+
+namespace {
+
+constexpr double kRate = 48000.0;
+constexpr double kEnvelopeRate = 400.0;  // as used by the backend
+constexpr int kLengthSamples = 8 * 48000;
+
+/** Decaying noise bursts at irregular 150..450 ms spacing, so the correlation has a single clear peak. */
+juce::AudioBuffer<float> makeBursts(int channels, int delaySamples) {
+  juce::AudioBuffer<float> buffer(channels, kLengthSamples);
+  buffer.clear();
+  std::mt19937 random(7);
+  std::uniform_int_distribution<int> gap(7200, 21600);
+  std::uniform_real_distribution<float> noise(-1.0F, 1.0F);
+  constexpr int kBurstSamples = 480;
+  for (int pos = 4800; pos + kBurstSamples < kLengthSamples; pos += gap(random)) {
+    for (int i = 0; i < kBurstSamples; ++i) {
+      const float sample = 0.5F * noise(random) * std::exp(-6.0F * static_cast<float>(i) / kBurstSamples);
+      const int at = pos + delaySamples + i;
+      for (int ch = 0; ch < channels; ++ch) {
+        if (at >= 0 && at < kLengthSamples) {
+          buffer.setSample(ch, at, sample);
+        }
+      }
+    }
+  }
+  return buffer;
+}
+
+class AudioAlignmentTests : public juce::UnitTest {
+public:
+  AudioAlignmentTests() : juce::UnitTest("audio alignment", "thestuu") {}
+
+  void runTest() override {
+    beginTest("delayed copy returns the known offset");
+    expectOffset(1, 1200, "late by 25 ms");
+    expectOffset(2, 660, "late by 13.75 ms (between envelope frames)");
+    expectOffset(1, -1440, "early by 30 ms");
+    expectOffset(2, 0, "aligned");
+  }
+
+private:
+  void expectOffset(int channels, int delaySamples, const juce::String& label) {
+    const AlignmentOptions options;
+    const int pad = alignmentPadFrames(options, kEnvelopeRate);
+    const double lengthSeconds = kLengthSamples / kRate;
+
+    test::BufferReader guideReader(makeBursts(channels, 0), kRate);
+    test::BufferReader targetReader(makeBursts(channels, delaySamples), kRate);
+    OnsetEnvelope guide;
+    OnsetEnvelope target;
+    // The guide covers the target range plus pad frames on either side.
+    expect(computeOnsetEnvelope(guideReader, -pad / kEnvelopeRate, lengthSeconds + 2.0 * pad / kEnvelopeRate,
+                                kEnvelopeRate, guide), label);
+    expect(computeOnsetEnvelope(targetReader, 0.0, lengthSeconds, kEnvelopeRate, target), label);
+
+    const auto result = alignOnsetEnvelopes(guide, target, options);
+    const double expected = delaySamples / kRate;
+    // Within half an envelope frame.
+    const double tolerance = 0.5 / kEnvelopeRate;
+    expectWithinAbsoluteError(result.offsetSeconds, expected, tolerance, label);
+    // A delay between frames smears the envelope, so only whole-frame delays correlate fully.
+    expect(result.confidence > 0.5, label + ": confidence");
+    expect(!result.markers.empty(), label + ": markers");
+    for (const auto& marker : result.markers) {
+      expectWithinAbsoluteError(marker.offsetSeconds, expected, tolerance, label + ": marker");
+    }
+  }
+};
+
+AudioAlignmentTests audioAlignmentTests;
+
+}  // namespace
+
+}  // namespace thestuu::native
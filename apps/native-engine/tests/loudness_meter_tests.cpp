@@ -0,0 +1,68 @@
+#include "loudness_meter.hpp"
+#include "test_audio.hpp"
+
+namespace thestuu::native {
+
+namespace {
+
+constexpr double kRate = 48000.0;
+
+class LoudnessMeterTests : public juce::UnitTest {
+public:
+  LoudnessMeterTests() : juce::UnitTest("loudness meter", "thestuu") {}
+
+  void runTest() override {
+    // EBU Tech 3341 / BS.1770: a stereo 1 kHz sine reads its peak level in dBFS as LUFS, +-0.1 LU.
+    beginTest("EBU Tech 3341 case 1: stereo 1 kHz at -23 dBFS reads -23.0 LUFS");
+    expectSteadySine(-23.0);
+
+    beginTest("EBU Tech 3341 case 2: stereo 1 kHz at -33 dBFS reads -33.0 LUFS");
+    expectSteadySine(-33.0);
+
+    beginTest("stereo 1 kHz at -20 dBFS reads -20.0 LUFS");
+    expectSteadySine(-20.0);
+
+    beginTest("EBU Tech 3342 case 1: 20 s at -20 dBFS then 20 s at -30 dBFS gives LRA 10 LU");
+    {
+      auto buffer = test::makeSine(2, static_cast<int>(40 * kRate), kRate, 1000.0, -20.0);
+      buffer.applyGain(static_cast<int>(20 * kRate), static_cast<int>(20 * kRate), juce::Decibels::decibelsToGain(-10.0F));
+      test::BufferReader reader(std::move(buffer), kRate);
+      LoudnessStats stats;
+      expect(measureLoudness(reader, 0.0, 0.0, stats));
+      expectWithinAbsoluteError(stats.loudnessRangeLu, 10.0, 1.0);
+    }
+
+    beginTest("silence reads the floor");
+    {
+      juce::AudioBuffer<float> buffer(2, static_cast<int>(5 * kRate));
+      buffer.clear();
+      test::BufferReader reader(std::move(buffer), kRate);
+      LoudnessStats stats;
+      expect(measureLoudness(reader, 0.0, 0.0, stats));
+      expectEquals(stats.integratedLufs, kLoudnessFloorDb);
+      expectEquals(stats.samplePeakDbfs, kLoudnessFloorDb);
+    }
+  }
+
+private:
+  void expectSteadySine(double gainDb) {
+    test::BufferReader reader(test::makeSine(2, static_cast<int>(20 * kRate), kRate, 1000.0, gainDb), kRate);
+    LoudnessStats stats;
+    expect(measureLoudness(reader, 0.0, 0.0, stats));
+    expectWithinAbsoluteError(stats.integratedLufs, gainDb, 0.1);
+    expectWithinAbsoluteError(stats.momentaryMaxLufs, gainDb, 0.1);
+    expectWithinAbsoluteError(stats.shortTermMaxLufs, gainDb, 0.1);
+    expectWithinAbsoluteError(stats.loudnessRangeLu, 0.0, 0.1);
+    // 48 samples per period: the sampled sine hits its peak exactly.
+    expectWithinAbsoluteError(stats.samplePeakDbfs, gainDb, 0.01);
+    // Tech 3341 true-peak tolerance: +0.2 / -0.4 dB.
+    expect(stats.truePeakDbtp <= gainDb + 0.2 && stats.truePeakDbtp >= gainDb - 0.4, "true peak");
+    expectWithinAbsoluteError(stats.durationSeconds, 20.0, 1.0e-6);
+  }
+};
+
+LoudnessMeterTests loudnessMeterTests;
+
+}  // namespace
+
+}  // namespace thestuu::native
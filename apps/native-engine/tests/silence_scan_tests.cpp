@@ -0,0 +1,81 @@
+#include "silence_scan.hpp"
+#include "test_audio.hpp"
+
+namespace thestuu::native {
+
+namespace {
+
+constexpr double kRate = 48000.0;
+
+class SilenceScanTests : public juce::UnitTest {
+public:
+  SilenceScanTests() : juce::UnitTest("silence scan", "thestuu") {}
+
+  void runTest() override {
+    beginTest("padded silence of known length");
+    {
+      // 0.25 s silence, 1 s tone at -12 dBFS, 0.5 s silence; the tone starts and ends on audible samples.
+      constexpr int lead = 12000;
+      constexpr int tone = 48000;
+      constexpr int tail = 24000;
+      juce::AudioBuffer<float> buffer(2, lead + tone + tail);
+      buffer.clear();
+      for (int ch = 0; ch < 2; ++ch) {
+        juce::FloatVectorOperations::fill(buffer.getWritePointer(ch, lead), 0.25F, tone);
+      }
+      test::BufferReader reader(std::move(buffer), kRate);
+      SilenceScan scan;
+      expect(scanSilence(reader, -60.0, scan));
+      expectWithinAbsoluteError(scan.leadingSeconds, lead / kRate, 0.5 / kRate);
+      expectWithinAbsoluteError(scan.trailingSeconds, tail / kRate, 0.5 / kRate);
+    }
+
+    beginTest("edges across block boundaries, one channel audible");
+    {
+      // Lengths that are not multiples of the 4096-sample scan block; only the right channel carries audio.
+      constexpr int lead = 10000;
+      constexpr int tone = 5003;
+      constexpr int tail = 9001;
+      juce::AudioBuffer<float> buffer(2, lead + tone + tail);
+      buffer.clear();
+      juce::FloatVectorOperations::fill(buffer.getWritePointer(1, lead), -0.1F, tone);
+      test::BufferReader reader(std::move(buffer), kRate);
+      SilenceScan scan;
+      expect(scanSilence(reader, -40.0, scan));
+      expectWithinAbsoluteError(scan.leadingSeconds, lead / kRate, 0.5 / kRate);
+      expectWithinAbsoluteError(scan.trailingSeconds, tail / kRate, 0.5 / kRate);
+    }
+
+    beginTest("noise floor below the threshold counts as silence");
+    {
+      // -80 dBFS hiss before and after the tone stays under a -60 dB threshold.
+      constexpr int lead = 4800;
+      constexpr int tone = 9600;
+      constexpr int tail = 2400;
+      auto buffer = test::makeSine(1, lead + tone + tail, kRate, 1000.0, -80.0);
+      juce::FloatVectorOperations::fill(buffer.getWritePointer(0, lead), 0.5F, tone);
+      test::BufferReader reader(std::move(buffer), kRate);
+      SilenceScan scan;
+      expect(scanSilence(reader, -60.0, scan));
+      expectWithinAbsoluteError(scan.leadingSeconds, lead / kRate, 0.5 / kRate);
+      expectWithinAbsoluteError(scan.trailingSeconds, tail / kRate, 0.5 / kRate);
+    }
+
+    beginTest("all silent leaves the file untrimmed");
+    {
+      juce::AudioBuffer<float> buffer(1, 20000);
+      buffer.clear();
+      test::BufferReader reader(std::move(buffer), kRate);
+      SilenceScan scan;
+      expect(scanSilence(reader, -60.0, scan));
+      expectEquals(scan.leadingSeconds, 0.0);
+      expectEquals(scan.trailingSeconds, 0.0);
+    }
+  }
+};
+
+SilenceScanTests silenceScanTests;
+
+}  // namespace
+
+}  // namespace thestuu::native
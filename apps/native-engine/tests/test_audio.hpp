@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cmath>
+#include <cstring>
+
+#include <juce_audio_formats/juce_audio_formats.h>
+
+namespace thestuu::native::test {
+
+/** AudioFormatReader over an in-memory float buffer, so the DSP modules can be fed synthetic signals. */
+class BufferReader : public juce::AudioFormatReader {
+public:
+  BufferReader(juce::AudioBuffer<float> source, double rate)
+    : juce::AudioFormatReader(nullptr, "test buffer"), buffer(std::move(source)) {
+    sampleRate = rate;
+    bitsPerSample = 32;
+    usesFloatingPointData = true;
+    numChannels = static_cast<unsigned int>(buffer.getNumChannels());
+    lengthInSamples = buffer.getNumSamples();
+  }
+
+  bool readSamples(int* const* destChannels, int numDestChannels, int startOffsetInDestBuffer,
+                   juce::int64 startSampleInFile, int numSamples) override {
+    clearSamplesBeyondAvailableLength(destChannels, numDestChannels, startOffsetInDestBuffer, startSampleInFile,
+                                      numSamples, lengthInSamples);
+    for (int ch = 0; ch < numDestChannels; ++ch) {
+      if (destChannels[ch] == nullptr || numSamples <= 0) {
+        continue;
+      }
+      auto* dest = reinterpret_cast<float*>(destChannels[ch]) + startOffsetInDestBuffer;
+      if (ch < buffer.getNumChannels()) {
+        std::memcpy(dest, buffer.getReadPointer(ch, static_cast<int>(startSampleInFile)),
+                    sizeof(float) * static_cast<size_t>(numSamples));
+      } else {
+        std::memset(dest, 0, sizeof(float) * static_cast<size_t>(numSamples));
+      }
+    }
+    return true;
+  }
+
+private:
+  juce::AudioBuffer<float> buffer;
+};
+
+/** Sine of frequency hz and peak amplitude gainDb (dBFS) on every channel. */
+inline juce::AudioBuffer<float> makeSine(int channels, int numSamples, double rate, double hz, double gainDb) {
+  juce::AudioBuffer<float> buffer(channels, numSamples);
+  const double gain = std::pow(10.0, gainDb / 20.0);
+  for (int ch = 0; ch < channels; ++ch) {
+    auto* data = buffer.getWritePointer(ch);
+    for (int i = 0; i < numSamples; ++i) {
+      data[i] = static_cast<float>(gain * std::sin(2.0 * juce::MathConstants<double>::pi * hz * i / rate));
+    }
+  }
+  return buffer;
+}
+
+}  // namespace thestuu::native::test
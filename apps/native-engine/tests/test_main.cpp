@@ -0,0 +1,17 @@
+#include <cstdio>
+
+#include <juce_core/juce_core.h>
+
+/** Runs every juce::UnitTest linked into thestuu-dsp-tests; exits non-zero if any check fails. */
+int main() {
+  juce::UnitTestRunner runner;
+  runner.setAssertOnFailure(false);
+  runner.runTestsInCategory("thestuu");
+
+  int failures = 0;
+  for (int i = 0; i < runner.getNumResults(); ++i) {
+    failures += runner.getResult(i)->failures;
+  }
+  std::printf("[thestuu-dsp-tests] %d failure(s)\n", failures);
+  return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,75 @@
+#include "transient_detection.hpp"
+#include "test_audio.hpp"
+
+#include <array>
+
+namespace thestuu::native {
+
+namespace {
+
+constexpr double kRate = 48000.0;
+
+/** Single-sample clicks at the given times (seconds) on every channel. */
+juce::AudioBuffer<float> makeImpulses(int channels, double lengthSeconds, const std::vector<double>& times) {
+  juce::AudioBuffer<float> buffer(channels, static_cast<int>(lengthSeconds * kRate));
+  buffer.clear();
+  for (const double time : times) {
+    for (int ch = 0; ch < channels; ++ch) {
+      buffer.setSample(ch, static_cast<int>(std::lround(time * kRate)), 0.8F);
+    }
+  }
+  return buffer;
+}
+
+class TransientDetectionTests : public juce::UnitTest {
+public:
+  TransientDetectionTests() : juce::UnitTest("transient detection", "thestuu") {}
+
+  void runTest() override {
+    // One analysis hop (256 samples) of resolution.
+    const double tolerance = 256.0 / kRate;
+
+    beginTest("impulse train returns the known onsets");
+    {
+      std::vector<double> times;
+      for (int i = 0; i < 8; ++i) {
+        times.push_back(0.25 + 0.5 * i);  // 120 bpm eighths
+      }
+      test::BufferReader reader(makeImpulses(2, 4.5, times), kRate);
+      std::vector<Transient> transients;
+      expect(detectTransients(reader, 0.0, 4.5, {}, transients));
+      expectEquals(transients.size(), times.size());
+      for (size_t i = 0; i < std::min(transients.size(), times.size()); ++i) {
+        expectWithinAbsoluteError(transients[i].timeSeconds, times[i], tolerance);
+        expect(transients[i].strength > 0.5);
+      }
+    }
+
+    beginTest("irregular onsets relative to the scanned range");
+    {
+      const std::vector<double> times{0.31, 0.52, 1.137, 1.6, 2.45, 2.6};
+      test::BufferReader reader(makeImpulses(1, 3.5, times), kRate);
+      std::vector<Transient> transients;
+      // Start the scan at 0.2 s: reported times are relative to it.
+      expect(detectTransients(reader, 0.2, 3.0, {}, transients));
+      expectEquals(transients.size(), times.size());
+      for (size_t i = 0; i < std::min(transients.size(), times.size()); ++i) {
+        expectWithinAbsoluteError(transients[i].timeSeconds, times[i] - 0.2, tolerance);
+      }
+    }
+
+    beginTest("silence has no onsets");
+    {
+      test::BufferReader reader(makeImpulses(2, 1.0, {}), kRate);
+      std::vector<Transient> transients;
+      expect(detectTransients(reader, 0.0, 1.0, {}, transients));
+      expect(transients.empty());
+    }
+  }
+};
+
+TransientDetectionTests transientDetectionTests;
+
+}  // namespace
+
+}  // namespace thestuu::native